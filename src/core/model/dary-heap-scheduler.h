@@ -0,0 +1,136 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DARY_HEAP_SCHEDULER_H
+#define DARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::DaryHeapScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a 4-ary heap event scheduler
+ *
+ * This scheduler is an implicit heap in which every node has four
+ * children, which halves the depth of the heap compared to
+ * HeapScheduler.  The heap itself only stores compact 16-byte keys,
+ * the timestamp and uid of each event plus the index of a slot
+ * holding the rest of the event (its EventImpl pointer and context).
+ * The four children of a node thus fit in 64 bytes, which the storage
+ * does not align on cache lines, so they usually span two of them; the
+ * percolations only move keys, never the event payloads.
+ *
+ * Insertion and removal of the next event are O(log(n)); removal of an
+ * arbitrary event is O(n), like in HeapScheduler.
+ */
+class DaryHeapScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  DaryHeapScheduler ();
+  /** Destructor. */
+  virtual ~DaryHeapScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** The number of children of each node. */
+  static const std::size_t ARITY = 4;
+
+  /** A heap entry: the sort key of an event and the slot of its payload. */
+  struct HeapKey
+  {
+    uint64_t m_ts;         /**< Event time stamp. */
+    uint32_t m_uid;        /**< Event unique id. */
+    uint32_t m_slot;       /**< Index of the event payload in m_slots. */
+  };
+
+  /** The payload of an event, not needed to maintain the heap. */
+  struct Slot
+  {
+    EventImpl *impl;       /**< Pointer to the event implementation. */
+    uint32_t context;      /**< Event context. */
+  };
+
+  /**
+   * Compare (less than) two keys.
+   *
+   * \param [in] a The first key.
+   * \param [in] b The second key.
+   * \returns \c true if \c a < \c b
+   */
+  static inline bool IsLess (const HeapKey &a, const HeapKey &b);
+  /**
+   * Rebuild the full Event of a key.
+   *
+   * \param [in] key The key of the event.
+   * \returns The event.
+   */
+  inline Scheduler::Event GetEvent (const HeapKey &key) const;
+  /**
+   * Move a key up from a hole, until its parent is smaller.
+   *
+   * \param [in] index The index of the hole.
+   * \param [in] key The key to store.
+   */
+  void BottomUp (std::size_t index, HeapKey key);
+  /**
+   * Move a key down from a hole, until its children are larger.
+   *
+   * \param [in] index The index of the hole.
+   * \param [in] key The key to store.
+   */
+  void TopDown (std::size_t index, HeapKey key);
+  /**
+   * Remove the key at a given index from the heap, and release its slot.
+   *
+   * \param [in] index The index of the key to remove.
+   */
+  void RemoveAt (std::size_t index);
+
+  /** The heap of event keys; the root is at index 0. */
+  std::vector<HeapKey> m_heap;
+  /** The event payloads, referenced by the keys. */
+  std::vector<Slot> m_slots;
+  /** The indices of the unused entries of m_slots. */
+  std::vector<uint32_t> m_freeSlots;
+};
+
+} // namespace ns3
+
+#endif /* DARY_HEAP_SCHEDULER_H */
@@ -72,7 +72,7 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
   m_eventCount = 0;
-  m_eventsWithContextEmpty = true;
+  m_eventsWithContext = 0;
   m_main = SystemThread::Self();
 }
 
@@ -163,30 +163,35 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  if (m_eventsWithContext.load (std::memory_order_relaxed) == 0)
     {
       return;
     }
 
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
+  // take the whole batch, and reverse it to process the events in the
+  // order in which they were pushed
+  EventWithContext *head = m_eventsWithContext.exchange (0, std::memory_order_acquire);
+  EventWithContext *batch = 0;
+  while (head != 0)
     {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
+      EventWithContext *next = head->next;
+      head->next = batch;
+      batch = head;
+      head = next;
+    }
+  while (batch != 0)
+    {
+       EventWithContext *event = batch;
+       batch = batch->next;
        Scheduler::Event ev;
-       ev.impl = event.event;
-       ev.key.m_ts = m_currentTs + event.timestamp;
-       ev.key.m_context = event.context;
+       ev.impl = event->event;
+       ev.key.m_ts = m_currentTs + event->timestamp;
+       ev.key.m_context = event->context;
        ev.key.m_uid = m_uid;
        m_uid++;
        m_unscheduledEvents++;
        m_events->Insert (ev);
+       delete event;
     }
 }
 
@@ -265,16 +270,18 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
     }
   else
     {
-      EventWithContext ev;
-      ev.context = context;
+      EventWithContext *ev = new EventWithContext;
+      ev->context = context;
       // Current time added in ProcessEventsWithContext()
-      ev.timestamp = delay.GetTimeStep ();
-      ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      ev->timestamp = delay.GetTimeStep ();
+      ev->event = event;
+      ev->next = m_eventsWithContext.load (std::memory_order_relaxed);
+      while (!m_eventsWithContext.compare_exchange_weak (ev->next, ev,
+                                                         std::memory_order_release,
+                                                         std::memory_order_relaxed))
+        {
+          // ev->next was updated with the current head; try again
+        }
     }
 }
 
@@ -25,10 +25,10 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "system-mutex.h"
 
 #include "ptr.h"
 
+#include <atomic>
 #include <list>
 
 /**
@@ -87,7 +87,13 @@ private:
   /** Move events from a different context into the main event queue. */
   void ProcessEventsWithContext (void);
  
-  /** Wrap an event with its execution context. */
+  /**
+   * Wrap an event with its execution context.
+   *
+   * Events scheduled from other threads are pushed on a lock-free
+   * intrusive stack, through the \c next field, and drained in batches
+   * by the main thread.
+   */
   struct EventWithContext {
     /** The event context. */
     uint32_t context;
@@ -95,18 +101,15 @@ private:
     uint64_t timestamp;
     /** The event implementation. */
     EventImpl *event;
+    /** The event pushed before this one. */
+    struct EventWithContext *next;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events from a different context, most recently pushed first.
+   * Producer threads push with a compare-and-swap; the main thread takes
+   * the whole stack at once with an exchange.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  std::atomic<struct EventWithContext *> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
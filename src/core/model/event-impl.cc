@@ -20,6 +20,8 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <new>
+#include <atomic>
 
 /**
  * \file
@@ -31,6 +33,153 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/**
+ * \ingroup events
+ * The free lists of released events of a thread, by size class.
+ */
+class EventImplPool
+{
+public:
+  /** Granularity of the size classes, in bytes. */
+  static const std::size_t GRANULARITY = 16;
+  /** Number of size classes; larger events are not pooled. */
+  static const std::size_t N_CLASSES = 16;
+  /**
+   * Maximum number of released events kept per size class, which bounds
+   * the memory of the threads releasing more events than they allocate,
+   * e.g., the events scheduled by other threads.
+   */
+  static const std::size_t MAX_CACHED = 1024;
+
+  /** Constructor. */
+  EventImplPool ();
+  /** Destructor, releasing the cached memory. */
+  ~EventImplPool ();
+
+  /**
+   * \param [in] size The size of an event.
+   * \returns The index of its size class.
+   */
+  static std::size_t GetClass (std::size_t size)
+  {
+    return (size + GRANULARITY - 1) / GRANULARITY - 1;
+  }
+  /**
+   * Get memory for an event of the given size class.
+   * \param [in] c The size class.
+   * \returns The allocated memory.
+   */
+  void * Allocate (std::size_t c);
+  /**
+   * Release the memory of an event of the given size class.
+   * \param [in] p The memory of the event.
+   * \param [in] c The size class.
+   */
+  void Release (void *p, std::size_t c);
+  /** Give all the cached memory back to the global operator delete. */
+  void Purge (void);
+
+  /** The statistics of this pool. */
+  EventImpl::PoolStatistics m_stats;
+
+private:
+  /** A released block of memory. */
+  struct Block
+  {
+    /** The next released block of the same size class. */
+    Block *next;
+  };
+  /** The free list of each size class. */
+  Block *m_freeLists[N_CLASSES];
+  /** The number of blocks in the free list of each size class. */
+  std::size_t m_counts[N_CLASSES];
+};
+
+/** Whether released events are kept for reuse. */
+std::atomic<bool> g_eventImplPoolEnabled (true);
+/** The event pool of each thread. */
+thread_local EventImplPool g_eventImplPool;
+/**
+ * Flag \c false once the pool of the thread has been destroyed at
+ * thread exit.  It is trivially destructible, so that it can still be
+ * read by the events released later on.
+ */
+thread_local bool g_eventImplPoolAlive = true;
+
+EventImplPool::EventImplPool ()
+{
+  m_stats.allocations = 0;
+  m_stats.reuses = 0;
+  m_stats.releases = 0;
+  m_stats.cached = 0;
+  for (std::size_t c = 0; c < N_CLASSES; c++)
+    {
+      m_freeLists[c] = 0;
+      m_counts[c] = 0;
+    }
+}
+
+EventImplPool::~EventImplPool ()
+{
+  Purge ();
+  g_eventImplPoolAlive = false;
+}
+
+void *
+EventImplPool::Allocate (std::size_t c)
+{
+  m_stats.allocations++;
+  Block *block = m_freeLists[c];
+  if (block != 0)
+    {
+      m_freeLists[c] = block->next;
+      m_counts[c]--;
+      m_stats.reuses++;
+      m_stats.cached--;
+      return block;
+    }
+  // Always allocate the full size class, so that the memory can later
+  // be reused for any event of the same class.
+  return ::operator new ((c + 1) * GRANULARITY);
+}
+
+void
+EventImplPool::Release (void *p, std::size_t c)
+{
+  m_stats.releases++;
+  if (!g_eventImplPoolEnabled.load (std::memory_order_relaxed)
+      || m_counts[c] >= MAX_CACHED)
+    {
+      ::operator delete (p);
+      return;
+    }
+  Block *block = static_cast<Block *> (p);
+  block->next = m_freeLists[c];
+  m_freeLists[c] = block;
+  m_counts[c]++;
+  m_stats.cached++;
+}
+
+void
+EventImplPool::Purge (void)
+{
+  for (std::size_t c = 0; c < N_CLASSES; c++)
+    {
+      while (m_freeLists[c] != 0)
+        {
+          Block *block = m_freeLists[c];
+          m_freeLists[c] = block->next;
+          ::operator delete (block);
+        }
+      m_counts[c] = 0;
+    }
+  m_stats.cached = 0;
+}
+
+} // unnamed namespace
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +215,60 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t c = EventImplPool::GetClass (size);
+  if (c >= EventImplPool::N_CLASSES || !g_eventImplPoolAlive)
+    {
+      return ::operator new (size);
+    }
+  return g_eventImplPool.Allocate (c);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  std::size_t c = EventImplPool::GetClass (size);
+  if (c >= EventImplPool::N_CLASSES || !g_eventImplPoolAlive)
+    {
+      ::operator delete (p);
+      return;
+    }
+  g_eventImplPool.Release (p, c);
+}
+
+void
+EventImpl::SetPoolEnabled (bool enabled)
+{
+  NS_LOG_FUNCTION (enabled);
+  g_eventImplPoolEnabled.store (enabled, std::memory_order_relaxed);
+  if (!enabled && g_eventImplPoolAlive)
+    {
+      g_eventImplPool.Purge ();
+    }
+}
+
+bool
+EventImpl::IsPoolEnabled (void)
+{
+  return g_eventImplPoolEnabled.load (std::memory_order_relaxed);
+}
+
+EventImpl::PoolStatistics
+EventImpl::GetPoolStatistics (void)
+{
+  return g_eventImplPool.m_stats;
+}
+
+void
+EventImpl::ResetPoolStatistics (void)
+{
+  // cached is the number of events kept now, not a count since the last
+  // reset, and it is needed to keep counting them
+  g_eventImplPool.m_stats.allocations = 0;
+  g_eventImplPool.m_stats.reuses = 0;
+  g_eventImplPool.m_stats.releases = 0;
+}
+
 } // namespace ns3
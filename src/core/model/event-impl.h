@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,17 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Since events are short-lived and allocated at a very high rate,
+ * instances of all the subclasses are allocated from a pool: the
+ * memory of a released event is kept in a free list, one per size
+ * class of 16 bytes and per thread, and reused for the next event of
+ * the same size class.  At most 1024 released events are kept per
+ * size class and thread, so that the threads releasing the events
+ * scheduled by other threads do not accumulate memory.  Events larger
+ * than 256 bytes are allocated directly with the global operator new.
+ * The pool can be disabled for all the threads with SetPoolEnabled(),
+ * e.g., to measure its benefit.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +78,59 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate memory for an event from the pool.
+   *
+   * \param [in] size The size of the event, in bytes.
+   * \returns The allocated memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return the memory of an event to the pool.
+   *
+   * \param [in] p The memory of the event.
+   * \param [in] size The size of the event, in bytes.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /** Statistics of the event pool of a thread. */
+  struct PoolStatistics
+  {
+    /** Number of events allocated. */
+    uint64_t allocations;
+    /** Number of events allocated by reusing the memory of a released event. */
+    uint64_t reuses;
+    /** Number of events released. */
+    uint64_t releases;
+    /** Number of released events whose memory is currently kept for reuse. */
+    uint64_t cached;
+  };
+
+  /**
+   * Enable or disable the reuse of the memory of released events.
+   *
+   * When disabled, the memory of released events is given back to the
+   * global operator delete, and the memory currently kept for reuse by
+   * the calling thread is released.
+   *
+   * \param [in] enabled \c true to enable the event pool.
+   */
+  static void SetPoolEnabled (bool enabled);
+  /**
+   * \returns \c true if the memory of released events is reused.
+   */
+  static bool IsPoolEnabled (void);
+  /**
+   * \returns The statistics of the event pool of the calling thread.
+   */
+  static PoolStatistics GetPoolStatistics (void);
+  /**
+   * Reset the statistics of the event pool of the calling thread,
+   * except for the number of cached events, which is not a count since
+   * the last reset but the number of events currently kept for reuse.
+   */
+  static void ResetPoolStatistics (void);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-queue-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderQueueScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderQueueScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderQueueScheduler);
+
+TypeId
+LadderQueueScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderQueueScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderQueueScheduler> ()
+  ;
+  return tid;
+}
+
+LadderQueueScheduler::LadderQueueScheduler ()
+  : m_topMin (0),
+    m_topMax (0),
+    m_topStart (0),
+    m_size (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderQueueScheduler::~LadderQueueScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+LadderQueueScheduler::IsLater (const Event &a, const Event &b)
+{
+  return b < a;
+}
+
+uint64_t
+LadderQueueScheduler::GetCurrent (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+LadderQueueScheduler::Bucket *
+LadderQueueScheduler::Locate (uint64_t ts)
+{
+  if (ts >= m_topStart)
+    {
+      return &m_top;
+    }
+  for (std::vector<Rung>::iterator i = m_rungs.begin (); i != m_rungs.end (); ++i)
+    {
+      if (ts >= GetCurrent (*i))
+        {
+          uint64_t index = (ts - i->start) / i->width;
+          NS_ASSERT (index < i->buckets.size ());
+          return &i->buckets[index];
+        }
+    }
+  return &m_bottom;
+}
+
+void
+LadderQueueScheduler::InsertBottom (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  Bucket::iterator i = std::upper_bound (m_bottom.begin (), m_bottom.end (), ev, &LadderQueueScheduler::IsLater);
+  m_bottom.insert (i, ev);
+  if (m_bottom.size () > THRESHOLD && m_rungs.size () < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      // Too many events inserted below the ladder: turn the Bottom into
+      // a new lowest rung, covering up to the current start of the rung
+      // above it.
+      uint64_t end = m_rungs.empty () ? m_topStart : GetCurrent (m_rungs.back ());
+      Bucket events;
+      events.swap (m_bottom);
+      SpawnRung (events, events.back ().key.m_ts, end);
+    }
+}
+
+void
+LadderQueueScheduler::SpawnRung (Bucket &events, uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << events.size () << start << end);
+  NS_ASSERT (end > start);
+  NS_ASSERT (!events.empty ());
+  uint64_t range = end - start;
+  uint64_t n = events.size ();
+  uint64_t width = std::max<uint64_t> (1, range / n + (range % n != 0));
+
+  m_rungs.push_back (Rung ());
+  Rung &rung = m_rungs.back ();
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.buckets.resize (range / width + (range % width != 0));
+  for (Bucket::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      NS_ASSERT (i->key.m_ts >= start && i->key.m_ts < end);
+      rung.buckets[(i->key.m_ts - start) / width].push_back (*i);
+    }
+  events.clear ();
+}
+
+void
+LadderQueueScheduler::FillBottom (Bucket &events)
+{
+  NS_LOG_FUNCTION (this << events.size ());
+  NS_ASSERT (m_bottom.empty ());
+  m_bottom.swap (events);
+  std::sort (m_bottom.begin (), m_bottom.end (), &LadderQueueScheduler::IsLater);
+}
+
+void
+LadderQueueScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottom.empty () && m_size > 0)
+    {
+      if (m_rungs.empty ())
+        {
+          // Spread the whole Top in a first rung.
+          NS_ASSERT (!m_top.empty ());
+          Bucket events;
+          events.swap (m_top);
+          if (m_topMin == m_topMax)
+            {
+              FillBottom (events);
+              m_topStart = m_topMax + 1;
+            }
+          else
+            {
+              SpawnRung (events, m_topMin, m_topMax + 1);
+              const Rung &rung = m_rungs.back ();
+              m_topStart = rung.start + rung.buckets.size () * rung.width;
+            }
+          continue;
+        }
+
+      Rung &rung = m_rungs.back ();
+      while (rung.current < rung.buckets.size () && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.buckets.size ())
+        {
+          m_rungs.pop_back ();
+          continue;
+        }
+
+      uint64_t start = GetCurrent (rung);
+      uint64_t width = rung.width;
+      Bucket events;
+      events.swap (rung.buckets[rung.current]);
+      rung.current++;
+      if (events.size () > THRESHOLD && width > 1 && m_rungs.size () < MAX_RUNGS)
+        {
+          SpawnRung (events, start, start + width);
+        }
+      else
+        {
+          FillBottom (events);
+        }
+    }
+}
+
+void
+LadderQueueScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = Locate (ts);
+  if (bucket == &m_top)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+    }
+  else if (bucket == &m_bottom)
+    {
+      InsertBottom (ev);
+    }
+  else
+    {
+      bucket->push_back (ev);
+    }
+  m_size++;
+  Refill ();
+}
+
+bool
+LadderQueueScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderQueueScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderQueueScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event next = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  Refill ();
+  return next;
+}
+
+void
+LadderQueueScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  Bucket *bucket = Locate (ev.key.m_ts);
+  for (Bucket::iterator i = bucket->begin (); i != bucket->end (); ++i)
+    {
+      if (i->key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (ev.impl == i->impl);
+          if (bucket == &m_bottom)
+            {
+              // The Bottom must stay sorted.
+              m_bottom.erase (i);
+            }
+          else
+            {
+              *i = bucket->back ();
+              bucket->pop_back ();
+            }
+          m_size--;
+          Refill ();
+          return;
+        }
+    }
+  NS_ASSERT (false);
+}
+
+} // namespace ns3
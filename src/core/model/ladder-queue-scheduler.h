@@ -0,0 +1,163 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2019
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_QUEUE_SCHEDULER_H
+#define LADDER_QUEUE_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderQueueScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This scheduler implements the Ladder Queue of Tang, Goh and Thng
+ * ("Ladder Queue: An O(1) priority queue structure for large-scale
+ * discrete event simulation", ACM TOMACS, 2005).  Events are kept in
+ * three tiers:
+ *
+ *  - the Top, an unsorted list of the events in the far future,
+ *  - the Ladder, a set of rungs of buckets; each rung splits one bucket
+ *    of the rung above it into finer buckets,
+ *  - the Bottom, a small sorted list of the next events.
+ *
+ * When the Bottom is empty, it is refilled from the first non-empty
+ * bucket of the lowest rung, and that bucket is split into a new rung
+ * when it holds too many events.  When the Ladder is empty, the whole
+ * Top is spread into a new first rung whose bucket width is derived
+ * from the range of the timestamps it holds.  Bucket widths thus follow
+ * the actual event distribution, instead of being resized by doubling
+ * or halving as in CalendarScheduler, which keeps insertion and removal
+ * of the next event O(1) amortized even when the distribution shifts.
+ *
+ * Removal of an arbitrary event is linear in the size of the tier, or
+ * of the bucket, which holds it.
+ */
+class LadderQueueScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderQueueScheduler ();
+  /** Destructor. */
+  virtual ~LadderQueueScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Maximum number of events in a bucket before it is split. */
+  static const uint32_t THRESHOLD = 50;
+  /** Maximum number of rungs. */
+  static const uint32_t MAX_RUNGS = 8;
+
+  /** Bucket type: an unsorted list of events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;                /**< Timestamp of the start of the first bucket. */
+    uint64_t width;                /**< Width of each bucket. */
+    uint32_t current;              /**< Index of the first bucket not yet consumed. */
+    std::vector<Bucket> buckets;   /**< The buckets. */
+  };
+
+  /**
+   * Compare two events, for sorting the Bottom by decreasing keys.
+   *
+   * \param [in] a The first event.
+   * \param [in] b The second event.
+   * \returns \c true if \c a is later than \c b
+   */
+  static bool IsLater (const Scheduler::Event &a, const Scheduler::Event &b);
+  /**
+   * Get the timestamp of the start of the first bucket of a rung which
+   * has not been consumed yet.
+   *
+   * \param [in] rung The rung.
+   * \returns The timestamp.
+   */
+  static inline uint64_t GetCurrent (const Rung &rung);
+  /**
+   * Find the container which holds (or should hold) an event.
+   *
+   * \param [in] ts The timestamp of the event.
+   * \returns The container.
+   */
+  Bucket * Locate (uint64_t ts);
+  /**
+   * Insert an event in the Bottom, keeping it sorted.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertBottom (const Scheduler::Event &ev);
+  /**
+   * Append a new rung below the lowest one, and spread events in it.
+   *
+   * \param [in,out] events The events, which are all moved to the rung.
+   * \param [in] start The start of the range covered by the new rung.
+   * \param [in] end The end of the range covered by the new rung.
+   */
+  void SpawnRung (Bucket &events, uint64_t start, uint64_t end);
+  /**
+   * Move events to the Bottom, and sort it.
+   *
+   * \param [in,out] events The events, which are all moved to the Bottom.
+   */
+  void FillBottom (Bucket &events);
+  /** Refill the Bottom from the Ladder or the Top, if it is empty. */
+  void Refill (void);
+
+  /** The Top: unsorted events later than m_topStart. */
+  Bucket m_top;
+  /** Smallest timestamp in the Top. */
+  uint64_t m_topMin;
+  /** Largest timestamp in the Top. */
+  uint64_t m_topMax;
+  /** Events with a timestamp at least m_topStart go to the Top. */
+  uint64_t m_topStart;
+  /** The rungs, from the widest to the finest. */
+  std::vector<Rung> m_rungs;
+  /** The Bottom, sorted by decreasing keys: the next event is last. */
+  Bucket m_bottom;
+  /** Number of events in the scheduler. */
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_QUEUE_SCHEDULER_H */
@@ -155,6 +155,7 @@
     {                                                           \
       if (g_log.IsEnabled (level))                              \
         {                                                       \
+          ns3::LogLock nsLogLock;                               \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -179,6 +180,7 @@
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
+          ns3::LogLock nsLogLock;                               \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -216,6 +218,7 @@
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
+          ns3::LogLock nsLogLock;                               \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -239,6 +242,7 @@
   NS_LOG_CONDITION                                              \
   do                                    \
     {                                   \
+      ns3::LogLock nsLogLock;           \
       std::clog << msg << std::endl;    \
     }                                   \
   while (false)
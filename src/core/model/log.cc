@@ -21,6 +21,8 @@
 
 #include <list>
 #include <utility>
+#include <mutex>
+#include <atomic>
 #include <iostream>
 #include "assert.h"
 #include <stdexcept>
@@ -650,6 +652,57 @@ NodePrinter LogGetNodePrinter (void)
 }
 
 
+namespace {
+
+/**
+ * \ingroup logging
+ * Get the mutex of the log output.
+ * \returns The mutex.
+ */
+std::recursive_mutex &
+GetLogMutex (void)
+{
+  static std::recursive_mutex g_logMutex;
+  return g_logMutex;
+}
+
+/**
+ * \ingroup logging
+ * The number of calls to LogLock::Enable not undone by LogLock::Disable.
+ */
+std::atomic<uint32_t> g_logLockUsers (0);
+
+} // anonymous namespace
+
+LogLock::LogLock ()
+  : m_locked (g_logLockUsers.load (std::memory_order_relaxed) != 0)
+{
+  if (m_locked)
+    {
+      GetLogMutex ().lock ();
+    }
+}
+
+LogLock::~LogLock ()
+{
+  if (m_locked)
+    {
+      GetLogMutex ().unlock ();
+    }
+}
+
+void
+LogLock::Enable (void)
+{
+  g_logLockUsers++;
+}
+
+void
+LogLock::Disable (void)
+{
+  g_logLockUsers--;
+}
+
 ParameterLogger::ParameterLogger (std::ostream &os)
   : m_first (true),
     m_os (os)
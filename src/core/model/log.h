@@ -442,6 +442,35 @@ private:
  */
 LogComponent & GetLogComponent (const std::string name);
 
+/**
+ * \ingroup logging
+ *
+ * Keep the output of the other threads, such as the partitions of a
+ * parallel simulator, from mixing with the output of a log statement,
+ * for the lifetime of the lock.  The lock is recursive, so that the
+ * arguments of a log statement can log themselves.
+ *
+ * The lock is only taken while a simulator running events in several
+ * threads, such as MultithreadedSimulatorImpl, exists: it calls Enable
+ * when created and Disable when destroyed.
+ */
+class LogLock
+{
+public:
+  /** Wait for the output of the other threads and lock it, if enabled. */
+  LogLock ();
+  /** Unlock the output of the other threads. */
+  ~LogLock ();
+
+  /** Take the lock in the log statements which start from now on. */
+  static void Enable (void);
+  /** Undo one call to Enable. */
+  static void Disable (void);
+
+private:
+  bool m_locked;  //!< Whether this statement took the lock.
+};
+
 /**
  * Insert `, ` when streaming function arguments.
  */
@@ -21,8 +21,12 @@
 #include "ns3/simulator.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/dary-heap-scheduler.h"
+#include "ns3/ladder-queue-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -461,6 +465,172 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+private:
+  virtual void DoRun (void);
+  void Chain (uint32_t n);
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the memory of released events is reused")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Chain (uint32_t n)
+{
+  if (n > 0)
+    {
+      Simulator::Schedule (NanoSeconds (1), &SimulatorEventPoolTestCase::Chain, this, n - 1);
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  bool enabled = EventImpl::IsPoolEnabled ();
+
+  EventImpl::SetPoolEnabled (true);
+  EventImpl::ResetPoolStatistics ();
+  Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Chain, this, 100);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventImpl::PoolStatistics stats = EventImpl::GetPoolStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.allocations, 101, "Unexpected number of allocated events");
+  NS_TEST_EXPECT_MSG_EQ (stats.releases, 101, "Unexpected number of released events");
+  NS_TEST_EXPECT_MSG_GT (stats.reuses, 90, "The memory of released events should be reused");
+  NS_TEST_EXPECT_MSG_GT (stats.cached, 0, "The memory of released events should be cached");
+
+  // Release more events of a size class than the pool keeps, as a thread
+  // releasing the events scheduled by other threads does
+  EventImpl::SetPoolEnabled (false);
+  EventImpl::SetPoolEnabled (true);
+  std::vector<EventImpl *> events;
+  for (uint32_t i = 0; i < 3000; i++)
+    {
+      events.push_back (MakeEvent (&SimulatorEventPoolTestCase::Chain, this, i));
+    }
+  for (uint32_t i = 0; i < events.size (); i++)
+    {
+      events[i]->Unref ();
+    }
+  stats = EventImpl::GetPoolStatistics ();
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (stats.cached, 1024, "The memory kept for a size class should be bounded");
+
+  EventImpl::SetPoolEnabled (false);
+  EventImpl::ResetPoolStatistics ();
+  Simulator::Schedule (Seconds (1), &SimulatorEventPoolTestCase::Chain, this, 100);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  stats = EventImpl::GetPoolStatistics ();
+  NS_TEST_EXPECT_MSG_EQ (stats.allocations, 101, "Unexpected number of allocated events");
+  NS_TEST_EXPECT_MSG_EQ (stats.reuses, 0, "The memory of released events should not be reused");
+  NS_TEST_EXPECT_MSG_EQ (stats.cached, 0, "The memory of released events should not be cached");
+
+  EventImpl::SetPoolEnabled (enabled);
+}
+
+/// An event which does nothing, for the scheduler tests
+class NullEventImpl : public EventImpl
+{
+protected:
+  virtual void Notify (void)
+  {
+  }
+};
+
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+private:
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the event order under random insertions and removals with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  // Feed the same random operations to the scheduler under test and to
+  // a MapScheduler reference, and compare the events they return.
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  std::vector<Scheduler::Event> pending;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t i = 0; i < 40000; ++i)
+    {
+      // Alternate phases where the population grows and shrinks, with
+      // narrow (many ties) and wide time stamp distributions.
+      uint32_t phase = (i / 5000) % 4;
+      uint32_t grow = (phase % 2 == 0) ? 7 : 3;
+      uint32_t spread = (phase < 2) ? 50 : 1000000;
+      uint32_t op = rng->GetInteger (0, 9);
+      if (op < grow || pending.empty ())
+        {
+          Scheduler::Event ev;
+          ev.impl = new NullEventImpl ();
+          ev.key.m_ts = now + rng->GetInteger (0, spread);
+          ev.key.m_uid = uid++;
+          ev.key.m_context = ev.key.m_uid * 7;
+          scheduler->Insert (ev);
+          reference->Insert (ev);
+          pending.push_back (ev);
+        }
+      else if (op < 9)
+        {
+          Scheduler::Event a = scheduler->RemoveNext ();
+          Scheduler::Event b = reference->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (a.key.m_ts, b.key.m_ts, "wrong time stamp");
+          NS_TEST_ASSERT_MSG_EQ (a.key.m_uid, b.key.m_uid, "wrong uid");
+          NS_TEST_ASSERT_MSG_EQ (a.key.m_context, b.key.m_context, "wrong context");
+          NS_TEST_ASSERT_MSG_EQ (a.impl, b.impl, "wrong event");
+          now = a.key.m_ts;
+          for (std::vector<Scheduler::Event>::iterator j = pending.begin (); j != pending.end (); ++j)
+            {
+              if (j->key.m_uid == a.key.m_uid)
+                {
+                  pending.erase (j);
+                  break;
+                }
+            }
+          a.impl->Unref ();
+        }
+      else
+        {
+          uint32_t index = rng->GetInteger (0, pending.size () - 1);
+          Scheduler::Event ev = pending[index];
+          pending.erase (pending.begin () + index);
+          scheduler->Remove (ev);
+          reference->Remove (ev);
+          ev.impl->Unref ();
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), pending.empty (), "wrong emptiness");
+    }
+  while (!pending.empty ())
+    {
+      Scheduler::Event a = scheduler->RemoveNext ();
+      Scheduler::Event b = reference->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (a.key.m_uid, b.key.m_uid, "wrong uid");
+      a.impl->Unref ();
+      pending.pop_back ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "scheduler not empty");
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +647,12 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (DaryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderQueueScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
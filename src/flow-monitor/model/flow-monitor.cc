@@ -105,9 +105,11 @@ FlowMonitor::DoDispose (void)
 inline FlowMonitor::FlowStats&
 FlowMonitor::GetStatsForFlow (FlowId flowId)
 {
-  FlowStatsContainerI iter;
-  iter = m_flowStats.find (flowId);
-  if (iter == m_flowStats.end ())
+  if (flowId < m_flowStatsIndex.size () && m_flowStatsIndex[flowId] != 0)
+    {
+      return *m_flowStatsIndex[flowId];
+    }
+  else
     {
       FlowMonitor::FlowStats &ref = m_flowStats[flowId];
       ref.delaySum = Seconds (0);
@@ -123,12 +125,13 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
       ref.jitterHistogram.SetDefaultBinWidth (m_jitterBinWidth);
       ref.packetSizeHistogram.SetDefaultBinWidth (m_packetSizeBinWidth);
       ref.flowInterruptionsHistogram.SetDefaultBinWidth (m_flowInterruptionsBinWidth);
+      if (flowId >= m_flowStatsIndex.size ())
+        {
+          m_flowStatsIndex.resize (flowId + 1, 0);
+        }
+      m_flowStatsIndex[flowId] = &ref;
       return ref;
     }
-  else
-    {
-      return iter->second;
-    }
 }
 
 
@@ -298,9 +301,9 @@ FlowMonitor::CheckForLostPackets (Time maxDelay)
       if (now - iter->second.lastSeenTime >= maxDelay)
         {
           // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
+          FlowId flowId = iter->first.first;
+          NS_ASSERT (flowId < m_flowStatsIndex.size () && m_flowStatsIndex[flowId] != 0);
+          m_flowStatsIndex[flowId]->lostPackets++;
 
           // we won't track it anymore
           m_trackedPackets.erase (iter++);
@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
@@ -272,11 +273,26 @@ private:
     uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
   };
 
+  /// Hash of a (FlowId,PacketId) pair
+  struct TrackedPacketHash
+  {
+    /// \param key the (FlowId,PacketId) pair
+    /// \returns the hash of the pair
+    size_t operator() (const std::pair<FlowId, FlowPacketId> &key) const
+    {
+      return std::hash<uint64_t> () ((static_cast<uint64_t> (key.first) << 32) | key.second);
+    }
+  };
+
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
+  /// FlowId --> FlowStats in m_flowStats, or 0 if the flow has no stats yet.
+  /// The classifiers allocate FlowIds densely, so this avoids a map
+  /// lookup for each reported packet.
+  std::vector<FlowStats *> m_flowStatsIndex;
 
   /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
+  typedef std::unordered_map< std::pair<FlowId, FlowPacketId>, TrackedPacket, TrackedPacketHash> TrackedPacketMap;
   TrackedPacketMap m_trackedPackets; //!< Tracked packets
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
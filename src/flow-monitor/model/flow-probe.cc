@@ -41,7 +41,9 @@ FlowProbe::~FlowProbe ()
 
 
 FlowProbe::FlowProbe (Ptr<FlowMonitor> flowMonitor)
-  : m_flowMonitor (flowMonitor)
+  : m_flowMonitor (flowMonitor),
+    m_lastFlowId (0),
+    m_lastFlowStats (0)
 {
   m_flowMonitor->AddProbe (this);
 }
@@ -53,10 +55,29 @@ FlowProbe::DoDispose (void)
   Object::DoDispose ();
 }
 
+FlowProbe::Stats&
+FlowProbe::GetStatsForModification (void)
+{
+  // the caller may erase the cached stats
+  m_lastFlowStats = 0;
+  return m_stats;
+}
+
+FlowProbe::FlowStats&
+FlowProbe::GetStatsForFlow (FlowId flowId)
+{
+  if (m_lastFlowStats == 0 || m_lastFlowId != flowId)
+    {
+      m_lastFlowId = flowId;
+      m_lastFlowStats = &m_stats[flowId];
+    }
+  return *m_lastFlowStats;
+}
+
 void
 FlowProbe::AddPacketStats (FlowId flowId, uint32_t packetSize, Time delayFromFirstProbe)
 {
-  FlowStats &flow = m_stats[flowId];
+  FlowStats &flow = GetStatsForFlow (flowId);
   flow.delayFromFirstProbeSum += delayFromFirstProbe;
   flow.bytes += packetSize;
   ++flow.packets;
@@ -65,7 +86,7 @@ FlowProbe::AddPacketStats (FlowId flowId, uint32_t packetSize, Time delayFromFir
 void
 FlowProbe::AddPacketDropStats (FlowId flowId, uint32_t packetSize, uint32_t reasonCode)
 {
-  FlowStats &flow = m_stats[flowId];
+  FlowStats &flow = GetStatsForFlow (flowId);
 
   if (flow.packetsDropped.size () < reasonCode + 1)
     {
@@ -103,8 +103,25 @@ public:
   void SerializeToXmlStream (std::ostream &os, uint16_t indent, uint32_t index) const;
 
 protected:
+  /// Get the flow statistics stored in this probe, for modification.
+  /// The reference must not be kept, since the stats of the last flow
+  /// are cached by the probe.
+  /// \returns the flow statistics
+  Stats& GetStatsForModification (void);
+
   Ptr<FlowMonitor> m_flowMonitor; //!< the FlowMonitor instance
+
+private:
+  /// Get the stats of a flow, creating them if needed.  The stats of
+  /// the last flow are cached, as consecutive packets seen by a probe
+  /// often belong to the same flow.
+  /// \param flowId the flow Identifier
+  /// \returns the stats of the flow
+  FlowStats& GetStatsForFlow (FlowId flowId);
+
   Stats m_stats; //!< The flow stats
+  FlowId m_lastFlowId; //!< The flow of the last reported packet
+  FlowStats *m_lastFlowStats; //!< The stats of m_lastFlowId in m_stats, or 0
 
 };
 
@@ -97,6 +97,16 @@ bool operator == (const Ipv6FlowClassifier::FiveTuple &t1,
 
 
 
+size_t
+Ipv6FlowClassifier::FiveTupleHash::operator() (const FiveTuple &t) const
+{
+  size_t hash = Ipv6AddressHash () (t.sourceAddress);
+  hash = hash * 31 + Ipv6AddressHash () (t.destinationAddress);
+  hash = hash * 31 + t.protocol;
+  hash = hash * 31 + ((static_cast<uint32_t> (t.sourcePort) << 16) | t.destinationPort);
+  return hash;
+}
+
 Ipv6FlowClassifier::Ipv6FlowClassifier ()
 {
 }
@@ -149,35 +159,30 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
   tuple.destinationPort = dstPort;
 
   // try to insert the tuple, but check if it already exists
-  std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert
+  std::pair<std::unordered_map<FiveTuple, FlowId, FiveTupleHash>::iterator, bool> insert
     = m_flowMap.insert (std::pair<FiveTuple, FlowId> (tuple, 0));
 
   // if the insertion succeeded, we need to assign this tuple a new flow identifier
   if (insert.second)
     {
       FlowId newFlowId = GetNewFlowId ();
+      NS_ASSERT (newFlowId == m_flows.size () + 1);
       insert.first->second = newFlowId;
-      m_flowPktIdMap[newFlowId] = 0;
-      m_flowDscpMap[newFlowId];
+      m_flows.push_back (FlowData ());
+      m_flows.back ().tuple = tuple;
+      m_flows.back ().lastPacketId = 0;
     }
   else
     {
-      m_flowPktIdMap[insert.first->second] ++;
+      m_flows[insert.first->second - 1].lastPacketId ++;
     }
 
   // increment the counter of packets with the same DSCP value
-  Ipv6Header::DscpType dscp = ipHeader.GetDscp ();
-  std::pair<std::map<Ipv6Header::DscpType, uint32_t>::iterator, bool> dscpInserter
-    = m_flowDscpMap[insert.first->second].insert (std::pair<Ipv6Header::DscpType, uint32_t> (dscp, 1));
-
-  // if the insertion did not succeed, we need to increment the counter
-  if (!dscpInserter.second)
-    {
-      m_flowDscpMap[insert.first->second][dscp] ++;
-    }
+  FlowData &flow = m_flows[insert.first->second - 1];
+  flow.dscpCounts[ipHeader.GetDscp ()] ++;
 
   *out_flowId = insert.first->second;
-  *out_packetId = m_flowPktIdMap[*out_flowId];
+  *out_packetId = flow.lastPacketId;
 
   return true;
 }
@@ -186,13 +191,9 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
 Ipv6FlowClassifier::FiveTuple
 Ipv6FlowClassifier::FindFlow (FlowId flowId) const
 {
-  for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+  if (flowId > 0 && flowId <= m_flows.size ())
     {
-      if (iter->second == flowId)
-        {
-          return iter->first;
-        }
+      return m_flows[flowId - 1].tuple;
     }
   NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
   FiveTuple retval = { Ipv6Address::GetZero (), Ipv6Address::GetZero (), 0, 0, 0 };
@@ -209,15 +210,13 @@ Ipv6FlowClassifier::SortByCount::operator() (std::pair<Ipv6Header::DscpType, uin
 std::vector<std::pair<Ipv6Header::DscpType, uint32_t> >
 Ipv6FlowClassifier::GetDscpCounts (FlowId flowId) const
 {
-  std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
-    = m_flowDscpMap.find (flowId);
-
-  if (flow == m_flowDscpMap.end ())
+  if (flowId == 0 || flowId > m_flows.size ())
     {
       NS_FATAL_ERROR ("Could not find the flow with ID " << flowId);
     }
 
-  std::vector<std::pair<Ipv6Header::DscpType, uint32_t> > v (flow->second.begin (), flow->second.end ());
+  const std::map<Ipv6Header::DscpType, uint32_t> &dscpCounts = m_flows[flowId - 1].dscpCounts;
+  std::vector<std::pair<Ipv6Header::DscpType, uint32_t> > v (dscpCounts.begin (), dscpCounts.end ());
   std::sort (v.begin (), v.end (), SortByCount ());
   return v;
 }
@@ -228,8 +227,10 @@ Ipv6FlowClassifier::SerializeToXmlStream (std::ostream &os, uint16_t indent) con
   Indent (os, indent); os << "<Ipv6FlowClassifier>\n";
 
   indent += 2;
+  // list the flows in the order of their FiveTuple
+  std::map<FiveTuple, FlowId> sorted (m_flowMap.begin (), m_flowMap.end ());
   for (std::map<FiveTuple, FlowId>::const_iterator
-       iter = m_flowMap.begin (); iter != m_flowMap.end (); iter++)
+       iter = sorted.begin (); iter != sorted.end (); iter++)
     {
       Indent (os, indent);
       os << "<Flow flowId=\"" << iter->second << "\""
@@ -240,17 +241,12 @@ Ipv6FlowClassifier::SerializeToXmlStream (std::ostream &os, uint16_t indent) con
          << " destinationPort=\"" << iter->first.destinationPort << "\">\n";
 
       indent += 2;
-      std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> >::const_iterator flow
-        = m_flowDscpMap.find (iter->second);
-
-      if (flow != m_flowDscpMap.end ())
+      const std::map<Ipv6Header::DscpType, uint32_t> &dscpCounts = m_flows[iter->second - 1].dscpCounts;
+      for (std::map<Ipv6Header::DscpType, uint32_t>::const_iterator i = dscpCounts.begin (); i != dscpCounts.end (); i++)
         {
-          for (std::map<Ipv6Header::DscpType, uint32_t>::const_iterator i = flow->second.begin (); i != flow->second.end (); i++)
-            {
-              Indent (os, indent);
-              os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t> (i->first) << "\""
-                 << " packets=\"" << std::dec << i->second << "\" />\n";
-            }
+          Indent (os, indent);
+          os << "<Dscp value=\"0x" << std::hex << static_cast<uint32_t> (i->first) << "\""
+             << " packets=\"" << std::dec << i->second << "\" />\n";
         }
 
       indent -= 2;
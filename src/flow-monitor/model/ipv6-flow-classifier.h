@@ -24,6 +24,8 @@
 
 #include <stdint.h>
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "ns3/ipv6-header.h"
 #include "ns3/flow-classifier.h"
@@ -93,12 +95,27 @@ public:
 
 private:
 
+  /// Hash function of a FiveTuple
+  struct FiveTupleHash
+  {
+    /// \param t the FiveTuple
+    /// \returns the hash of \p t
+    size_t operator() (const FiveTuple &t) const;
+  };
+
+  /// Structure holding the packet counter and DSCP values of a flow
+  struct FlowData
+  {
+    FiveTuple tuple;              //!< Flow Identifier
+    FlowPacketId lastPacketId;    //!< Identifier of the last packet of the flow
+    /// (DSCP value, packet count) pairs
+    std::map<Ipv6Header::DscpType, uint32_t> dscpCounts;
+  };
+
   /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-  /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> > m_flowDscpMap;
+  std::unordered_map<FiveTuple, FlowId, FiveTupleHash> m_flowMap;
+  /// Flows data, indexed by FlowId - 1 (FlowIds are allocated densely)
+  std::vector<FlowData> m_flows;
 
 };
 
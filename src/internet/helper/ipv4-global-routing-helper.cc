@@ -71,5 +71,17 @@ Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
   GlobalRouteManager::InitializeRoutes ();
 }
 
+void
+Ipv4GlobalRoutingHelper::UpdateRoutingTables (void)
+{
+  GlobalRouteManager::UpdateRoutes ();
+}
+
+void
+Ipv4GlobalRoutingHelper::PrintTimings (std::ostream &os)
+{
+  GlobalRouteManager::PrintTimings (os);
+}
+
 
 } // namespace ns3
@@ -84,6 +84,29 @@ public:
    *
    */
   static void RecomputeRoutingTables (void);
+  /**
+   * \brief Update the routes installed by PopulateRoutingTables() to the
+   * current global topology.
+   *
+   * The result is the same routes, in the same order, as
+   * RecomputeRoutingTables(), but only the routers whose shortest paths may
+   * go through a link that changed, or which reach a router or network
+   * whose advertisement changed, are recomputed.  The first call recomputes
+   * the routes of all the routers.
+   *
+   */
+  static void UpdateRoutingTables (void);
+  /**
+   * \brief Print the time spent building the global routing database and
+   * computing the routes, the last time the routing tables were populated
+   * or recomputed.
+   *
+   * The routes are computed by the number of threads given by the
+   * "GlobalRoutingThreads" global value.
+   *
+   * \param os the output stream
+   */
+  static void PrintTimings (std::ostream &os);
 private:
   /**
    * \brief Assignment operator declared private and not implemented to disallow
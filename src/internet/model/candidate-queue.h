@@ -22,7 +22,8 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -46,7 +47,9 @@ class SPFVertex;
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
- * enhanced priority queue.
+ * enhanced priority queue.  It is a binary heap, indexed by vertex ID;
+ * vertices at the same distance and of the same type are popped in the
+ * order in which they were pushed.
  */
 class CandidateQueue
 {
@@ -154,6 +157,19 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Reorders the Candidate Queue after the value of the field
+ * m_distanceFromRoot of one of its vertices changed.
+ *
+ * This is cheaper than Reorder () when a single vertex changed.  The
+ * vertex is then popped after the other vertices at the same distance and
+ * of the same type.
+ *
+ * @see SPFVertex
+ * @param v The Shortest Path First Vertex whose distance changed.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -184,8 +200,47 @@ private:
  */
   static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  /**
+   * \brief A vertex in the queue.
+   */
+  struct Candidate
+  {
+    SPFVertex *vertex;  //!< The vertex.
+    uint64_t sequence;  //!< The order in which the vertex was pushed.
+  };
+
+/**
+ * \brief return true if c1 must be popped before c2
+ *
+ * \param c1 first operand
+ * \param c2 second operand
+ * \return True if c1 should be popped before c2; false otherwise
+ */
+  static bool CompareCandidate (const Candidate &c1, const Candidate &c2);
+
+/**
+ * \brief Move a candidate towards the top of the heap.
+ * \param i The index of the candidate in the heap.
+ */
+  void SiftUp (uint32_t i);
+
+/**
+ * \brief Move a candidate towards the bottom of the heap.
+ * \param i The index of the candidate in the heap.
+ */
+  void SiftDown (uint32_t i);
+
+/**
+ * \brief Store a candidate in the heap.
+ * \param i The index of the candidate in the heap.
+ * \param c The candidate.
+ */
+  void Place (uint32_t i, const Candidate &c);
+
+  typedef std::vector<Candidate> CandidateList_t; //!< container of SPFVertex pointers
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, as a binary heap
+  std::map<Ipv4Address, uint32_t> m_positions; //!< index of the candidates in the heap, by vertex ID
+  uint64_t m_sequence; //!< the sequence number of the next pushed vertex
 
   /**
    * \brief Stream insertion operator.
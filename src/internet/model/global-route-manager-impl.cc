@@ -27,9 +27,17 @@
 #include <queue>
 #include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <thread>
+#include "ns3/core-config.h"
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-wall-clock-ms.h"
 #include "ns3/node-list.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
@@ -40,10 +48,25 @@
 #include "candidate-queue.h"
 #include "ipv4-global-routing.h"
 
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \ingroup globalrouting
+ * The number of threads running the SPF calculations of
+ * GlobalRouteManagerImpl::InitializeRoutes ().
+ */
+static GlobalValue g_globalRoutingThreads = GlobalValue ("GlobalRoutingThreads",
+                                                         "The number of threads computing the global routes, "
+                                                         "or 0 for one thread per processor",
+                                                         UintegerValue (0),
+                                                         MakeUintegerChecker<uint32_t> ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -470,7 +493,29 @@ GlobalRouteManagerLSDB::Insert (Ipv4Address addr, GlobalRoutingLSA* lsa)
     } 
   else
     {
-      m_database.insert (LSDBPair_t (addr, lsa));
+      if (!m_database.insert (LSDBPair_t (addr, lsa)).second)
+        {
+          return;
+        }
+//
+// Index the LSA by the Link Data of its TransitNetwork link records.  When
+// several LSAs have the same Link Data, GetLSAByLinkData () returns the one
+// with the lowest address.
+//
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+          if (lr->GetLinkType () != GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              continue;
+            }
+          std::pair<LSDBMap_t::iterator, bool> i = 
+            m_linkDataIndex.insert (LSDBPair_t (lr->GetLinkData (), lsa));
+          if (!i.second && addr < i.first->second->GetLinkStateId ())
+            {
+              i.first->second = lsa;
+            }
+        }
     }
 }
 
@@ -495,38 +540,36 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
 
+void
+GlobalRouteManagerLSDB::GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const
+{
+  NS_LOG_FUNCTION (this);
+  lsas.clear ();
+  for (LSDBMap_t::const_iterator i = m_database.begin (); i != m_database.end (); i++)
+    {
+      lsas.push_back (i->second);
+    }
+}
+
 GlobalRoutingLSA*
 GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this << addr);
 //
-// Look up an LSA by its address.
+// Look up an LSA by the Link Data of one of its TransitNetwork link records.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_linkDataIndex.find (addr);
+  if (i != m_linkDataIndex.end ())
     {
-      GlobalRoutingLSA* temp = i->second;
-// Iterate among temp's Link Records
-      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
-        {
-          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
-          if ( lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork &&
-               lr->GetLinkData () == addr)
-            {
-              return temp;
-            }
-        }
+      return i->second;
     }
   return 0;
 }
@@ -539,7 +582,12 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_spfstate (0),
+    m_lsdbTime (0),
+    m_spfTime (0),
+    m_spfRouters (0),
+    m_spfThreads (0)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
@@ -578,20 +626,10 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      NS_LOG_LOGIC ("Deleting routes from node " << node->GetId ());
+      DeleteRoutes (router->GetRoutingProtocol ());
     }
+  m_spfstates.clear ();
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -600,6 +638,24 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Ipv4GlobalRouting> gr)
+{
+  NS_LOG_FUNCTION (this << gr);
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes");
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j);
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes");
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -613,6 +669,8 @@ void
 GlobalRouteManagerImpl::BuildGlobalRoutingDatabase () 
 {
   NS_LOG_FUNCTION (this);
+  SystemWallClockMs clock;
+  clock.Start ();
 //
 // Walk the list of nodes looking for the GlobalRouter Interface.  Nodes with
 // global router interfaces are, not too surprisingly, our routers.
@@ -657,6 +715,8 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
           m_lsdb->Insert (lsa->GetLinkStateId (), lsa); 
         }
     }
+  m_lsdbTime = clock.End ();
+  NS_LOG_INFO ("Built the LSDB in " << m_lsdbTime << " ms");
 }
 
 //
@@ -696,10 +756,14 @@ void
 GlobalRouteManagerImpl::InitializeRoutes ()
 {
   NS_LOG_FUNCTION (this);
+  SystemWallClockMs clock;
+  clock.Start ();
 //
 // Walk the list of nodes in the system.
 //
   NS_LOG_INFO ("About to start SPF calculation");
+  m_spfstates.clear ();
+  std::vector<SPFRoot> roots;
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -724,10 +788,439 @@ GlobalRouteManagerImpl::InitializeRoutes ()
 //
       if (rtr && rtr->GetNumLSAs () )
         {
-          SPFCalculate (rtr->GetRouterId ());
+          SPFRoot root;
+          root.routerId = rtr->GetRouterId ();
+          root.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (root.ipv4, 
+                         "GlobalRouteManagerImpl::InitializeRoutes (): "
+                         "GetObject for <Ipv4> interface failed");
+          root.routing = rtr->GetRoutingProtocol ();
+          roots.push_back (root);
+        }
+    }
+//
+// The nodes were all looked up above: the SPF calculations only read the
+// LSDB and change the routes of their own root, so that they can run on
+// several threads.  Each thread uses its own GlobalRouteManagerImpl, for the
+// state of the calculation, on the LSDB of this one.
+//
+  UintegerValue threadsValue;
+  g_globalRoutingThreads.GetValue (threadsValue);
+  uint32_t threads = threadsValue.Get ();
+  if (threads == 0)
+    {
+      threads = std::thread::hardware_concurrency ();
+    }
+#ifndef HAVE_PTHREAD_H
+  threads = 1;
+#endif
+  threads = std::max<uint32_t> (1, std::min<uint32_t> (threads, roots.size ()));
+  std::vector<GlobalRouteManagerImpl *> workers (1, this);
+  for (uint32_t k = 1; k < threads; k++)
+    {
+      GlobalRouteManagerImpl *worker = new GlobalRouteManagerImpl ();
+      delete worker->m_lsdb;
+      worker->m_lsdb = m_lsdb;
+      workers.push_back (worker);
+    }
+  m_spfroots.clear ();
+  for (uint32_t j = 0; j < roots.size (); j++)
+    {
+      workers[j % threads]->m_spfroots.push_back (roots[j]);
+    }
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > systemThreads;
+  for (uint32_t k = 1; k < threads; k++)
+    {
+      systemThreads.push_back (Create<SystemThread> (MakeCallback (&GlobalRouteManagerImpl::SPFCalculateRoots, workers[k])));
+      systemThreads.back ()->Start ();
+    }
+#endif
+  SPFCalculateRoots ();
+#ifdef HAVE_PTHREAD_H
+  for (uint32_t k = 0; k < systemThreads.size (); k++)
+    {
+      systemThreads[k]->Join ();
+    }
+#endif
+  for (uint32_t k = 1; k < threads; k++)
+    {
+      workers[k]->m_lsdb = 0;
+      delete workers[k];
+    }
+  m_spfroots.clear ();
+  m_spfTime = clock.End ();
+  m_spfRouters = roots.size ();
+  m_spfThreads = threads;
+  NS_LOG_INFO ("Finished SPF calculation of " << m_spfRouters << " routers in "
+               << m_spfTime << " ms with " << m_spfThreads << " threads");
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateRoots ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_spfroots.size (); i++)
+    {
+      SPFCalculate (m_spfroots[i], 0);
+    }
+}
+
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::FindSPFRoot (Ipv4Address routerId)
+{
+  NS_LOG_FUNCTION (routerId);
+  SPFRoot root;
+  root.routerId = routerId;
+//
+// Walk the list of nodes looking for the one that has the router ID: this
+// is the node to which we are going to write the routing information.
+//
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr && rtr->GetRouterId () == routerId)
+        {
+          root.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (root.ipv4, 
+                         "GlobalRouteManagerImpl::FindSPFRoot (): "
+                         "GetObject for <Ipv4> interface failed");
+          root.routing = rtr->GetRoutingProtocol ();
+          return root;
+        }
+    }
+  NS_LOG_LOGIC ("Can't find root node " << routerId);
+  return root;
+}
+
+void
+GlobalRouteManagerImpl::PrintTimings (std::ostream &os) const
+{
+  os << "Global routing: LSDB built in " << m_lsdbTime << " ms, routes of "
+     << m_spfRouters << " routers computed in " << m_spfTime << " ms with "
+     << m_spfThreads << " threads" << std::endl;
+}
+
+GlobalRoutingLSA::SPFStatus
+GlobalRouteManagerImpl::GetLSAStatus (const GlobalRoutingLSA* lsa) const
+{
+  std::map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus>::const_iterator i = m_spfstatus.find (lsa);
+  return i == m_spfstatus.end () ? GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED : i->second;
+}
+
+void
+GlobalRouteManagerImpl::SetLSAStatus (const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status)
+{
+  m_spfstatus[lsa] = status;
+}
+
+//
+// Incremental version of DeleteGlobalRoutes (), BuildGlobalRoutingDatabase ()
+// and InitializeRoutes ().
+//
+// The new database is compared with the previous one, which gives the LSAs
+// whose content changed and the links of the SPF graph which were removed or
+// added (a link whose cost or Link Data changed is both).  For each router,
+// the result of its last SPF calculation tells whether these changes can
+// matter:
+//
+// - a removed link matters if it was on a shortest path, that is, if the
+//   distance of its origin plus its cost was the distance of its end;
+// - an added link matters if it gives a path to its end which is not longer
+//   than the known one;
+// - a link from or to the router, or from or to a vertex adjacent to the
+//   router, matters since it gives the next hops of the router.
+//
+// If no change matters and no LSA of a vertex reached by the router changed,
+// the routes of the router are unchanged and it is skipped.  Otherwise, all
+// its routes are deleted and computed again, so that they are added in the
+// same order as InitializeRoutes () adds them.
+//
+void
+GlobalRouteManagerImpl::UpdateRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  GlobalRouteManagerLSDB *oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+//
+// Find the LSAs which changed.
+//
+  std::set<Ipv4Address> changed;
+  std::vector<GlobalRoutingLSA*> oldLsas;
+  std::vector<GlobalRoutingLSA*> newLsas;
+  oldLsdb->GetLSAs (oldLsas);
+  m_lsdb->GetLSAs (newLsas);
+  std::vector<GlobalRoutingLSA*>::const_iterator i = oldLsas.begin ();
+  std::vector<GlobalRoutingLSA*>::const_iterator j = newLsas.begin ();
+  while (i != oldLsas.end () || j != newLsas.end ())
+    {
+      if (j == newLsas.end () 
+          || (i != oldLsas.end () && (*i)->GetLinkStateId () < (*j)->GetLinkStateId ()))
+        {
+          changed.insert ((*i)->GetLinkStateId ());
+          i++;
+        }
+      else if (i == oldLsas.end () || (*j)->GetLinkStateId () < (*i)->GetLinkStateId ())
+        {
+          changed.insert ((*j)->GetLinkStateId ());
+          j++;
+        }
+      else
+        {
+          if (!IsSameLSA (*i, *j))
+            {
+              changed.insert ((*i)->GetLinkStateId ());
+            }
+          i++;
+          j++;
+        }
+    }
+  NS_LOG_LOGIC (changed.size () << " LSAs changed");
+//
+// Find the links which changed.
+//
+  std::vector<SPFEdge> oldEdges;
+  std::vector<SPFEdge> newEdges;
+  GetSPFEdges (oldLsdb, oldEdges);
+  GetSPFEdges (m_lsdb, newEdges);
+  std::vector<SPFEdge> removed;
+  std::vector<SPFEdge> added;
+  std::set_difference (oldEdges.begin (), oldEdges.end (), newEdges.begin (), newEdges.end (),
+                       std::back_inserter (removed), &GlobalRouteManagerImpl::CompareSPFEdge);
+  std::set_difference (newEdges.begin (), newEdges.end (), oldEdges.begin (), oldEdges.end (),
+                       std::back_inserter (added), &GlobalRouteManagerImpl::CompareSPFEdge);
+  NS_LOG_LOGIC (removed.size () << " links removed, " << added.size () << " links added");
+//
+// Find the routers whose External LSAs changed.
+//
+  std::vector<GlobalRoutingLSA*> oldExternals;
+  std::vector<GlobalRoutingLSA*> newExternals;
+  for (uint32_t k = 0; k < oldLsdb->GetNumExtLSAs (); k++)
+    {
+      oldExternals.push_back (oldLsdb->GetExtLSA (k));
+    }
+  for (uint32_t k = 0; k < m_lsdb->GetNumExtLSAs (); k++)
+    {
+      newExternals.push_back (m_lsdb->GetExtLSA (k));
+    }
+  std::sort (oldExternals.begin (), oldExternals.end (), &GlobalRouteManagerImpl::CompareASExternal);
+  std::sort (newExternals.begin (), newExternals.end (), &GlobalRouteManagerImpl::CompareASExternal);
+  std::vector<GlobalRoutingLSA*> changedExternals;
+  std::set_symmetric_difference (oldExternals.begin (), oldExternals.end (), newExternals.begin (), newExternals.end (),
+                                 std::back_inserter (changedExternals), &GlobalRouteManagerImpl::CompareASExternal);
+  std::set<Ipv4Address> advertisers;
+  for (uint32_t k = 0; k < changedExternals.size (); k++)
+    {
+      advertisers.insert (changedExternals[k]->GetAdvertisingRouter ());
+    }
+//
+// Update the routes of each router.
+//
+  uint32_t systemId = MpiInterface::GetSystemId ();
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator n = NodeList::Begin (); n != listEnd; n++)
+    {
+      Ptr<Node> node = *n;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (!rtr || node->GetSystemId () != systemId)
+        {
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> gr = rtr->GetRoutingProtocol ();
+      Ipv4Address root = rtr->GetRouterId ();
+      SPFRoot spfRoot;
+      spfRoot.routerId = root;
+      spfRoot.ipv4 = node->GetObject<Ipv4> ();
+      spfRoot.routing = gr;
+      std::map<Ipv4Address, SPFRootState>::iterator s = m_spfstates.find (root);
+      if (!rtr->GetNumLSAs ())
+        {
+          if (s != m_spfstates.end ())
+            {
+              DeleteRoutes (gr);
+              m_spfstates.erase (s);
+            }
+          continue;
+        }
+      if (s != m_spfstates.end () && !changed.count (root)
+          && !(s->second.hasUplink && changed.count (s->second.uplink)))
+        {
+          const SPFRootState &state = s->second;
+          if (state.stub)
+            {
+              continue;
+            }
+          bool affected = SPFIsAffected (root, state, removed, added);
+          for (std::set<Ipv4Address>::const_iterator c = changed.begin (); !affected && c != changed.end (); c++)
+            {
+              affected = state.vertices.count (*c) != 0;
+            }
+          for (std::set<Ipv4Address>::const_iterator a = advertisers.begin (); !affected && a != advertisers.end (); a++)
+            {
+              affected = *a != root && state.vertices.count (*a) != 0;
+            }
+          if (!affected)
+            {
+              continue;
+            }
+        }
+      NS_LOG_LOGIC ("Recomputing all the routes of node " << node->GetId ());
+      DeleteRoutes (gr);
+      SPFRootState &state = m_spfstates[root];
+      state.vertices.clear ();
+      SPFCalculate (spfRoot, &state);
+    }
+  delete oldLsdb;
+}
+
+bool
+GlobalRouteManagerImpl::SPFIsAffected (Ipv4Address root, const SPFRootState& state,
+                                       const std::vector<SPFEdge>& removed,
+                                       const std::vector<SPFEdge>& added)
+{
+  NS_LOG_FUNCTION (root);
+  for (uint32_t k = 0; k < removed.size () + added.size (); k++)
+    {
+      bool isRemoved = k < removed.size ();
+      const SPFEdge &e = isRemoved ? removed[k] : added[k - removed.size ()];
+      if (e.from == root || e.to == root)
+        {
+          return true;
+        }
+      std::map<Ipv4Address, SPFVertexState>::const_iterator from = state.vertices.find (e.from);
+      if (from == state.vertices.end ())
+        {
+          // The link is not reachable from the root
+          continue;
+        }
+      std::map<Ipv4Address, SPFVertexState>::const_iterator to = state.vertices.find (e.to);
+      if (from->second.direct || (to != state.vertices.end () && to->second.direct))
+        {
+          return true;
+        }
+      uint64_t distance = static_cast<uint64_t> (from->second.distance) + e.metric;
+      uint64_t toDistance = to != state.vertices.end () ? to->second.distance : std::numeric_limits<uint64_t>::max ();
+      if (isRemoved ? distance == toDistance : distance <= toDistance)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::GetSPFEdges (const GlobalRouteManagerLSDB* lsdb, std::vector<SPFEdge>& edges)
+{
+  NS_LOG_FUNCTION (lsdb);
+  std::vector<GlobalRoutingLSA*> lsas;
+  lsdb->GetLSAs (lsas);
+  for (uint32_t i = 0; i < lsas.size (); i++)
+    {
+      GlobalRoutingLSA *lsa = lsas[i];
+      SPFEdge e;
+      e.from = lsa->GetLinkStateId ();
+      if (lsa->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+            {
+              GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+              if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+                {
+                  continue;
+                }
+              e.to = l->GetLinkId ();
+              e.metric = l->GetMetric ();
+              e.linkData = l->GetLinkData ();
+              edges.push_back (e);
+            }
+        }
+      else if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < lsa->GetNAttachedRouters (); j++)
+            {
+              Ipv4Address router = lsa->GetAttachedRouter (j);
+              GlobalRoutingLSA *w_lsa = lsdb->GetLSAByLinkData (router);
+              if (w_lsa == 0)
+                {
+                  continue;
+                }
+              e.to = w_lsa->GetLinkStateId ();
+              e.metric = 0;
+              e.linkData = router;
+              edges.push_back (e);
+            }
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
+  std::sort (edges.begin (), edges.end (), &GlobalRouteManagerImpl::CompareSPFEdge);
+}
+
+bool
+GlobalRouteManagerImpl::CompareSPFEdge (const SPFEdge& a, const SPFEdge& b)
+{
+  if (a.from != b.from)
+    {
+      return a.from < b.from;
+    }
+  if (a.to != b.to)
+    {
+      return a.to < b.to;
+    }
+  if (a.metric != b.metric)
+    {
+      return a.metric < b.metric;
+    }
+  return a.linkData < b.linkData;
+}
+
+bool
+GlobalRouteManagerImpl::CompareASExternal (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+  if (a->GetAdvertisingRouter () != b->GetAdvertisingRouter ())
+    {
+      return a->GetAdvertisingRouter () < b->GetAdvertisingRouter ();
+    }
+  if (a->GetLinkStateId () != b->GetLinkStateId ())
+    {
+      return a->GetLinkStateId () < b->GetLinkStateId ();
+    }
+  return a->GetNetworkLSANetworkMask ().Get () < b->GetNetworkLSANetworkMask ().Get ();
+}
+
+bool
+GlobalRouteManagerImpl::IsSameLSA (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
 }
 
 //
@@ -836,7 +1329,8 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      GlobalRoutingLSA::SPFStatus w_status = GetLSAStatus (w_lsa);
+      if (w_status == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1355,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (w_status == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -873,7 +1367,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
           w = new SPFVertex (w_lsa);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              SetLSAStatus (w_lsa, GlobalRoutingLSA::LSA_SPF_CANDIDATE);
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1382,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (w_status == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -960,7 +1454,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Reorder (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1124,7 +1618,8 @@ GlobalRouteManagerImpl::SPFNexthopCalculation (
         }
       else 
         {
-          w->SetRootExitDirection (v->GetRootExitDirection ());
+// The network may be reached through several equal cost paths
+          w->InheritAllRootExitDirections (v);
         }
     }
   else 
@@ -1320,12 +1815,9 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-                  NS_ASSERT (gr);
-                  gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
-                                         FindOutgoingInterfaceId (transitLink->GetLinkData ()));
+                  NS_ASSERT (m_spfrouting);
+                  m_spfrouting->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
+                                                   FindOutgoingInterfaceId (transitLink->GetLinkData ()));
                   NS_LOG_LOGIC ("Inserting default route for node " << myRouterId << " to next hop " << 
                                 lr->GetLinkData () << " via interface " << 
                                 FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1342,12 +1834,23 @@ void
 GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
+  SPFCalculate (FindSPFRoot (root), 0);
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculate (const SPFRoot& spfRoot, SPFRootState* state)
+{
+  Ipv4Address root = spfRoot.routerId;
+  NS_LOG_FUNCTION (this << root << state);
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// The status of the LSAs in this calculation is kept apart from the LSDB,
+// which is shared by the calculations of other roots.
 //
-  m_lsdb->Initialize ();
+  m_spfstatus.clear ();
+  m_spfipv4 = spfRoot.ipv4;
+  m_spfrouting = spfRoot.routing;
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1366,9 +1869,39 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
+  m_spfstate = state;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
+  if (m_spfstate)
+    {
+      m_spfstate->stub = false;
+      m_spfstate->hasUplink = false;
+      m_spfstate->vertices.clear ();
+      SPFVertexState &rootState = m_spfstate->vertices[root];
+      rootState.distance = 0;
+      rootState.direct = false;
+//
+// Remember the neighbor which CheckForStubNode () may use as a default
+// gateway, since its LSA then matters as much as the LSA of the root.
+//
+      uint32_t transits = 0;
+      GlobalRoutingLinkRecord *transitLink = 0;
+      for (uint32_t i = 0; i < v->GetLSA ()->GetNLinkRecords (); i++)
+        {
+          GlobalRoutingLinkRecord *l = v->GetLSA ()->GetLinkRecord (i);
+          if (l->GetLinkType () != GlobalRoutingLinkRecord::StubNetwork)
+            {
+              transits++;
+              transitLink = l;
+            }
+        }
+      if (transits == 1 && transitLink->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          m_spfstate->hasUplink = true;
+          m_spfstate->uplink = transitLink->GetLinkId ();
+        }
+    }
 
 //
 // Optimize SPF calculation, for ns-3.
@@ -1377,10 +1910,18 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrouting && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      if (m_spfstate)
+        {
+          m_spfstate->stub = true;
+        }
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfstate = 0;
+      m_spfipv4 = 0;
+      m_spfrouting = 0;
       return;
     }
 
@@ -1428,7 +1969,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      SetLSAStatus (v->GetLSA (), GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1437,6 +1978,16 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // to now.
 //
       SPFVertexAddParent (v);
+      if (m_spfstate)
+        {
+          SPFVertexState &vertexState = m_spfstate->vertices[v->GetVertexId ()];
+          vertexState.distance = v->GetDistanceFromRoot ();
+          vertexState.direct = false;
+          for (uint32_t i = 0; v->GetParent (i) != 0; i++)
+            {
+              vertexState.direct = vertexState.direct || v->GetParent (i) == m_spfroot;
+            }
+        }
 //
 // Note that when there is a choice of vertices closest to the root, network
 // vertices must be chosen before router vertices in order to necessarily
@@ -1502,6 +2053,9 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfstate = 0;
+  m_spfipv4 = 0;
+  m_spfrouting = 0;
 }
 
 void
@@ -1560,105 +2114,43 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node of the root of the SPF tree was found before the calculation
+// started; this is the one we're going to write the routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFAddASExternal (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
+          m_spfrouting->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1720,116 +2212,54 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
   NS_LOG_LOGIC ("Stub is on remote host: " << v->GetVertexId () << "; installing");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its node was found
+// before the calculation started; if there is no such node, there is
+// nothing to do.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddStub (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
+//
+// Here's why we did all of that work.  We're going to add a network route
+// to the stub network found in the link record, using the exit directions
+// precalculated for us in the vertex <v> to which the stub network is
+// attached: the next hop addresses to which the root node should send
+// packets for this network, and the outbound interfaces to use.
+//
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
         {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
+          m_spfrouting->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
+      else
         {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
-//
-// Get the Global Router Link State Advertisement from the vertex we're
-// adding the routes to.  The LSA will have a number of attached Global Router
-// Link Records corresponding to links off of that vertex / node.  We're going
-// to be interested in the records corresponding to point-to-point links.
-//
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
-//
-// Here's why we did all of that work.  We're going to add a host route to the
-// host address found in the m_linkData field of the point-to-point link
-// record.  In the case of a point-to-point link, this is the local IP address
-// of the node connected to the link.  Each of these point-to-point links
-// will correspond to a local interface that has an IP address to which
-// the node at the root of the SPF tree can send packets.  The vertex <v> 
-// (corresponding to the node that has these links and interfaces) has 
-// an m_nextHop address precalculated for us that is the address to which the
-// root node should send packets to be forwarded to these IP addresses.
-// Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
-// which the packets should be send for forwarding.
-//
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1844,70 +2274,30 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 {
   NS_LOG_FUNCTION (this << a << amask);
 //
-// We have an IP address <a> and a vertex ID of the root of the SPF tree.
-// The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// We have an IP address <a> and the Ipv4 interface of the node at the root
+// of the SPF tree, found before the calculation started.  The question is
+// what interface index this address corresponds to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfipv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
-//
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << m_spfroot->GetVertexId ());
+      return -1;
+    }
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = m_spfipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1935,69 +2325,30 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddRouter (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its node was found
+// before the calculation started; if there is no such node, there is
+// nothing to do.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  uint32_t nLinkRecords = lsa->GetNLinkRecords ();
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
@@ -2006,18 +2357,18 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // the local side of the point-to-point links found on the node described by
 // the vertex <v>.
 //
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+  NS_LOG_LOGIC (" Router " << routerId <<
+                " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = 0; j < nLinkRecords; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,44 +2382,31 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              m_spfrouting->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                            outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
 void
@@ -2080,104 +2418,56 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
                  "GlobalRouteManagerImpl::SPFIntraAddTransit (): Root pointer not set");
 //
 // The root of the Shortest Path First tree is the router to which we are 
-// going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// going to write the actual routing table entries.  Its node was found
+// before the calculation started; if there is no such node, there is
+// nothing to do.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  if (m_spfrouting == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No node for router " << routerId);
+      return;
+    }
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          m_spfrouting->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Router " << routerId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
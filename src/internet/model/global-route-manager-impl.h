@@ -27,6 +27,7 @@
 #include <queue>
 #include <map>
 #include <vector>
+#include <ostream>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
@@ -37,6 +38,7 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -641,6 +643,14 @@ public:
  */
   GlobalRoutingLSA* GetLSAByLinkData (Ipv4Address addr) const;
 
+/**
+ * @brief Get all the Link State Advertisements of the database, except the
+ * External Link State Advertisements.
+ *
+ * @param [out] lsas The Link State Advertisements, by increasing link state ID.
+ */
+  void GetLSAs (std::vector<GlobalRoutingLSA*> &lsas) const;
+
 /**
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
@@ -680,6 +690,7 @@ private:
   typedef std::pair<Ipv4Address, GlobalRoutingLSA*> LSDBPair_t; //!< pair of IPv4 addresses / Link State Advertisements
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
+  LSDBMap_t m_linkDataIndex; //!< Link State Advertisements by the Link Data of their TransitNetwork link records
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
 /**
@@ -732,9 +743,33 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF calculations of the routers are shared among the number of
+ * threads given by the "GlobalRoutingThreads" global value.  The LSDB is
+ * only read while they run.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables, recomputing only what the changes of the database can affect.
+ *
+ * The result of the SPF calculation of each router is kept between calls.
+ * The routes are computed again only for the routers whose shortest paths
+ * may go through a link that changed, or which reach an LSA that changed;
+ * all the routes of these routers are replaced, in the order in which
+ * InitializeRoutes () adds them.  The first call, and the first call after InitializeRoutes () or
+ * DeleteGlobalRoutes (), recomputes the routes of all the routers.
+ */
+  virtual void UpdateRoutes ();
+
+/**
+ * @brief Print the time spent by the last calls to
+ * BuildGlobalRoutingDatabase () and InitializeRoutes ().
+ * @param os the output stream
+ */
+  void PrintTimings (std::ostream &os) const;
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +801,152 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * \brief The result of the SPF calculation for a vertex, as needed to
+   * know whether a change of the links can change it.
+   */
+  struct SPFVertexState
+  {
+    uint32_t distance; //!< the distance from the root
+    bool direct;       //!< whether the root is one of the parents of the vertex
+  };
+
+  /**
+   * \brief The result of the SPF calculation of a router, kept by
+   * UpdateRoutes () between calls.
+   */
+  struct SPFRootState
+  {
+    bool stub;            //!< whether the router is a stub node, see CheckForStubNode ()
+    bool hasUplink;       //!< whether the router has a single point-to-point transit link
+    Ipv4Address uplink;   //!< the router at the other end of this link
+    std::map<Ipv4Address, SPFVertexState> vertices; //!< the vertices reached from the router
+  };
+
+  /**
+   * \brief The node of a router, as needed to add its routes.
+   */
+  struct SPFRoot
+  {
+    Ipv4Address routerId;          //!< the router ID
+    Ptr<Ipv4> ipv4;                //!< the Ipv4 of the node, or null if there is no such node
+    Ptr<Ipv4GlobalRouting> routing; //!< the routing protocol of the node, or null
+  };
+
+  /**
+   * \brief A link between two vertices of the SPF graph.
+   */
+  struct SPFEdge
+  {
+    Ipv4Address from;     //!< the vertex advertising the link
+    Ipv4Address to;       //!< the vertex at the other end of the link
+    uint32_t metric;      //!< the cost of the link
+    Ipv4Address linkData; //!< the Link Data of the link record
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  SPFRootState* m_spfstate; //!< where SPFCalculate () stores its result, if not null
+  Ptr<Ipv4> m_spfipv4; //!< the Ipv4 of the root node
+  Ptr<Ipv4GlobalRouting> m_spfrouting; //!< the routing protocol of the root node
+  std::map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus> m_spfstatus; //!< the LSAs explored by the SPF calculation
+  std::vector<SPFRoot> m_spfroots; //!< the routers whose routes SPFCalculateRoots () computes
+  int64_t m_lsdbTime; //!< the duration of the last BuildGlobalRoutingDatabase (), in milliseconds
+  int64_t m_spfTime; //!< the duration of the last InitializeRoutes (), in milliseconds
+  uint32_t m_spfRouters; //!< the number of routers of the last InitializeRoutes ()
+  uint32_t m_spfThreads; //!< the number of threads of the last InitializeRoutes ()
+  std::map<Ipv4Address, SPFRootState> m_spfstates; //!< the result of the SPF calculation of each router, by router ID
+
+  /**
+   * \brief Delete all the routes of a router.
+   * \param gr the routing protocol of the router
+   */
+  void DeleteRoutes (Ptr<Ipv4GlobalRouting> gr);
+
+  /**
+   * \brief Calculate the shortest path first (SPF) tree and store its result.
+   *
+   * Only the routes of the root node are changed, so that the calculations
+   * of different roots can run concurrently, each on its own
+   * GlobalRouteManagerImpl.
+   *
+   * \param root the root node
+   * \param state where to store the result of the calculation
+   */
+  void SPFCalculate (const SPFRoot& root, SPFRootState* state);
+
+  /**
+   * \brief Find the node of a router.
+   * \param routerId the router ID
+   * \returns the node of the router
+   */
+  static SPFRoot FindSPFRoot (Ipv4Address routerId);
+
+  /**
+   * \brief Calculate the shortest path first (SPF) trees of the routers of
+   * m_spfroots, and add their routes.
+   */
+  void SPFCalculateRoots ();
+
+  /**
+   * \brief Get the status of an LSA in the current SPF calculation.
+   * \param lsa the LSA
+   * \returns the status of the LSA
+   */
+  GlobalRoutingLSA::SPFStatus GetLSAStatus (const GlobalRoutingLSA* lsa) const;
+
+  /**
+   * \brief Set the status of an LSA in the current SPF calculation.
+   * \param lsa the LSA
+   * \param status the status of the LSA
+   */
+  void SetLSAStatus (const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
+
+  /**
+   * \brief Test if a change of the links of the SPF graph can change the
+   * result of the SPF calculation of a router.
+   *
+   * \param root the router ID
+   * \param state the result of the last SPF calculation of the router
+   * \param removed the links removed from the graph
+   * \param added the links added to the graph
+   * \returns true if the SPF calculation must be run again
+   */
+  static bool SPFIsAffected (Ipv4Address root, const SPFRootState& state,
+                             const std::vector<SPFEdge>& removed,
+                             const std::vector<SPFEdge>& added);
+
+  /**
+   * \brief Get the links of the SPF graph of a database.
+   *
+   * \param lsdb the database
+   * \param [out] edges the links, sorted
+   */
+  static void GetSPFEdges (const GlobalRouteManagerLSDB* lsdb, std::vector<SPFEdge>& edges);
+
+  /**
+   * \brief Compare two links of the SPF graph.
+   * \param a the first link
+   * \param b the second link
+   * \returns true if a is ordered before b
+   */
+  static bool CompareSPFEdge (const SPFEdge& a, const SPFEdge& b);
+
+  /**
+   * \brief Compare two External LSAs by their advertising router and destination.
+   * \param a the first LSA
+   * \param b the second LSA
+   * \returns true if a is ordered before b
+   */
+  static bool CompareASExternal (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b);
+
+  /**
+   * \brief Test if two LSAs have the same content.
+   * \param a the first LSA
+   * \param b the second LSA
+   * \returns true if the LSAs are equal
+   */
+  static bool IsSameLSA (const GlobalRoutingLSA* a, const GlobalRoutingLSA* b);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -58,6 +58,22 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::UpdateRoutes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  UpdateRoutes ();
+}
+
+void
+GlobalRouteManager::PrintTimings (std::ostream &os)
+{
+  NS_LOG_FUNCTION (&os);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  PrintTimings (os);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
@@ -22,6 +22,8 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include <ostream>
+
 namespace ns3 {
 
 /**
@@ -65,6 +67,21 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Rebuild the routing database and update the per-node forwarding
+ * tables, recomputing only the routers that the changes of the database
+ * can affect.
+ */
+  static void UpdateRoutes ();
+
+/**
+ * @brief Print the time spent building the routing database and
+ * computing the routes, in the last calls to BuildGlobalRoutingDatabase ()
+ * and InitializeRoutes ().
+ * @param os the output stream
+ */
+  static void PrintTimings (std::ostream &os);
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -29,7 +29,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
-  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
+  : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152), m_sequence (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -37,37 +37,134 @@ Ipv4EndPointDemux::Ipv4EndPointDemux ()
 Ipv4EndPointDemux::~Ipv4EndPointDemux ()
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  EndPointMap endPoints;
+  endPoints.swap (m_endPoints);
+  m_localPorts.clear ();
+  m_unconnected.clear ();
+  m_connections.clear ();
+  for (EndPointMap::iterator i = endPoints.begin (); i != endPoints.end (); i++) 
     {
-      Ipv4EndPoint *endPoint = *i;
+      Ipv4EndPoint *endPoint = i->second;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
-  m_endPoints.clear ();
 }
 
-bool
-Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+uint64_t
+Ipv4EndPointDemux::GetConnectionKey (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort)
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  return (static_cast<uint64_t> (localPort) << 48) | (static_cast<uint64_t> (peerAddress.Get ()) << 16) | peerPort;
+}
+
+void
+Ipv4EndPointDemux::AddEndPoint (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  endPoint->m_demuxSequence = m_sequence++;
+  m_endPoints[endPoint->m_demuxSequence] = endPoint;
+  AddIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void
+Ipv4EndPointDemux::AddIndex (Ipv4EndPoint *endPoint)
+{
+  uint64_t sequence = endPoint->m_demuxSequence;
+  uint16_t localPort = endPoint->GetLocalPort ();
+  m_localPorts[localPort][sequence] = endPoint;
+  if (endPoint->GetPeerAddress () == Ipv4Address::GetAny () || endPoint->GetPeerPort () == 0)
+    {
+      m_unconnected[localPort][sequence] = endPoint;
+    }
+  else
+    {
+      m_connections[GetConnectionKey (localPort, endPoint->GetPeerAddress (), endPoint->GetPeerPort ())][sequence] = endPoint;
+    }
+}
+
+void
+Ipv4EndPointDemux::RemoveIndex (Ipv4EndPoint *endPoint)
+{
+  uint64_t sequence = endPoint->m_demuxSequence;
+  uint16_t localPort = endPoint->GetLocalPort ();
+  std::unordered_map<uint16_t, EndPointMap>::iterator port = m_localPorts.find (localPort);
+  NS_ASSERT (port != m_localPorts.end ());
+  port->second.erase (sequence);
+  if (port->second.empty ())
+    {
+      m_localPorts.erase (port);
+    }
+  if (endPoint->GetPeerAddress () == Ipv4Address::GetAny () || endPoint->GetPeerPort () == 0)
     {
-      if ((*i)->GetLocalPort  () == port) 
+      std::unordered_map<uint16_t, EndPointMap>::iterator unconnected = m_unconnected.find (localPort);
+      NS_ASSERT (unconnected != m_unconnected.end ());
+      unconnected->second.erase (sequence);
+      if (unconnected->second.empty ())
         {
-          return true;
+          m_unconnected.erase (unconnected);
+        }
+    }
+  else
+    {
+      std::unordered_map<uint64_t, EndPointMap>::iterator connection =
+        m_connections.find (GetConnectionKey (localPort, endPoint->GetPeerAddress (), endPoint->GetPeerPort ()));
+      NS_ASSERT (connection != m_connections.end ());
+      connection->second.erase (sequence);
+      if (connection->second.empty ())
+        {
+          m_connections.erase (connection);
+        }
+    }
+}
+
+void
+Ipv4EndPointDemux::GetCandidates (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort,
+                                  std::vector<Ipv4EndPoint *> &candidates) const
+{
+  std::unordered_map<uint16_t, EndPointMap>::const_iterator unconnected = m_unconnected.find (localPort);
+  if (unconnected != m_unconnected.end ())
+    {
+      for (EndPointMap::const_iterator i = unconnected->second.begin (); i != unconnected->second.end (); i++)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  // The endpoints with a peer only match packets from their peer
+  if (peerAddress != Ipv4Address::GetAny () && peerPort != 0)
+    {
+      std::unordered_map<uint64_t, EndPointMap>::const_iterator connection =
+        m_connections.find (GetConnectionKey (localPort, peerAddress, peerPort));
+      if (connection != m_connections.end ())
+        {
+          for (EndPointMap::const_iterator i = connection->second.begin (); i != connection->second.end (); i++)
+            {
+              candidates.push_back (i->second);
+            }
         }
     }
-  return false;
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, EndPointMap>::iterator endPoints = m_localPorts.find (port);
+  if (endPoints == m_localPorts.end ())
+    {
+      return false;
+    }
+  for (EndPointMap::iterator i = endPoints->second.begin (); i != endPoints->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
+      if (i->second->GetLocalAddress () == addr &&
+          i->second->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
         }
@@ -86,8 +183,7 @@ Ipv4EndPointDemux::Allocate (void)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
@@ -102,8 +198,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
@@ -125,8 +220,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
       return 0;
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
@@ -136,7 +230,9 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::vector<Ipv4EndPoint *> candidates;
+  GetCandidates (localPort, peerAddress, peerPort, candidates);
+  for (std::vector<Ipv4EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -150,10 +246,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
@@ -161,15 +254,14 @@ void
 Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this << endPoint);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  if (endPoint->m_demux != this)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  RemoveIndex (endPoint);
+  m_endPoints.erase (endPoint->m_demuxSequence);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -181,9 +273,9 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   NS_LOG_FUNCTION (this);
   EndPoints ret;
 
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  for (EndPointMap::iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
     {
-      Ipv4EndPoint* endP = *i;
+      Ipv4EndPoint* endP = i->second;
       ret.push_back (endP);
     }
   return ret;
@@ -208,7 +300,9 @@ Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport,
   EndPoints retval4; // Exact match on all 4
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::vector<Ipv4EndPoint *> candidates;
+  GetCandidates (dport, saddr, sport, candidates);
+  for (std::vector<Ipv4EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
       Ipv4EndPoint* endP = *i;
 
@@ -345,14 +439,10 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
 
   // this code is a copy/paste version of an old BSD ip stack lookup
   // function.
-  uint32_t genericity = 3;
-  Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::vector<Ipv4EndPoint *> candidates;
+  GetCandidates (dport, saddr, sport, candidates);
+  for (std::vector<Ipv4EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
       if ((*i)->GetLocalAddress () == daddr &&
           (*i)->GetPeerPort () == sport &&
           (*i)->GetPeerAddress () == saddr) 
@@ -360,18 +450,28 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
           /* this is an exact match. */
           return *i;
         }
+    }
+  std::unordered_map<uint16_t, EndPointMap>::iterator endPoints = m_localPorts.find (dport);
+  if (endPoints == m_localPorts.end ())
+    {
+      return 0;
+    }
+  uint32_t genericity = 3;
+  Ipv4EndPoint *generic = 0;
+  for (EndPointMap::iterator i = endPoints->second.begin (); i != endPoints->second.end (); i++) 
+    {
       uint32_t tmp = 0;
-      if ((*i)->GetLocalAddress () == Ipv4Address::GetAny ()) 
+      if (i->second->GetLocalAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
-      if ((*i)->GetPeerAddress () == Ipv4Address::GetAny ()) 
+      if (i->second->GetPeerAddress () == Ipv4Address::GetAny ()) 
         {
           tmp++;
         }
       if (tmp < genericity) 
         {
-          generic = (*i);
+          generic = i->second;
           genericity = tmp;
         }
     }
@@ -23,6 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +43,12 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed by local port, and those with a peer address
+ * and port by their local port and peer, so that a lookup only looks at
+ * the endpoints without a peer on the destination port, and at the
+ * endpoints connected to the source of the packet.  The endpoints tell
+ * their demux when their peer changes.
  */
 
 class Ipv4EndPointDemux {
@@ -166,6 +175,51 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /**
+   * \brief Container of IPv4 endpoints, by allocation order.
+   */
+  typedef std::map<uint64_t, Ipv4EndPoint *> EndPointMap;
+
+  /**
+   * \brief Add a new endpoint to the demux.
+   * \param endPoint the endpoint
+   */
+  void AddEndPoint (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Index an endpoint by its local port and peer.
+   * \param endPoint the endpoint
+   */
+  void AddIndex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the indexes.
+   * \param endPoint the endpoint
+   */
+  void RemoveIndex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Get the endpoints which may match a packet: the endpoints of
+   * the local port without a peer, and the endpoints of the local port
+   * connected to the peer.
+   * \param localPort the local port
+   * \param peerAddress the peer address
+   * \param peerPort the peer port
+   * \param [out] candidates the endpoints
+   */
+  void GetCandidates (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort,
+                      std::vector<Ipv4EndPoint *> &candidates) const;
+
+  /**
+   * \brief Get the key of the connections between a local port and a peer.
+   * \param localPort the local port
+   * \param peerAddress the peer address
+   * \param peerPort the peer port
+   * \returns the key
+   */
+  static uint64_t GetConnectionKey (uint16_t localPort, Ipv4Address peerAddress, uint16_t peerPort);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -189,9 +243,29 @@ private:
   uint16_t m_portFirst;
 
   /**
-   * \brief A list of IPv4 end points.
+   * \brief The IPv4 end points.
+   */
+  EndPointMap m_endPoints;
+
+  /**
+   * \brief The allocation order of the next end point.
+   */
+  uint64_t m_sequence;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPointMap> m_localPorts;
+
+  /**
+   * \brief The end points without a peer address or port, by local port.
+   */
+  std::unordered_map<uint16_t, EndPointMap> m_unconnected;
+
+  /**
+   * \brief The end points with a peer address and port, by connection key.
    */
-  EndPoints m_endPoints;
+  std::unordered_map<uint64_t, EndPointMap> m_connections;
 };
 
 } // namespace ns3
@@ -32,6 +32,7 @@ namespace ns3 {
 
 class Header;
 class Packet;
+class Ipv4EndPointDemux;
 
 /**
  * \ingroup ipv4
@@ -227,6 +228,19 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  friend class Ipv4EndPointDemux;
+
+  /**
+   * \brief The demux which allocated the endpoint, and indexes it by local
+   * port and peer (if any).
+   */
+  Ipv4EndPointDemux *m_demux;
+
+  /**
+   * \brief The allocation order of the endpoint in its demux.
+   */
+  uint64_t m_demuxSequence;
 };
 
 } // namespace ns3
@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <iomanip>
+#include <algorithm>
 #include "ns3/names.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
@@ -80,6 +81,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_hostTrie.Insert (route->GetDest (), 32, route);
 }
 
 void 
@@ -90,6 +92,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_hostTrie.Insert (route->GetDest (), 32, route);
 }
 
 void 
@@ -105,6 +108,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkTrie.Insert (route->GetDestNetwork (), networkMask.GetPrefixLength (), route);
 }
 
 void 
@@ -118,6 +122,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_networkTrie.Insert (route->GetDestNetwork (), networkMask.GetPrefixLength (), route);
 }
 
 void 
@@ -133,6 +138,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_ASexternalTrie.Insert (route->GetDestNetwork (), networkMask.GetPrefixLength (), route);
 }
 
 
@@ -146,73 +152,93 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
   typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
   RouteVec_t allRoutes;
 
+  // The routes are found from the tries, then taken in the order of
+  // their routing table.
+  typedef std::vector<const std::vector<Ipv4RoutingTrie::Entry> *> Matches_t;
+  Matches_t matches;
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin (); 
-       i != m_hostRoutes.end (); 
-       i++) 
+  m_hostTrie.Lookup (dest, matches);
+  for (Matches_t::const_iterator m = matches.begin (); m != matches.end (); m++)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest)) 
+      for (std::vector<Ipv4RoutingTrie::Entry>::const_iterator i = (*m)->begin ();
+           i != (*m)->end ();
+           i++)
         {
+          NS_ASSERT (i->route->IsHost ());
           if (oif != 0)
             {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+              if (oif != m_ipv4->GetNetDevice (i->route->GetInterface ()))
                 {
                   NS_LOG_LOGIC ("Not on requested interface, skipping");
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          allRoutes.push_back (i->route);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << i->route);
         }
     }
   if (allRoutes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
-           j != m_networkRoutes.end (); 
-           j++) 
+      std::vector<std::pair<uint64_t, Ipv4RoutingTableEntry*> > found;
+      matches.clear ();
+      m_networkTrie.Lookup (dest, matches);
+      for (Matches_t::const_iterator m = matches.begin (); m != matches.end (); m++)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry)) 
+          for (std::vector<Ipv4RoutingTrie::Entry>::const_iterator j = (*m)->begin ();
+               j != (*m)->end ();
+               j++)
             {
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice (j->route->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              found.push_back (std::make_pair (j->sequence, j->route));
             }
         }
+      std::sort (found.begin (), found.end ());
+      for (uint32_t j = 0; j < found.size (); j++)
+        {
+          allRoutes.push_back (found[j].second);
+          NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << found[j].second);
+        }
     }
   if (allRoutes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      const Ipv4RoutingTrie::Entry *first = 0;
+      matches.clear ();
+      m_ASexternalTrie.Lookup (dest, matches);
+      for (Matches_t::const_iterator m = matches.begin (); m != matches.end (); m++)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
+          for (std::vector<Ipv4RoutingTrie::Entry>::const_iterator k = (*m)->begin ();
+               k != (*m)->end ();
+               k++)
             {
-              NS_LOG_LOGIC ("Found external route" << *k);
+              if (first != 0 && first->sequence < k->sequence)
+                {
+                  break;
+                }
               if (oif != 0)
                 {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
+                  if (oif != m_ipv4->GetNetDevice (k->route->GetInterface ()))
                     {
                       NS_LOG_LOGIC ("Not on requested interface, skipping");
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              first = &(*k);
               break;
             }
         }
+      if (first != 0)
+        {
+          NS_LOG_LOGIC ("Found external route" << first->route);
+          allRoutes.push_back (first->route);
+        }
     }
   if (allRoutes.size () > 0 ) // if route(s) is found
     {
@@ -319,6 +345,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              m_hostTrie.Remove ((*i)->GetDest (), 32, *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +363,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          m_networkTrie.Remove ((*j)->GetDestNetwork (), (*j)->GetDestNetworkMask ().GetPrefixLength (), *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +380,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          m_ASexternalTrie.Remove ((*k)->GetDestNetwork (), (*k)->GetDestNetworkMask ().GetPrefixLength (), *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +421,9 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostTrie.Clear ();
+  m_networkTrie.Clear ();
+  m_ASexternalTrie.Clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -27,6 +27,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-trie.h"
 #include "ns3/random-variable-stream.h"
 
 namespace ns3 {
@@ -271,6 +272,9 @@ private:
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  Ipv4RoutingTrie m_hostTrie;          //!< m_hostRoutes, indexed by destination
+  Ipv4RoutingTrie m_networkTrie;       //!< m_networkRoutes, indexed by destination prefix
+  Ipv4RoutingTrie m_ASexternalTrie;    //!< m_ASexternalRoutes, indexed by destination prefix
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
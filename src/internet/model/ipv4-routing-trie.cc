@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ipv4-routing-trie.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RoutingTrie");
+
+namespace {
+
+/**
+ * \param address An address.
+ * \param length A prefix length.
+ * \returns The address with the bits beyond the prefix cleared.
+ */
+uint32_t
+MaskPrefix (uint32_t address, uint8_t length)
+{
+  return length == 0 ? 0 : address & (0xffffffff << (32 - length));
+}
+
+/**
+ * \param address An address.
+ * \param index A bit index, 0 being the most significant bit.
+ * \returns The bit of the address.
+ */
+uint32_t
+GetBit (uint32_t address, uint8_t index)
+{
+  return (address >> (31 - index)) & 1;
+}
+
+/**
+ * \param a An address.
+ * \param b Another address.
+ * \param length The maximum length.
+ * \returns The length of the common prefix of the two addresses, up to \p length.
+ */
+uint8_t
+GetCommonLength (uint32_t a, uint32_t b, uint8_t length)
+{
+  uint32_t diff = a ^ b;
+  uint8_t common = 0;
+  while (common < length && (diff & 0x80000000) == 0)
+    {
+      diff <<= 1;
+      common++;
+    }
+  return common;
+}
+
+} // unnamed namespace
+
+Ipv4RoutingTrie::Ipv4RoutingTrie ()
+  : m_root (0),
+    m_sequence (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4RoutingTrie::~Ipv4RoutingTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNodes (m_root);
+}
+
+Ipv4RoutingTrie::Node *
+Ipv4RoutingTrie::NewNode (uint32_t prefix, uint8_t length)
+{
+  Node *node = new Node;
+  node->prefix = MaskPrefix (prefix, length);
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+void
+Ipv4RoutingTrie::DeleteNodes (Node *node)
+{
+  if (node != 0)
+    {
+      DeleteNodes (node->child[0]);
+      DeleteNodes (node->child[1]);
+      delete node;
+    }
+}
+
+void
+Ipv4RoutingTrie::Insert (Ipv4Address network, uint8_t prefixLength, Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << network << (uint32_t)prefixLength << route << metric);
+  NS_ASSERT (prefixLength <= 32);
+  uint32_t key = MaskPrefix (network.Get (), prefixLength);
+  Node **link = &m_root;
+  Node *node = 0;
+  while (node == 0)
+    {
+      Node *current = *link;
+      if (current == 0)
+        {
+          node = NewNode (key, prefixLength);
+          *link = node;
+          break;
+        }
+      uint8_t common = GetCommonLength (current->prefix, key, std::min (current->length, prefixLength));
+      if (common == current->length)
+        {
+          if (common == prefixLength)
+            {
+              node = current;
+            }
+          else
+            {
+              link = &current->child[GetBit (key, current->length)];
+            }
+        }
+      else if (common == prefixLength)
+        {
+          // The new prefix is a prefix of the current node
+          node = NewNode (key, prefixLength);
+          node->child[GetBit (current->prefix, prefixLength)] = current;
+          *link = node;
+        }
+      else
+        {
+          // The prefixes diverge after their common part
+          Node *fork = NewNode (key, common);
+          node = NewNode (key, prefixLength);
+          fork->child[GetBit (current->prefix, common)] = current;
+          fork->child[GetBit (key, common)] = node;
+          *link = fork;
+        }
+    }
+  Entry entry;
+  entry.route = route;
+  entry.metric = metric;
+  entry.sequence = m_sequence++;
+  node->entries.push_back (entry);
+}
+
+void
+Ipv4RoutingTrie::Remove (Ipv4Address network, uint8_t prefixLength, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << network << (uint32_t)prefixLength << route);
+  uint32_t key = MaskPrefix (network.Get (), prefixLength);
+  Node **parentLink = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < prefixLength
+         && MaskPrefix (key, (*link)->length) == (*link)->prefix)
+    {
+      parentLink = link;
+      link = &(*link)->child[GetBit (key, (*link)->length)];
+    }
+  Node *node = *link;
+  if (node == 0 || node->length != prefixLength || node->prefix != key)
+    {
+      NS_ASSERT_MSG (false, "Ipv4RoutingTrie::Remove(): prefix not found");
+      return;
+    }
+  std::vector<Entry>::iterator i = node->entries.begin ();
+  while (i != node->entries.end () && i->route != route)
+    {
+      i++;
+    }
+  if (i == node->entries.end ())
+    {
+      NS_ASSERT_MSG (false, "Ipv4RoutingTrie::Remove(): route not found");
+      return;
+    }
+  node->entries.erase (i);
+  if (!node->entries.empty () || (node->child[0] != 0 && node->child[1] != 0))
+    {
+      return;
+    }
+  // Remove the node, and its parent if it is then a useless fork
+  *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+  delete node;
+  if (parentLink != 0 && *link == 0)
+    {
+      Node *parent = *parentLink;
+      if (parent->entries.empty ())
+        {
+          *parentLink = parent->child[0] != 0 ? parent->child[0] : parent->child[1];
+          delete parent;
+        }
+    }
+}
+
+void
+Ipv4RoutingTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNodes (m_root);
+  m_root = 0;
+}
+
+void
+Ipv4RoutingTrie::Lookup (Ipv4Address dest, std::vector<const std::vector<Entry> *> &matches) const
+{
+  uint32_t address = dest.Get ();
+  const Node *node = m_root;
+  while (node != 0 && MaskPrefix (address, node->length) == node->prefix)
+    {
+      if (!node->entries.empty ())
+        {
+          matches.push_back (&node->entries);
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[GetBit (address, node->length)];
+    }
+}
+
+} // namespace ns3
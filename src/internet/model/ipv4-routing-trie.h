@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef IPV4_ROUTING_TRIE_H
+#define IPV4_ROUTING_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Index of routing table entries by destination prefix
+ *
+ * A path-compressed binary trie of the destination prefixes of routing
+ * table entries, used by Ipv4StaticRouting and Ipv4GlobalRouting to find
+ * the routes matching a destination without visiting all the routes.
+ * Lookup() returns the routes of all the prefixes matching an address,
+ * from the shortest to the longest prefix; the routes of a prefix are
+ * kept in insertion order, and carry an insertion sequence number so
+ * that the callers can restore the order of their routing tables.
+ *
+ * The trie does not own the routing table entries.
+ */
+class Ipv4RoutingTrie
+{
+public:
+  /** A routing table entry stored in the trie. */
+  struct Entry
+  {
+    Ipv4RoutingTableEntry *route; //!< The routing table entry.
+    uint32_t metric;              //!< The metric of the route.
+    uint64_t sequence;            //!< The insertion order of the route.
+  };
+
+  Ipv4RoutingTrie ();
+  ~Ipv4RoutingTrie ();
+
+  /**
+   * \brief Add a route.
+   * \param network The destination network; bits beyond the prefix are ignored.
+   * \param prefixLength The length of the destination prefix, up to 32.
+   * \param route The routing table entry.
+   * \param metric The metric of the route.
+   */
+  void Insert (Ipv4Address network, uint8_t prefixLength, Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+  /**
+   * \brief Remove a route.
+   * \param network The destination network, as given to Insert.
+   * \param prefixLength The length of the destination prefix, as given to Insert.
+   * \param route The routing table entry.
+   */
+  void Remove (Ipv4Address network, uint8_t prefixLength, Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+  /**
+   * \brief Find the routes whose destination prefix matches an address.
+   * \param dest The destination address.
+   * \param [out] matches The routes of each matching prefix, from the
+   * shortest to the longest prefix.  Prefixes without routes are skipped.
+   */
+  void Lookup (Ipv4Address dest, std::vector<const std::vector<Entry> *> &matches) const;
+
+private:
+  /**
+   * \brief Copy constructor.
+   *
+   * Declared but not implemented, since the trie owns its nodes
+   */
+  Ipv4RoutingTrie (const Ipv4RoutingTrie &);
+  /**
+   * \brief Copy assignment operator.
+   *
+   * Declared but not implemented, since the trie owns its nodes
+   * \returns the copied trie
+   */
+  Ipv4RoutingTrie &operator = (const Ipv4RoutingTrie &);
+
+  /** A node of the trie: a prefix, its routes and its two subtries. */
+  struct Node
+  {
+    uint32_t prefix;              //!< The prefix, with its trailing bits cleared.
+    uint8_t length;               //!< The prefix length.
+    Node *child[2];               //!< The longer prefixes, by their next bit.
+    std::vector<Entry> entries;   //!< The routes of this prefix.
+  };
+
+  /**
+   * \brief Create a node.
+   * \param prefix The prefix.
+   * \param length The prefix length.
+   * \returns The new node, without routes nor children.
+   */
+  static Node * NewNode (uint32_t prefix, uint8_t length);
+  /**
+   * \brief Delete a subtrie.
+   * \param node The root of the subtrie.
+   */
+  static void DeleteNodes (Node *node);
+
+  Node *m_root;             //!< The root of the trie.
+  uint64_t m_sequence;      //!< The next insertion sequence number.
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTING_TRIE_H */
@@ -72,7 +72,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         nextHop,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  InsertNetworkRoute (route, metric);
 }
 
 void 
@@ -86,7 +86,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         interface);
-  m_networkRoutes.push_back (make_pair (route,metric));
+  InsertNetworkRoute (route, metric);
 }
 
 void 
@@ -143,7 +143,26 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
   *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (network,
                                                         networkMask,
                                                         outputInterface);
-  m_networkRoutes.push_back (make_pair (route,0));
+  InsertNetworkRoute (route, 0);
+}
+
+void
+Ipv4StaticRouting::InsertNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  m_networkRoutes.push_back (make_pair (route, metric));
+  m_networkTrie.Insert (route->GetDestNetwork (), route->GetDestNetworkMask ().GetPrefixLength (),
+                        route, metric);
+}
+
+Ipv4StaticRouting::NetworkRoutesI
+Ipv4StaticRouting::EraseNetworkRoute (NetworkRoutesI it)
+{
+  NS_LOG_FUNCTION (this << it->first);
+  m_networkTrie.Remove (it->first->GetDestNetwork (), it->first->GetDestNetworkMask ().GetPrefixLength (),
+                        it->first);
+  delete it->first;
+  return m_networkRoutes.erase (it);
 }
 
 uint32_t 
@@ -224,8 +243,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -240,18 +257,24 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // Try the matching prefixes from the longest one: among the routes of
+  // a prefix, the last one with the smallest metric is chosen, except
+  // for host routes where the first one is chosen.
+  std::vector<const std::vector<Ipv4RoutingTrie::Entry> *> matches;
+  m_networkTrie.Lookup (dest, matches);
+  for (std::vector<const std::vector<Ipv4RoutingTrie::Entry> *>::reverse_iterator i = matches.rbegin ();
+       i != matches.rend () && rtentry == 0;
+       i++)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      uint32_t shortest_metric = 0xffffffff;
+      Ipv4RoutingTableEntry *route = 0;
+      for (std::vector<Ipv4RoutingTrie::Entry>::const_iterator k = (*i)->begin ();
+           k != (*i)->end ();
+           k++)
         {
+          Ipv4RoutingTableEntry *j = k->route;
+          uint32_t metric = k->metric;
+          uint16_t masklen = j->GetDestNetworkMask ().GetPrefixLength ();
           NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
           if (oif != 0)
             {
@@ -261,33 +284,26 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
-              continue;
-            }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
           if (metric > shortest_metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
               continue;
             }
           shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
+          route = j;
+          if (masklen == 32)
+            {
+              break;
+            }
+        }
+      if (route != 0)
+        {
           uint32_t interfaceIdx = route->GetInterface ();
           rtentry = Create<Ipv4Route> ();
           rtentry->SetDestination (route->GetDest ());
           rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
           rtentry->SetGateway (route->GetGateway ());
           rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
-            {
-              break;
-            }
         }
     }
   if (rtentry != 0)
@@ -447,8 +463,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
-          delete j->first;
-          m_networkRoutes.erase (j);
+          EraseNetworkRoute (j);
           return;
         }
       tmp++;
@@ -575,6 +590,7 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkTrie.Clear ();
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,8 +629,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -660,8 +675,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
-          delete it->first;
-          it = m_networkRoutes.erase (it);
+          it = EraseNetworkRoute (it);
         }
       else
         {
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4-routing-trie.h"
 
 namespace ns3 {
 
@@ -413,11 +414,30 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Add a route at the end of the forwarding table for network.
+   * \param route the route
+   * \param metric metric of the route
+   */
+  void InsertNetworkRoute (Ipv4RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove and delete a route of the forwarding table for network.
+   * \param it iterator to the route
+   * \return iterator to the next route
+   */
+  NetworkRoutesI EraseNetworkRoute (NetworkRoutesI it);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the routes of m_networkRoutes, indexed by destination prefix.
+   */
+  Ipv4RoutingTrie m_networkTrie;
+
   /**
    * \brief the forwarding table for multicast.
    */
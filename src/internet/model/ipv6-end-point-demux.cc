@@ -29,7 +29,8 @@ NS_LOG_COMPONENT_DEFINE ("Ipv6EndPointDemux");
 Ipv6EndPointDemux::Ipv6EndPointDemux ()
   : m_ephemeral (49152),
     m_portFirst (49152),
-    m_portLast (65535)
+    m_portLast (65535),
+    m_sequence (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -37,35 +38,133 @@ Ipv6EndPointDemux::Ipv6EndPointDemux ()
 Ipv6EndPointDemux::~Ipv6EndPointDemux ()
 {
   NS_LOG_FUNCTION_NOARGS ();
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  EndPointMap endPoints;
+  endPoints.swap (m_endPoints);
+  m_localPorts.clear ();
+  m_unconnected.clear ();
+  m_connections.clear ();
+  for (EndPointMap::iterator i = endPoints.begin (); i != endPoints.end (); i++)
     {
-      Ipv6EndPoint *endPoint = *i;
+      Ipv6EndPoint *endPoint = i->second;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
-  m_endPoints.clear ();
 }
 
-bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+bool Ipv6EndPointDemux::ConnectionKey::operator == (const ConnectionKey &other) const
 {
-  NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  return localPort == other.localPort && peerPort == other.peerPort && peerAddress == other.peerAddress;
+}
+
+size_t Ipv6EndPointDemux::ConnectionKeyHash::operator () (const ConnectionKey &key) const
+{
+  return Ipv6AddressHash () (key.peerAddress) ^ ((static_cast<size_t> (key.localPort) << 16) | key.peerPort);
+}
+
+void Ipv6EndPointDemux::AddEndPoint (Ipv6EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  endPoint->m_demuxSequence = m_sequence++;
+  m_endPoints[endPoint->m_demuxSequence] = endPoint;
+  AddIndex (endPoint);
+  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+}
+
+void Ipv6EndPointDemux::AddIndex (Ipv6EndPoint *endPoint)
+{
+  uint64_t sequence = endPoint->m_demuxSequence;
+  uint16_t localPort = endPoint->GetLocalPort ();
+  m_localPorts[localPort][sequence] = endPoint;
+  if (endPoint->GetPeerAddress () == Ipv6Address::GetAny () || endPoint->GetPeerPort () == 0)
+    {
+      m_unconnected[localPort][sequence] = endPoint;
+    }
+  else
+    {
+      ConnectionKey key = { localPort, endPoint->GetPeerAddress (), endPoint->GetPeerPort () };
+      m_connections[key][sequence] = endPoint;
+    }
+}
+
+void Ipv6EndPointDemux::RemoveIndex (Ipv6EndPoint *endPoint)
+{
+  uint64_t sequence = endPoint->m_demuxSequence;
+  uint16_t localPort = endPoint->GetLocalPort ();
+  std::unordered_map<uint16_t, EndPointMap>::iterator port = m_localPorts.find (localPort);
+  NS_ASSERT (port != m_localPorts.end ());
+  port->second.erase (sequence);
+  if (port->second.empty ())
     {
-      if ((*i)->GetLocalPort  () == port)
+      m_localPorts.erase (port);
+    }
+  if (endPoint->GetPeerAddress () == Ipv6Address::GetAny () || endPoint->GetPeerPort () == 0)
+    {
+      std::unordered_map<uint16_t, EndPointMap>::iterator unconnected = m_unconnected.find (localPort);
+      NS_ASSERT (unconnected != m_unconnected.end ());
+      unconnected->second.erase (sequence);
+      if (unconnected->second.empty ())
         {
-          return true;
+          m_unconnected.erase (unconnected);
         }
     }
-  return false;
+  else
+    {
+      ConnectionKey key = { localPort, endPoint->GetPeerAddress (), endPoint->GetPeerPort () };
+      std::unordered_map<ConnectionKey, EndPointMap, ConnectionKeyHash>::iterator connection = m_connections.find (key);
+      NS_ASSERT (connection != m_connections.end ());
+      connection->second.erase (sequence);
+      if (connection->second.empty ())
+        {
+          m_connections.erase (connection);
+        }
+    }
+}
+
+void Ipv6EndPointDemux::GetCandidates (uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort,
+                                       std::vector<Ipv6EndPoint *> &candidates) const
+{
+  std::unordered_map<uint16_t, EndPointMap>::const_iterator unconnected = m_unconnected.find (localPort);
+  if (unconnected != m_unconnected.end ())
+    {
+      for (EndPointMap::const_iterator i = unconnected->second.begin (); i != unconnected->second.end (); i++)
+        {
+          candidates.push_back (i->second);
+        }
+    }
+  /* The end points with a peer only match packets from their peer */
+  if (peerAddress != Ipv6Address::GetAny () && peerPort != 0)
+    {
+      ConnectionKey key = { localPort, peerAddress, peerPort };
+      std::unordered_map<ConnectionKey, EndPointMap, ConnectionKeyHash>::const_iterator connection = m_connections.find (key);
+      if (connection != m_connections.end ())
+        {
+          for (EndPointMap::const_iterator i = connection->second.begin (); i != connection->second.end (); i++)
+            {
+              candidates.push_back (i->second);
+            }
+        }
+    }
+}
+
+bool Ipv6EndPointDemux::LookupPortLocal (uint16_t port)
+{
+  NS_LOG_FUNCTION (this << port);
+  return m_localPorts.find (port) != m_localPorts.end ();
 }
 
 bool Ipv6EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::unordered_map<uint16_t, EndPointMap>::iterator endPoints = m_localPorts.find (port);
+  if (endPoints == m_localPorts.end ())
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
-          (*i)->GetBoundNetDevice () == boundNetDevice)
+      return false;
+    }
+  for (EndPointMap::iterator i = endPoints->second.begin (); i != endPoints->second.end (); i++)
+    {
+      if (i->second->GetLocalAddress () == addr &&
+          i->second->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
         }
@@ -83,8 +182,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate ()
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (Ipv6Address::GetAny (), port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
@@ -98,8 +196,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ipv6Address address)
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
@@ -119,8 +216,7 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv6Ad
       return 0;
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (address, port);
-  m_endPoints.push_back (endPoint);
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
@@ -129,7 +225,9 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                                            Ipv6Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::vector<Ipv6EndPoint *> candidates;
+  GetCandidates (localPort, peerAddress, peerPort, candidates);
+  for (std::vector<Ipv6EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       if ((*i)->GetLocalPort () == localPort &&
           (*i)->GetLocalAddress () == localAddress &&
@@ -143,25 +241,21 @@ Ipv6EndPoint* Ipv6EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
     }
   Ipv6EndPoint *endPoint = new Ipv6EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
-  m_endPoints.push_back (endPoint);
-
-  NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
-
+  AddEndPoint (endPoint);
   return endPoint;
 }
 
 void Ipv6EndPointDemux::DeAllocate (Ipv6EndPoint *endPoint)
 {
   NS_LOG_FUNCTION (this);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  if (endPoint->m_demux != this)
     {
-      if (*i == endPoint)
-        {
-          delete endPoint;
-          m_endPoints.erase (i);
-          break;
-        }
+      return;
     }
+  RemoveIndex (endPoint);
+  m_endPoints.erase (endPoint->m_demuxSequence);
+  endPoint->m_demux = 0;
+  delete endPoint;
 }
 
 /*
@@ -181,7 +275,9 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
   EndPoints retval4; /* Exact match on all 4 */
 
   NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::vector<Ipv6EndPoint *> candidates;
+  GetCandidates (dport, saddr, sport, candidates);
+  for (std::vector<Ipv6EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++)
     {
       Ipv6EndPoint* endP = *i;
 
@@ -290,38 +386,43 @@ Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::Lookup (Ipv6Address daddr, uint1
 
 Ipv6EndPoint* Ipv6EndPointDemux::SimpleLookup (Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
-  uint32_t genericity = 3;
-  Ipv6EndPoint *generic = 0;
-
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+  std::vector<Ipv6EndPoint *> candidates;
+  GetCandidates (dport, src, sport, candidates);
+  for (std::vector<Ipv6EndPoint *>::iterator i = candidates.begin (); i != candidates.end (); i++)
     {
-      uint32_t tmp = 0;
-
-      if ((*i)->GetLocalPort () != dport)
-        {
-          continue;
-        }
-
       if ((*i)->GetLocalAddress () == dst && (*i)->GetPeerPort () == sport
           && (*i)->GetPeerAddress () == src)
         {
           /* this is an exact match. */
           return *i;
         }
+    }
 
-      if ((*i)->GetLocalAddress () == Ipv6Address::GetAny ())
+  std::unordered_map<uint16_t, EndPointMap>::iterator endPoints = m_localPorts.find (dport);
+  if (endPoints == m_localPorts.end ())
+    {
+      return 0;
+    }
+  uint32_t genericity = 3;
+  Ipv6EndPoint *generic = 0;
+
+  for (EndPointMap::iterator i = endPoints->second.begin (); i != endPoints->second.end (); i++)
+    {
+      uint32_t tmp = 0;
+
+      if (i->second->GetLocalAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
         }
 
-      if ((*i)->GetPeerAddress () == Ipv6Address::GetAny ())
+      if (i->second->GetPeerAddress () == Ipv6Address::GetAny ())
         {
           tmp++;
         }
 
       if (tmp < genericity)
         {
-          generic = (*i);
+          generic = i->second;
           genericity = tmp;
         }
     }
@@ -352,7 +453,12 @@ uint16_t Ipv6EndPointDemux::AllocateEphemeralPort ()
 
 Ipv6EndPointDemux::EndPoints Ipv6EndPointDemux::GetEndPoints () const
 {
-  return m_endPoints;
+  EndPoints endPoints;
+  for (EndPointMap::const_iterator i = m_endPoints.begin (); i != m_endPoints.end (); i++)
+    {
+      endPoints.push_back (i->second);
+    }
+  return endPoints;
 }
 
 } /* namespace ns3 */
@@ -23,6 +23,9 @@
 
 #include <stdint.h>
 #include <list>
+#include <map>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv6-address.h"
 #include "ipv6-interface.h"
 
@@ -34,6 +37,12 @@ class Ipv6EndPoint;
  * \ingroup ipv6
  *
  * \brief Demultiplexer for end points.
+ *
+ * The end points are indexed by local port, and those with a peer address
+ * and port by their local port and peer, so that a lookup only looks at
+ * the end points without a peer on the destination port, and at the end
+ * points connected to the source of the packet.  The end points tell
+ * their demux when their local port or peer changes.
  */
 class Ipv6EndPointDemux
 {
@@ -153,6 +162,73 @@ public:
   EndPoints GetEndPoints () const;
 
 private:
+  friend class Ipv6EndPoint;
+
+  /**
+   * \brief Container of IPv6 end points, by allocation order.
+   */
+  typedef std::map<uint64_t, Ipv6EndPoint *> EndPointMap;
+
+  /**
+   * \brief The local port and peer of connected end points.
+   */
+  struct ConnectionKey
+  {
+    uint16_t localPort;       //!< The local port.
+    Ipv6Address peerAddress;  //!< The peer address.
+    uint16_t peerPort;        //!< The peer port.
+
+    /**
+     * \brief Equality operator.
+     * \param other the other key
+     * \returns true if the keys are equal
+     */
+    bool operator == (const ConnectionKey &other) const;
+  };
+
+  /**
+   * \brief Hash function class for ConnectionKey.
+   */
+  struct ConnectionKeyHash
+  {
+    /**
+     * \brief Hash a connection key.
+     * \param key the key
+     * \returns the hash
+     */
+    size_t operator () (const ConnectionKey &key) const;
+  };
+
+  /**
+   * \brief Add a new end point to the demux.
+   * \param endPoint the end point
+   */
+  void AddEndPoint (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Index an end point by its local port and peer.
+   * \param endPoint the end point
+   */
+  void AddIndex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Remove an end point from the indexes.
+   * \param endPoint the end point
+   */
+  void RemoveIndex (Ipv6EndPoint *endPoint);
+
+  /**
+   * \brief Get the end points which may match a packet: the end points of
+   * the local port without a peer, and the end points of the local port
+   * connected to the peer.
+   * \param localPort the local port
+   * \param peerAddress the peer address
+   * \param peerPort the peer port
+   * \param [out] candidates the end points
+   */
+  void GetCandidates (uint16_t localPort, Ipv6Address peerAddress, uint16_t peerPort,
+                      std::vector<Ipv6EndPoint *> &candidates) const;
+
   /**
    * \brief Allocate a ephemeral port.
    * \return a port
@@ -175,9 +251,29 @@ private:
   uint16_t m_portLast;
 
   /**
-   * \brief A list of IPv6 end points.
+   * \brief The IPv6 end points.
+   */
+  EndPointMap m_endPoints;
+
+  /**
+   * \brief The allocation order of the next end point.
+   */
+  uint64_t m_sequence;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  std::unordered_map<uint16_t, EndPointMap> m_localPorts;
+
+  /**
+   * \brief The end points without a peer address or port, by local port.
+   */
+  std::unordered_map<uint16_t, EndPointMap> m_unconnected;
+
+  /**
+   * \brief The end points with a peer address and port, by local port and peer.
    */
-  EndPoints m_endPoints;
+  std::unordered_map<ConnectionKey, EndPointMap, ConnectionKeyHash> m_connections;
 };
 
 } /* namespace ns3 */
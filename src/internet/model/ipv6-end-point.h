@@ -34,6 +34,7 @@ namespace ns3
 
 class Header;
 class Packet;
+class Ipv6EndPointDemux;
 
 /**
  * \ingroup ipv6
@@ -236,6 +237,19 @@ private:
    * \brief true if the endpoint can receive packets.
    */
   bool m_rxEnabled;
+
+  friend class Ipv6EndPointDemux;
+
+  /**
+   * \brief The demux which allocated the endpoint, and indexes it by local
+   * port and peer (if any).
+   */
+  Ipv6EndPointDemux *m_demux;
+
+  /**
+   * \brief The allocation order of the endpoint in its demux.
+   */
+  uint64_t m_demuxSequence;
 };
 
 } /* namespace ns3 */
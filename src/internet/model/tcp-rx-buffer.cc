@@ -155,8 +155,14 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
       if (maxSeq < tailSeq) tailSeq = maxSeq;
       if (tailSeq < headSeq) headSeq = tailSeq;
     }
-  // Remove overlapped bytes from packet
-  BufIterator i = m_data.begin ();
+  // Remove overlapped bytes from packet. The stored packets do not
+  // overlap, so only the last one starting before headSeq can overlap
+  // the head of the incoming packet
+  BufIterator i = m_data.upper_bound (headSeq);
+  if (i != m_data.begin ())
+    {
+      --i;
+    }
   while (i != m_data.end () && i->first <= tailSeq)
     {
       SequenceNumber32 lastByteSeq = i->first + SequenceNumber32 (i->second->GetSize ());
@@ -205,13 +211,9 @@ TcpRxBuffer::Add (Ptr<Packet> p, TcpHeader const& tcph)
   NS_LOG_LOGIC ("Buffered packet of seqno=" << headSeq << " len=" << p->GetSize ());
   // Update variables
   m_size += p->GetSize ();      // Occupancy
-  for (i = m_data.begin (); i != m_data.end (); ++i)
+  for (i = m_data.lower_bound (m_nextRxSeq); i != m_data.end (); ++i)
     {
-      if (i->first < m_nextRxSeq)
-        {
-          continue;
-        }
-      else if (i->first > m_nextRxSeq)
+      if (i->first > m_nextRxSeq)
         {
           break;
         };
@@ -369,17 +371,18 @@ TcpRxBuffer::Extract (uint32_t maxSize)
   NS_LOG_LOGIC ("Requested to extract " << extractSize << " bytes from TcpRxBuffer of size=" << m_size);
   if (extractSize == 0) return nullptr;  // No contiguous block to return
   NS_ASSERT (m_data.size ()); // At least we have something to extract
-  Ptr<Packet> outPkt = Create<Packet> (); // The packet that contains all the data to return
+  Ptr<Packet> outPkt; // The packet that contains all the data to return
   BufIterator i;
   while (extractSize)
     { // Check the buffered data for delivery
       i = m_data.begin ();
       NS_ASSERT (i->first <= m_nextRxSeq); // in-sequence data expected
       // Check if we send the whole pkt or just a partial
+      Ptr<Packet> segment;
       uint32_t pktSize = i->second->GetSize ();
       if (pktSize <= extractSize)
         { // Whole packet is extracted
-          outPkt->AddAtEnd (i->second);
+          segment = i->second;
           m_data.erase (i);
           m_size -= pktSize;
           m_availBytes -= pktSize;
@@ -387,13 +390,25 @@ TcpRxBuffer::Extract (uint32_t maxSize)
         }
       else
         { // Partial is extracted and done
-          outPkt->AddAtEnd (i->second->CreateFragment (0, extractSize));
+          segment = i->second->CreateFragment (0, extractSize);
           m_data[i->first + SequenceNumber32 (extractSize)] = i->second->CreateFragment (extractSize, pktSize - extractSize);
           m_data.erase (i);
           m_size -= extractSize;
           m_availBytes -= extractSize;
           extractSize = 0;
         }
+      // The stored packets are fragments created by Add, referenced only
+      // by the buffer: the first segment becomes the returned packet, and
+      // the next ones are appended to it.
+      if (outPkt == nullptr)
+        {
+          outPkt = segment;
+          outPkt->RemoveAllPacketTags ();
+        }
+      else
+        {
+          outPkt->AddAtEnd (segment);
+        }
     }
   if (outPkt->GetSize () == 0)
     {
@@ -153,6 +153,9 @@ public:
    * Extract data from the head of the buffer as indicated by nextRxSeq.
    * The extracted data is going to be forwarded to the application.
    *
+   * The first buffered segment is handed out as the returned packet,
+   * without its packet tags; the following segments are appended to it.
+   *
    * \param maxSize maximum number of bytes to extract
    * \returns a packet
    */
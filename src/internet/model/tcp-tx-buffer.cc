@@ -294,7 +294,7 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  IndexItem (m_sentList, m_sentList.insert (m_sentList.end (), item));
   m_sentSize += item->m_packet->GetSize ();
 
   return item;
@@ -308,36 +308,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  auto index = m_sentIndex.find (seq);
+  if (index != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      auto it = index->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -345,8 +342,10 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
 
   if (! item->m_retrans)
     {
+      RemoveFromScoreboard (item);
       m_retrans += item->m_packet->GetSize ();
       item->m_retrans = true;
+      AddToScoreboard (item);
     }
 
   return item;
@@ -357,21 +356,13 @@ TcpTxBuffer::FindHighestSacked () const
 {
   NS_LOG_FUNCTION (this);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
-  auto ret = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
-
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (m_sackedSeqs.empty ())
     {
-      const TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          ret = std::make_pair (it, beginOfCurrentPacket);
-        }
-      beginOfCurrentPacket += item->m_packet->GetSize ();
+      return std::make_pair (m_sentList.end (), SequenceNumber32 (0));
     }
 
-  return ret;
+  SequenceNumber32 highest = *m_sackedSeqs.rbegin ();
+  return std::make_pair (PacketList::const_iterator (GetSentItem (highest)), highest);
 }
 
 
@@ -398,7 +389,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -435,11 +426,23 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+  if (&list == &m_sentList)
+    {
+      // Start from the sent item which contains seq
+      auto index = m_sentIndex.upper_bound (seq);
+      if (index != m_sentIndex.begin ())
+        {
+          --index;
+          it = index->second;
+          beginOfCurrentPacket = index->first;
+        }
+    }
+
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (&list != &m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -466,10 +469,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                            " and now we recurse because packet ends at "
                                         << beginOfCurrentPacket + currentPacket->GetSize ());
               TcpTxItem *firstPart = new TcpTxItem ();
+              UnindexItem (list, currentItem);
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              IndexItem (list, list.insert (it, firstPart));
+              IndexItem (list, it);
               if (listEdited)
                 {
                   *listEdited = true;
@@ -513,11 +518,15 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                   // current > outPacket in the list. Merge current with the
                   // previous, and recurse.
                   NS_ASSERT (it != list.begin ());
-                  TcpTxItem *previous = *(--it);
+                  PacketList::iterator previousIt = it;
+                  TcpTxItem *previous = *(--previousIt);
 
+                  UnindexItem (list, previous);
+                  UnindexItem (list, currentItem);
                   list.erase (it);
 
                   MergeItems (previous, currentItem);
+                  IndexItem (list, previousIt);
                   delete currentItem;
                   if (listEdited)
                     {
@@ -532,10 +541,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               // the end is inside the current packet, but it isn't exactly
               // the packet end. Just fragment, fix the list, and return.
               TcpTxItem *firstPart = new TcpTxItem ();
+              UnindexItem (list, currentItem);
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              IndexItem (list, list.insert (it, firstPart));
+              IndexItem (list, it);
               if (listEdited)
                 {
                   *listEdited = true;
@@ -563,8 +574,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
           TcpTxItem *next = (*it); // Please remember we have incremented it
                                    // in the previous if
 
+          UnindexItem (list, currentItem);
+          UnindexItem (list, next);
           MergeItems (currentItem, next);
-          list.erase (it);
+          IndexItem (list, --list.erase (it));
 
           delete next;
 
@@ -648,6 +661,85 @@ TcpTxBuffer::RemoveFromCounts (TcpTxItem *item, uint32_t size)
       m_lostOut -= size;
     }
 }
+
+void
+TcpTxBuffer::IndexItem (const PacketList &list, PacketList::iterator it)
+{
+  if (&list == &m_sentList)
+    {
+      NS_ASSERT (m_sentIndex.find ((*it)->m_startSeq) == m_sentIndex.end ());
+      m_sentIndex[(*it)->m_startSeq] = it;
+      AddToScoreboard (*it);
+    }
+}
+
+void
+TcpTxBuffer::UnindexItem (const PacketList &list, const TcpTxItem *item)
+{
+  if (&list == &m_sentList)
+    {
+      m_sentIndex.erase (item->m_startSeq);
+      RemoveFromScoreboard (item);
+    }
+}
+
+void
+TcpTxBuffer::AddToScoreboard (const TcpTxItem *item)
+{
+  SequenceNumber32 seq = item->m_startSeq;
+
+  if (item->m_sacked)
+    {
+      m_sackedSeqs.insert (seq);
+    }
+  else
+    {
+      m_unsackedSeqs.insert (seq);
+    }
+
+  if (item->m_sacked || item->m_lost)
+    {
+      m_leftOutSeqs.insert (seq);
+    }
+  else
+    {
+      m_inFlightSeqs.insert (seq);
+    }
+
+  if (!item->m_sacked && !item->m_retrans)
+    {
+      if (item->m_lost)
+        {
+          m_lostNotRetransSeqs.insert (seq);
+        }
+      else
+        {
+          m_inFlightNotRetransSeqs.insert (seq);
+        }
+    }
+}
+
+void
+TcpTxBuffer::RemoveFromScoreboard (const TcpTxItem *item)
+{
+  SequenceNumber32 seq = item->m_startSeq;
+
+  m_sackedSeqs.erase (seq);
+  m_unsackedSeqs.erase (seq);
+  m_inFlightSeqs.erase (seq);
+  m_leftOutSeqs.erase (seq);
+  m_lostNotRetransSeqs.erase (seq);
+  m_inFlightNotRetransSeqs.erase (seq);
+}
+
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::GetSentItem (const SequenceNumber32 &seq) const
+{
+  auto index = m_sentIndex.find (seq);
+  NS_ASSERT_MSG (index != m_sentIndex.end (), "No sent item starts at " << seq);
+  return index->second;
+}
+
 void
 TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 {
@@ -693,6 +785,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
           RemoveFromCounts (item, pktSize);
 
+          UnindexItem (m_sentList, item);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -703,9 +796,11 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
         { // Part of the packet is behind the seqnum. Fragment
           pktSize -= offset;
           NS_LOG_INFO (*item);
+          UnindexItem (m_sentList, item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
           item->m_startSeq += offset;
+          IndexItem (m_sentList, i);
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -733,7 +828,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           // It is not possible to have the UNA sacked; otherwise, it would
           // have been ACKed. This is, most likely, our wrong guessing
           // when adding Reno dupacks in the count.
+          RemoveFromScoreboard (head);
           head->m_sacked = false;
+          AddToScoreboard (head);
           m_sackedOut -= head->m_packet->GetSize ();
           NS_LOG_INFO ("Moving the SACK flag from the HEAD to another segment");
           AddRenoSack ();
@@ -768,17 +865,19 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
-      while (item_it != m_sentList.end ())
+      // Items starting before the block can not be mapped over it
+      auto index = m_sentIndex.lower_bound ((*option_it).first);
+
+      while (index != m_sentIndex.end ())
         {
+          PacketList::iterator item_it = index->second;
+          SequenceNumber32 beginOfCurrentPacket = index->first;
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
 
           // Check the boundary of this packet ... only mark as sacked if
@@ -798,6 +897,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
                 }
               else
                 {
+                  RemoveFromScoreboard (*item_it);
                   if ((*item_it)->m_lost)
                     {
                       (*item_it)->m_lost = false;
@@ -806,6 +906,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
                   (*item_it)->m_sacked = true;
                   m_sackedOut += (*item_it)->m_packet->GetSize ();
+                  AddToScoreboard (*item_it);
 
                   if (m_highestSack.first == m_sentList.end()
                       || m_highestSack.second <= beginOfCurrentPacket + pktSize)
@@ -829,8 +930,7 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
-          ++item_it;
+          ++index;
         }
     }
 
@@ -852,46 +952,52 @@ void
 TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_highestSack.first != m_sentList.end ());
+  NS_LOG_INFO ("Status before the update: " << *this <<
+               ", will start from item " << *(*m_highestSack.first));
+
+  // Walk back the sacked items, from the highest one, until m_dupAckThresh
+  // of them are found. The head is never counted.
+  SequenceNumber32 head = m_sentList.front ()->m_startSeq;
+  SequenceNumber32 threshold = m_highestSack.second;
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
-  if (m_highestSack.first == m_sentList.end ())
+  auto sackedIt = m_sackedSeqs.upper_bound (m_highestSack.second);
+  while (sacked < m_dupAckThresh && sackedIt != m_sackedSeqs.begin ())
     {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from the latest sent item");
+      --sackedIt;
+      if (*sackedIt == head)
+        {
+          break;
+        }
+      threshold = *sackedIt;
+      sacked++;
     }
-  else
+
+  if (sacked < m_dupAckThresh)
     {
-      NS_LOG_INFO ("Status before the update: " << *this <<
-                   ", will start from item " << *(*m_highestSack.first));
+      NS_LOG_INFO ("Only " << sacked << " sacked items, nothing is lost");
+      return;
     }
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  // Every item below the threshold which is neither sacked nor lost is lost
+  auto inFlightIt = m_inFlightSeqs.begin ();
+  while (inFlightIt != m_inFlightSeqs.end () && *inFlightIt < threshold)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
-        {
-          sacked++;
-        }
-
-      if (sacked >= m_dupAckThresh)
-        {
-          if (!item->m_sacked && !item->m_lost)
-            {
-              item->m_lost = true;
-              m_lostOut += item->m_packet->GetSize ();
-            }
-        }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
+      TcpTxItem *item = *GetSentItem (*inFlightIt);
+      ++inFlightIt;
+      RemoveFromScoreboard (item);
+      item->m_lost = true;
+      m_lostOut += item->m_packet->GetSize ();
+      AddToScoreboard (item);
     }
 
-  if (sacked >= m_dupAckThresh)
+  TcpTxItem *item = m_sentList.front ();
+  if (!item->m_lost)
     {
-      TcpTxItem *item = *m_sentList.begin ();
-      if (!item->m_lost)
-        {
-          item->m_lost = true;
-          m_lostOut += item->m_packet->GetSize ();
-        }
+      RemoveFromScoreboard (item);
+      item->m_lost = true;
+      m_lostOut += item->m_packet->GetSize ();
+      AddToScoreboard (item);
     }
   NS_LOG_INFO ("Status after the update: " << *this);
   ConsistencyCheck ();
@@ -902,37 +1008,25 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // The first sacked or lost item starting at or after seq decides
+  auto it = m_leftOutSeqs.lower_bound (seq);
+  if (it == m_leftOutSeqs.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
-
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
-        }
+      return false;
+    }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+  if ((*GetSentItem (*it))->m_lost)
+    {
+      NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+      return true;
     }
 
+  NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
   return false;
 }
 
@@ -954,35 +1048,12 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *
    *     (1.c) IsLost (S2) returns true.
    */
-  PacketList::const_iterator it;
-  TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Condition 1.a , 1.b , and 1.c
+  if (!m_lostNotRetransSeqs.empty ())
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
-        {
-          if (item->m_lost)
-            {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
-            }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
-            {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
-            }
-        }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      NS_LOG_INFO("IsLost, returning" << *m_lostNotRetransSeqs.begin ());
+      *seq = *m_lostNotRetransSeqs.begin ();
+      return true;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,10 +1079,10 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery && !m_inFlightNotRetransSeqs.empty ())
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
+      NS_LOG_INFO ("Rule3 valid. " << *m_inFlightNotRetransSeqs.begin ());
+      *seq = *m_inFlightNotRetransSeqs.begin ();
       return true;
     }
 
@@ -1180,9 +1251,13 @@ TcpTxBuffer::ResetRenoSack ()
   NS_LOG_FUNCTION (this);
 
   m_sackedOut = 0;
-  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  SequenceSet sacked = m_sackedSeqs;
+  for (auto it = sacked.begin (); it != sacked.end (); ++it)
     {
-      (*it)->m_sacked = false;
+      TcpTxItem *item = *GetSentItem (*it);
+      RemoveFromScoreboard (item);
+      item->m_sacked = false;
+      AddToScoreboard (item);
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
@@ -1203,6 +1278,13 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
+  m_sackedSeqs.clear ();
+  m_unsackedSeqs.clear ();
+  m_inFlightSeqs.clear ();
+  m_leftOutSeqs.clear ();
+  m_lostNotRetransSeqs.clear ();
+  m_inFlightNotRetransSeqs.clear ();
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
@@ -1218,6 +1300,7 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      UnindexItem (m_sentList, item);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
       if (item->m_retrans)
@@ -1248,6 +1331,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
 
   for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
     {
+      RemoveFromScoreboard (*it);
       if (resetSack)
         {
           (*it)->m_sacked = false;
@@ -1269,6 +1353,7 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
         }
 
       (*it)->m_retrans = false;
+      AddToScoreboard (*it);
     }
 
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
@@ -1301,8 +1386,10 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
 
   if (m_sentList.front ()->m_retrans)
     {
+      RemoveFromScoreboard (m_sentList.front ());
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      AddToScoreboard (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1312,6 +1399,7 @@ TcpTxBuffer::MarkHeadAsLost ()
 {
   if (m_sentList.size () > 0)
     {
+      RemoveFromScoreboard (m_sentList.front ());
       // If the head is sacked (reneging by the receiver the previously sent
       // information) we revert the sacked flag.
       // A sacked head means that we should advance SND.UNA.. so it's an error.
@@ -1332,6 +1420,7 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+      AddToScoreboard (m_sentList.front ());
     }
   ConsistencyCheck ();
 }
@@ -1344,19 +1433,17 @@ TcpTxBuffer::AddRenoSack (void)
 
   m_renoSack = true;
 
-  // We can _never_ SACK the head, so start from the second segment sent
-  auto it = ++m_sentList.begin ();
-
+  // We can _never_ SACK the head, so start from the second segment sent.
   // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
-  while (it != m_sentList.end () && (*it)->m_sacked)
-    {
-      ++it;
-    }
+  auto unsacked = m_unsackedSeqs.upper_bound (m_sentList.front ()->m_startSeq);
 
   // Add to the sacked size the size of the first "not sacked" segment
-  if (it != m_sentList.end ())
+  if (unsacked != m_unsackedSeqs.end ())
     {
+      PacketList::iterator it = GetSentItem (*unsacked);
+      RemoveFromScoreboard (*it);
       (*it)->m_sacked = true;
+      AddToScoreboard (*it);
       m_sackedOut += (*it)->m_packet->GetSize ();
       m_highestSack = std::make_pair (it, (*it)->m_startSeq);
       NS_LOG_INFO ("Added a Reno SACK, status: " << *this);
@@ -1406,6 +1493,25 @@ TcpTxBuffer::ConsistencyCheck () const
                  " stored lost: " << m_lostOut);
   NS_ASSERT_MSG (retrans == m_retrans, " Counted retrans: " << retrans <<
                  " stored retrans: " << m_retrans);
+
+  NS_ASSERT_MSG (m_sentIndex.size () == m_sentList.size (), "Indexed items: " <<
+                 m_sentIndex.size () << " sent items: " << m_sentList.size ());
+  NS_ASSERT (m_sackedSeqs.size () + m_unsackedSeqs.size () == m_sentList.size ());
+  NS_ASSERT (m_inFlightSeqs.size () + m_leftOutSeqs.size () == m_sentList.size ());
+
+  for (auto it = m_sentList.begin (); it != m_sentList.end (); ++it)
+    {
+      const TcpTxItem *item = *it;
+      auto index = m_sentIndex.find (item->m_startSeq);
+      NS_ASSERT_MSG (index != m_sentIndex.end () && index->second == it,
+                     "Item not indexed: " << *item);
+      NS_ASSERT (m_sackedSeqs.count (item->m_startSeq) == (item->m_sacked ? 1 : 0));
+      NS_ASSERT (m_leftOutSeqs.count (item->m_startSeq) == (item->m_sacked || item->m_lost ? 1 : 0));
+      NS_ASSERT (m_lostNotRetransSeqs.count (item->m_startSeq) ==
+                 (!item->m_sacked && item->m_lost && !item->m_retrans ? 1 : 0));
+      NS_ASSERT (m_inFlightNotRetransSeqs.count (item->m_startSeq) ==
+                 (!item->m_sacked && !item->m_lost && !item->m_retrans ? 1 : 0));
+    }
 }
 
 std::ostream &
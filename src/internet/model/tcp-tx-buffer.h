@@ -29,6 +29,9 @@
 #include "ns3/tcp-option-sack.h"
 #include "ns3/packet.h"
 
+#include <map>
+#include <set>
+
 namespace ns3 {
 class Packet;
 
@@ -102,8 +105,18 @@ public:
  * associated with every segment sent. This is done through the use of the
  * class TcpTxItem: instead of storing a list of packets, we store a list of
  * TcpTxItem. Each item has different flags (check the corresponding
- * documentation) and maintaining the scoreboard is a matter of travelling the
- * list and set the SACK flag on the corresponding segment sent.
+ * documentation) and maintaining the scoreboard is a matter of finding the
+ * segments sent covered by a SACK block and setting their SACK flag.
+ *
+ * To avoid walking the list of sent segments for each ACK, which is quadratic
+ * with large windows, the sent items are indexed by their starting sequence
+ * number, and the starting sequence numbers of the items are kept in ordered
+ * sets by state: sacked or not, in flight (neither sacked nor lost) or not,
+ * lost and not retransmitted, in flight and not retransmitted. The scoreboard
+ * queries (IsLost, NextSeg) and updates (Update, UpdateLostCount, AddRenoSack)
+ * are then logarithmic in the number of items, plus the number of items whose
+ * flags change. Every change to the flags of a sent item goes through
+ * RemoveFromScoreboard and AddToScoreboard.
  *
  * Item properties
  * ---------------
@@ -410,6 +423,7 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  typedef std::set<SequenceNumber32> SequenceSet; //!< starting sequence numbers of sent items
 
   /**
    * \brief Update the lost count
@@ -426,12 +440,51 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. It finds the dupAckThresh-th sacked item below
+   * the highest sacked one, and marks as lost the items in flight before it.
    *
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Add a sent item to the index and to the scoreboard sets
+   *
+   * Does nothing if the list is not the sent list.
+   *
+   * \param list the list of the item
+   * \param it the item
+   */
+  void IndexItem (const PacketList &list, PacketList::iterator it);
+
+  /**
+   * \brief Remove a sent item from the index and from the scoreboard sets
+   *
+   * Does nothing if the list is not the sent list.
+   *
+   * \param list the list of the item
+   * \param item the item
+   */
+  void UnindexItem (const PacketList &list, const TcpTxItem *item);
+
+  /**
+   * \brief Add a sent item to the scoreboard sets matching its flags
+   * \param item the item
+   */
+  void AddToScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Remove a sent item from the scoreboard sets
+   * \param item the item
+   */
+  void RemoveFromScoreboard (const TcpTxItem *item);
+
+  /**
+   * \brief Get the sent item starting at a sequence number
+   * \param seq the starting sequence number of the item, which must exist
+   * \return the item
+   */
+  PacketList::iterator GetSentItem (const SequenceNumber32 &seq) const;
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -560,7 +613,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -587,8 +640,8 @@ private:
   void SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const;
 
   /**
-   * \brief Check if the values of sacked, lost, retrans, are in sync
-   * with the sent list.
+   * \brief Check if the values of sacked, lost, retrans, and the scoreboard
+   * sets are in sync with the sent list.
    */
   void ConsistencyCheck () const;
 
@@ -608,6 +661,14 @@ private:
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+  std::map<SequenceNumber32, PacketList::iterator> m_sentIndex; //!< Sent items, by starting sequence
+  SequenceSet m_sackedSeqs;               //!< Sacked items
+  SequenceSet m_unsackedSeqs;             //!< Items not sacked
+  SequenceSet m_inFlightSeqs;             //!< Items neither sacked nor lost
+  SequenceSet m_leftOutSeqs;              //!< Items sacked or lost
+  SequenceSet m_lostNotRetransSeqs;       //!< Lost items not retransmitted (NextSeg rule 1)
+  SequenceSet m_inFlightNotRetransSeqs;   //!< Items in flight not retransmitted (NextSeg rule 3)
+
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-interface.h"
+#include "../model/ipv4-end-point-demux.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv6-end-point-demux.h"
+#include "../model/ipv6-end-point.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux test: a listening endpoint and many connected
+ * endpoints share a port, and the packets of each connection must find
+ * their endpoint while endpoints are connected and removed.
+ */
+class Ipv4EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv4EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Check the endpoint found for a packet.
+   * \param daddr the destination address
+   * \param dport the destination port
+   * \param saddr the source address
+   * \param sport the source port
+   * \param expected the expected endpoint, or 0 if none
+   */
+  void Check (Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport, Ipv4EndPoint *expected);
+
+  Ipv4EndPointDemux m_demux;            //!< The demux under test.
+  Ptr<Ipv4Interface> m_interface;       //!< The incoming interface.
+};
+
+Ipv4EndPointDemuxTestCase::Ipv4EndPointDemuxTestCase ()
+  : TestCase ("Ipv4EndPointDemux finds the endpoint of each connection")
+{
+}
+
+void
+Ipv4EndPointDemuxTestCase::Check (Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport, Ipv4EndPoint *expected)
+{
+  Ipv4EndPointDemux::EndPoints endPoints = m_demux.Lookup (daddr, dport, saddr, sport, m_interface);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), (expected != 0 ? 1 : 0),
+                         "Wrong number of endpoints for " << saddr << ":" << sport << " to " << daddr << ":" << dport);
+  if (expected != 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (endPoints.front (), expected,
+                             "Wrong endpoint for " << saddr << ":" << sport << " to " << daddr << ":" << dport);
+    }
+}
+
+void
+Ipv4EndPointDemuxTestCase::DoRun (void)
+{
+  m_interface = CreateObject<Ipv4Interface> ();
+  Ipv4Address local ("10.0.0.1");
+
+  Ipv4EndPoint *any = m_demux.Allocate (0, Ipv4Address::GetAny (), 80);
+  Ipv4EndPoint *listener = m_demux.Allocate (0, local, 80);
+  NS_TEST_ASSERT_MSG_NE (any, 0, "Cannot allocate the endpoint of any address");
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Cannot allocate the listening endpoint");
+  NS_TEST_ASSERT_MSG_EQ (m_demux.Allocate (0, local, 80), 0, "Duplicated listening endpoint");
+
+  std::vector<Ipv4EndPoint *> connections;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ipv4Address peer (0x0b000000 + i / 10);
+      Ipv4EndPoint *endPoint = m_demux.Allocate (0, local, 80, peer, 1000 + i % 10);
+      NS_TEST_ASSERT_MSG_NE (endPoint, 0, "Cannot allocate connection " << i);
+      connections.push_back (endPoint);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_demux.Allocate (0, local, 80, Ipv4Address (0x0b000000), 1000), 0, "Duplicated connection");
+  NS_TEST_ASSERT_MSG_EQ (m_demux.GetAllEndPoints ().size (), 1002, "Wrong number of endpoints");
+
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      Check (local, 80, Ipv4Address (0x0b000000 + i / 10), 1000 + i % 10, connections[i]);
+    }
+  Check (local, 80, Ipv4Address (0x0b000000), 999, listener);
+  Check (Ipv4Address ("10.0.0.2"), 80, Ipv4Address (0x0b000000), 1000, any);
+  Check (local, 81, Ipv4Address (0x0b000000), 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (m_demux.SimpleLookup (local, 80, Ipv4Address (0x0b000001), 1005), connections[15], "Wrong exact match");
+  NS_TEST_ASSERT_MSG_EQ (m_demux.SimpleLookup (local, 80, Ipv4Address (0x0b000001), 999), connections[0], "Wrong generic match");
+
+  // Connect an endpoint of an ephemeral port, then connect it elsewhere
+  Ipv4EndPoint *client = m_demux.Allocate ();
+  NS_TEST_ASSERT_MSG_NE (client, 0, "Cannot allocate an ephemeral port");
+  uint16_t port = client->GetLocalPort ();
+  NS_TEST_ASSERT_MSG_EQ (m_demux.LookupPortLocal (port), true, "Ephemeral port not in use");
+  client->SetPeer (Ipv4Address ("10.0.0.9"), 80);
+  Check (local, port, Ipv4Address ("10.0.0.9"), 80, client);
+  client->SetPeer (Ipv4Address ("10.0.0.8"), 80);
+  Check (local, port, Ipv4Address ("10.0.0.9"), 80, 0);
+  Check (local, port, Ipv4Address ("10.0.0.8"), 80, client);
+  m_demux.DeAllocate (client);
+  NS_TEST_ASSERT_MSG_EQ (m_demux.LookupPortLocal (port), false, "Ephemeral port still in use");
+
+  // Remove the even connections: their packets go to the listener
+  for (uint32_t i = 0; i < connections.size (); i += 2)
+    {
+      m_demux.DeAllocate (connections[i]);
+    }
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      Check (local, 80, Ipv4Address (0x0b000000 + i / 10), 1000 + i % 10, i % 2 == 0 ? listener : connections[i]);
+    }
+  NS_TEST_ASSERT_MSG_NE (m_demux.Allocate (0, local, 80, Ipv4Address (0x0b000000), 1000), 0, "Cannot allocate a removed connection again");
+
+  m_demux.DeAllocate (any);
+  m_demux.DeAllocate (listener);
+  Check (Ipv4Address ("10.0.0.2"), 80, Ipv4Address (0x0b000000), 999, 0);
+  m_interface = 0;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv6EndPointDemux test: a listening end point and many connected
+ * end points share a port, and the packets of each connection must find
+ * their end point while end points are connected, moved and removed.
+ */
+class Ipv6EndPointDemuxTestCase : public TestCase
+{
+public:
+  Ipv6EndPointDemuxTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Check the end point found for a packet.
+   * \param daddr the destination address
+   * \param dport the destination port
+   * \param saddr the source address
+   * \param sport the source port
+   * \param expected the expected end point, or 0 if none
+   */
+  void Check (Ipv6Address daddr, uint16_t dport, Ipv6Address saddr, uint16_t sport, Ipv6EndPoint *expected);
+  /**
+   * \param i an index
+   * \returns the address of the peer of connection i
+   */
+  static Ipv6Address GetPeer (uint32_t i);
+
+  Ipv6EndPointDemux m_demux;            //!< The demux under test.
+};
+
+Ipv6EndPointDemuxTestCase::Ipv6EndPointDemuxTestCase ()
+  : TestCase ("Ipv6EndPointDemux finds the end point of each connection")
+{
+}
+
+Ipv6Address
+Ipv6EndPointDemuxTestCase::GetPeer (uint32_t i)
+{
+  uint8_t buf[16] = { 0x20, 0x01, 0x0d, 0xb8 };
+  buf[14] = (i / 10) >> 8;
+  buf[15] = (i / 10) & 0xff;
+  return Ipv6Address (buf);
+}
+
+void
+Ipv6EndPointDemuxTestCase::Check (Ipv6Address daddr, uint16_t dport, Ipv6Address saddr, uint16_t sport, Ipv6EndPoint *expected)
+{
+  Ipv6EndPointDemux::EndPoints endPoints = m_demux.Lookup (daddr, dport, saddr, sport, 0);
+  NS_TEST_ASSERT_MSG_EQ (endPoints.size (), (expected != 0 ? 1 : 0),
+                         "Wrong number of end points for " << saddr << ":" << sport << " to " << daddr << ":" << dport);
+  if (expected != 0)
+    {
+      NS_TEST_ASSERT_MSG_EQ (endPoints.front (), expected,
+                             "Wrong end point for " << saddr << ":" << sport << " to " << daddr << ":" << dport);
+    }
+}
+
+void
+Ipv6EndPointDemuxTestCase::DoRun (void)
+{
+  Ipv6Address local ("2001:db8:1::1");
+
+  Ipv6EndPoint *listener = m_demux.Allocate (0, Ipv6Address::GetAny (), 80);
+  NS_TEST_ASSERT_MSG_NE (listener, 0, "Cannot allocate the listening end point");
+
+  std::vector<Ipv6EndPoint *> connections;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      Ipv6EndPoint *endPoint = m_demux.Allocate (0, local, 80, GetPeer (i), 1000 + i % 10);
+      NS_TEST_ASSERT_MSG_NE (endPoint, 0, "Cannot allocate connection " << i);
+      connections.push_back (endPoint);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_demux.Allocate (0, local, 80, GetPeer (0), 1000), 0, "Duplicated connection");
+  NS_TEST_ASSERT_MSG_EQ (m_demux.GetEndPoints ().size (), 1001, "Wrong number of end points");
+
+  for (uint32_t i = 0; i < connections.size (); i++)
+    {
+      Check (local, 80, GetPeer (i), 1000 + i % 10, connections[i]);
+    }
+  Check (local, 80, GetPeer (0), 999, listener);
+  Check (local, 81, GetPeer (0), 1000, 0);
+  NS_TEST_ASSERT_MSG_EQ (m_demux.SimpleLookup (local, 80, GetPeer (15), 1005), connections[15], "Wrong exact match");
+  NS_TEST_ASSERT_MSG_EQ (m_demux.SimpleLookup (local, 80, GetPeer (15), 999), connections[0], "Wrong generic match");
+
+  // Move a connection to another local port and peer
+  Ipv6EndPoint *moved = connections[1];
+  moved->SetLocalPort (8080);
+  Check (local, 80, GetPeer (1), 1001, listener);
+  moved->SetPeer (GetPeer (5000), 2000);
+  Check (local, 8080, GetPeer (5000), 2000, moved);
+  NS_TEST_ASSERT_MSG_EQ (m_demux.LookupPortLocal (8080), true, "Moved port not in use");
+  m_demux.DeAllocate (moved);
+  NS_TEST_ASSERT_MSG_EQ (m_demux.LookupPortLocal (8080), false, "Moved port still in use");
+
+  for (uint32_t i = 0; i < connections.size (); i += 2)
+    {
+      m_demux.DeAllocate (connections[i]);
+    }
+  for (uint32_t i = 3; i < connections.size (); i += 2)
+    {
+      Check (local, 80, GetPeer (i), 1000 + i % 10, connections[i]);
+      Check (local, 80, GetPeer (i - 1), 1000 + (i - 1) % 10, listener);
+    }
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief EndPointDemux TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  EndPointDemuxTestSuite ();
+};
+
+EndPointDemuxTestSuite::EndPointDemuxTestSuite ()
+  : TestSuite ("end-point-demux", UNIT)
+{
+  AddTestCase (new Ipv4EndPointDemuxTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv6EndPointDemuxTestCase, TestCase::QUICK);
+}
+
+static EndPointDemuxTestSuite endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -42,6 +42,10 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/bridge-helper.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/random-variable-stream.h"
+
+#include <sstream>
 
 using namespace ns3;
 
@@ -1244,6 +1248,234 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Create a 4x4 grid of point-to-point links, with a LAN across its
+ * diagonal, a stub node n16 attached to n12, and external routes injected
+ * by n3 and n16.
+ * \returns The nodes.
+ */
+static NodeContainer
+CreateGlobalRoutingGrid (void)
+{
+  NodeContainer nodes;
+  nodes.Create (17);
+
+  SimpleNetDeviceHelper p2pHelper;
+  p2pHelper.SetNetDevicePointToPointMode (true);
+  SimpleNetDeviceHelper lanHelper;
+
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t i = 0; i < 16; i++)
+    {
+      uint32_t neighbors[2] = { (i % 4 != 3) ? i + 1 : 16, (i < 12) ? i + 4 : 16 };
+      for (uint32_t k = 0; k < 2; k++)
+        {
+          if (neighbors[k] == 16)
+            {
+              continue;
+            }
+          NetDeviceContainer link = p2pHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (neighbors[k])));
+          ipv4.Assign (link);
+          ipv4.NewNetwork ();
+        }
+    }
+  NetDeviceContainer stubLink = p2pHelper.Install (NodeContainer (nodes.Get (12), nodes.Get (16)));
+  ipv4.Assign (stubLink);
+
+  NetDeviceContainer lan = lanHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (5),
+                                                             nodes.Get (10), nodes.Get (15)));
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  ipv4.Assign (lan);
+
+  nodes.Get (3)->GetObject<GlobalRouter> ()->InjectRoute (Ipv4Address ("192.168.0.0"), Ipv4Mask ("255.255.0.0"));
+  nodes.Get (16)->GetObject<GlobalRouter> ()->InjectRoute (Ipv4Address ("172.16.0.0"), Ipv4Mask ("255.255.0.0"));
+  return nodes;
+}
+
+/**
+ * \brief Get the global routes of nodes.
+ * \param nodes The nodes.
+ * \returns The routes of each node, in the order of their routing table.
+ */
+static std::vector<std::vector<std::string> >
+GetGlobalRoutes (const NodeContainer &nodes)
+{
+  std::vector<std::vector<std::string> > routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> globalRouting = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::string> nodeRoutes;
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          std::ostringstream oss;
+          oss << *globalRouting->GetRoute (j);
+          nodeRoutes.push_back (oss.str ());
+        }
+      routes.push_back (nodeRoutes);
+    }
+  return routes;
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting incremental update test: the routes updated
+ * by UpdateRoutingTables () must be the routes computed from scratch by
+ * RecomputeRoutingTables (), in the same order, while links go down and up
+ * and change cost.
+ */
+class Ipv4GlobalRoutingUpdateTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingUpdateTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingUpdateTestCase::Ipv4GlobalRoutingUpdateTestCase ()
+  : TestCase ("Incremental global routing updates match a full recomputation")
+{
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoSetup (void)
+{
+  m_nodes = CreateGlobalRoutingGrid ();
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  for (uint32_t round = 0; round < 40; round++)
+    {
+      // The first update after RecomputeRoutingTables () recomputes all the routes
+      Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+      for (uint32_t change = 0; change < 3; change++)
+        {
+          Ptr<Ipv4> ipv4 = m_nodes.Get (rand->GetInteger (0, m_nodes.GetN () - 1))->GetObject<Ipv4> ();
+          uint32_t interface = rand->GetInteger (1, ipv4->GetNInterfaces () - 1);
+          switch (rand->GetInteger (0, 2))
+            {
+            case 0:
+              if (ipv4->IsUp (interface))
+                {
+                  ipv4->SetDown (interface);
+                }
+              else
+                {
+                  ipv4->SetUp (interface);
+                }
+              break;
+            default:
+              ipv4->SetMetric (interface, rand->GetInteger (1, 3));
+              break;
+            }
+          Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+        }
+      std::vector<std::vector<std::string> > updated = GetGlobalRoutes (m_nodes);
+      Ipv4GlobalRoutingHelper::UpdateRoutingTables ();
+      NS_TEST_ASSERT_MSG_EQ ((GetGlobalRoutes (m_nodes) == updated), true, "Routes changed without topology change in round " << round);
+
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::vector<std::vector<std::string> > expected = GetGlobalRoutes (m_nodes);
+      for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (updated[i].size (), expected[i].size (),
+                                 "Wrong number of routes on node " << i << " in round " << round);
+          for (uint32_t j = 0; j < expected[i].size (); j++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (updated[i][j], expected[i][j],
+                                     "Wrong route on node " << i << " in round " << round);
+            }
+        }
+    }
+}
+
+void
+Ipv4GlobalRoutingUpdateTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting threads test: the routes computed by several
+ * threads must be the routes computed by a single thread, in the same order.
+ */
+class Ipv4GlobalRoutingThreadsTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingThreadsTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingThreadsTestCase::Ipv4GlobalRoutingThreadsTestCase ()
+  : TestCase ("Global routes computed by several threads match a single thread")
+{
+}
+
+void
+Ipv4GlobalRoutingThreadsTestCase::DoSetup (void)
+{
+  m_nodes = CreateGlobalRoutingGrid ();
+}
+
+void
+Ipv4GlobalRoutingThreadsTestCase::DoRun (void)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::vector<std::vector<std::string> > expected = GetGlobalRoutes (m_nodes);
+
+  for (uint32_t threads = 2; threads <= 5; threads++)
+    {
+      Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::vector<std::vector<std::string> > routes = GetGlobalRoutes (m_nodes);
+      for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (routes[i].size (), expected[i].size (),
+                                 "Wrong number of routes on node " << i << " with " << threads << " threads");
+          for (uint32_t j = 0; j < expected[i].size (); j++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (routes[i][j], expected[i][j],
+                                     "Wrong route " << j << " on node " << i << " with " << threads << " threads");
+            }
+        }
+    }
+}
+
+void
+Ipv4GlobalRoutingThreadsTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (0));
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1499,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingUpdateTestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingThreadsTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
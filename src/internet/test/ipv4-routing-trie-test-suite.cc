@@ -0,0 +1,165 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-routing-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/random-variable-stream.h"
+
+#include <list>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RoutingTrie test: the routes found by the trie must be the
+ * ones found by matching every route of the table, while routes are
+ * added and removed.
+ */
+class Ipv4RoutingTrieTestCase : public TestCase
+{
+public:
+  Ipv4RoutingTrieTestCase ();
+  virtual ~Ipv4RoutingTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Compare the routes found by the trie with the routes of the table.
+   * \param dest The destination address.
+   */
+  void Check (Ipv4Address dest);
+
+  Ipv4RoutingTrie m_trie;                         //!< The trie under test.
+  std::list<Ipv4RoutingTableEntry *> m_routes;    //!< The routes, in insertion order.
+};
+
+Ipv4RoutingTrieTestCase::Ipv4RoutingTrieTestCase ()
+  : TestCase ("Compare trie lookups with a linear search")
+{
+}
+
+Ipv4RoutingTrieTestCase::~Ipv4RoutingTrieTestCase ()
+{
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i++)
+    {
+      delete *i;
+    }
+}
+
+void
+Ipv4RoutingTrieTestCase::Check (Ipv4Address dest)
+{
+  std::vector<const std::vector<Ipv4RoutingTrie::Entry> *> matches;
+  m_trie.Lookup (dest, matches);
+  std::vector<Ipv4RoutingTableEntry *> found;
+  uint16_t lastLength = 0;
+  for (uint32_t m = 0; m < matches.size (); m++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (matches[m]->empty (), false, "Empty prefix returned for " << dest);
+      uint16_t length = (*matches[m])[0].route->GetDestNetworkMask ().GetPrefixLength ();
+      NS_TEST_ASSERT_MSG_EQ ((m == 0 || length > lastLength), true, "Prefixes not sorted for " << dest);
+      lastLength = length;
+      for (uint32_t i = 0; i < matches[m]->size (); i++)
+        {
+          found.push_back ((*matches[m])[i].route);
+        }
+    }
+  // The expected routes, by increasing prefix length, in insertion order
+  std::vector<Ipv4RoutingTableEntry *> byLength[33];
+  for (std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin (); i != m_routes.end (); i++)
+    {
+      Ipv4Mask mask = (*i)->GetDestNetworkMask ();
+      if (mask.IsMatch (dest, (*i)->GetDestNetwork ()))
+        {
+          byLength[mask.GetPrefixLength ()].push_back (*i);
+        }
+    }
+  std::vector<Ipv4RoutingTableEntry *> expected;
+  for (uint16_t length = 0; length <= 32; length++)
+    {
+      expected.insert (expected.end (), byLength[length].begin (), byLength[length].end ());
+    }
+  NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "Wrong number of routes for " << dest);
+  for (uint32_t i = 0; i < found.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (found[i], expected[i], "Wrong route " << i << " for " << dest);
+    }
+}
+
+void
+Ipv4RoutingTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> rand = CreateObject<UniformRandomVariable> ();
+  rand->SetStream (1);
+  // Draw the addresses from a few prefixes so that routes share prefixes
+  const uint32_t bases[] = { 0x0a000000, 0x0a010000, 0xc0a80000, 0x80000000 };
+
+  for (uint32_t step = 0; step < 1000; step++)
+    {
+      if (m_routes.empty () || rand->GetInteger (0, 2) != 0)
+        {
+          uint32_t address = bases[rand->GetInteger (0, 3)] | rand->GetInteger (0, 0xffff);
+          uint32_t length = rand->GetInteger (0, 32);
+          Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+          Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+          *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (Ipv4Address (address), mask, 1);
+          m_routes.push_back (route);
+          m_trie.Insert (route->GetDestNetwork (), length, route);
+        }
+      else
+        {
+          std::list<Ipv4RoutingTableEntry *>::iterator i = m_routes.begin ();
+          std::advance (i, rand->GetInteger (0, m_routes.size () - 1));
+          m_trie.Remove ((*i)->GetDestNetwork (), (*i)->GetDestNetworkMask ().GetPrefixLength (), *i);
+          delete *i;
+          m_routes.erase (i);
+        }
+      uint32_t dest = bases[rand->GetInteger (0, 3)] | rand->GetInteger (0, 0xffff);
+      Check (Ipv4Address (dest));
+      if (!m_routes.empty ())
+        {
+          Check (m_routes.back ()->GetDestNetwork ());
+        }
+    }
+
+  m_trie.Clear ();
+  std::vector<const std::vector<Ipv4RoutingTrie::Entry> *> matches;
+  m_trie.Lookup (Ipv4Address ("10.0.0.1"), matches);
+  NS_TEST_ASSERT_MSG_EQ (matches.size (), 0, "Routes left after Clear ()");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4RoutingTrie TestSuite
+ */
+class Ipv4RoutingTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RoutingTrieTestSuite ();
+};
+
+Ipv4RoutingTrieTestSuite::Ipv4RoutingTrieTestSuite ()
+  : TestSuite ("ipv4-routing-trie", UNIT)
+{
+  AddTestCase (new Ipv4RoutingTrieTestCase, TestCase::QUICK);
+}
+
+static Ipv4RoutingTrieTestSuite ipv4RoutingTrieTestSuite; //!< Static variable for test initialization
@@ -17,6 +17,7 @@
 
 #include "ns3/test.h"
 #include "ns3/packet.h"
+#include "ns3/socket.h"
 #include "ns3/log.h"
 
 #include "ns3/tcp-rx-buffer.h"
@@ -44,6 +45,10 @@ private:
    * \brief Test the SACK list update.
    */
   void TestUpdateSACKList ();
+  /**
+   * \brief Test the data extracted after an out-of-order reassembly.
+   */
+  void TestExtract ();
 };
 
 TcpRxBufferTestCase::TcpRxBufferTestCase ()
@@ -55,6 +60,7 @@ void
 TcpRxBufferTestCase::DoRun ()
 {
   TestUpdateSACKList ();
+  TestExtract ();
 }
 
 void
@@ -338,6 +344,67 @@ TcpRxBufferTestCase::TestUpdateSACKList ()
                          "SACK list should contain no element");
 }
 
+void
+TcpRxBufferTestCase::TestExtract ()
+{
+  TcpRxBuffer rxBuf;
+  TcpHeader h;
+  rxBuf.SetNextRxSequence (SequenceNumber32 (1));
+  rxBuf.SetMaxBufferSize (10000);
+
+  uint8_t data[1000];
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      data[i] = i % 251;
+    }
+
+  // Ten segments of 100 bytes, received in reverse order and tagged
+  std::vector<Ptr<Packet> > segments;
+  for (int32_t i = 9; i >= 0; --i)
+    {
+      Ptr<Packet> p = Create<Packet> (data + i * 100, 100);
+      SocketIpTtlTag tag;
+      tag.SetTtl (i);
+      p->AddPacketTag (tag);
+      segments.push_back (p);
+      h.SetSequenceNumber (SequenceNumber32 (1 + i * 100));
+      rxBuf.Add (p, h);
+      NS_TEST_ASSERT_MSG_EQ (rxBuf.Available (), (i == 0 ? 1000 : 0),
+                             "Data available before the hole is filled");
+    }
+  // A retransmission overlapping two stored segments is dropped
+  h.SetSequenceNumber (SequenceNumber32 (151));
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Add (Create<Packet> (100), h), false,
+                         "Duplicate data buffered");
+
+  // Extract chunks which do not match the segment boundaries
+  uint8_t out[1000];
+  uint32_t extracted = 0;
+  const uint32_t chunks[] = { 50, 250, 100, 600 };
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      Ptr<Packet> p = rxBuf.Extract (chunks[i]);
+      NS_TEST_ASSERT_MSG_EQ (p->GetSize (), chunks[i], "Wrong extracted size");
+      SocketIpTtlTag tag;
+      NS_TEST_ASSERT_MSG_EQ (p->PeekPacketTag (tag), false,
+                             "Packet tag of a segment left in the extracted data");
+      p->CopyData (out + extracted, chunks[i]);
+      extracted += chunks[i];
+    }
+  NS_TEST_ASSERT_MSG_EQ (rxBuf.Size (), 0, "Data left in the buffer");
+  NS_TEST_ASSERT_MSG_EQ ((rxBuf.Extract (100) == nullptr), true, "Data extracted from an empty buffer");
+  NS_TEST_ASSERT_MSG_EQ (memcmp (out, data, 1000), 0, "Extracted data differs");
+
+  // The received packets are left untouched
+  for (uint32_t i = 0; i < segments.size (); ++i)
+    {
+      SocketIpTtlTag tag;
+      NS_TEST_ASSERT_MSG_EQ (segments[i]->GetSize (), 100, "Received packet modified");
+      NS_TEST_ASSERT_MSG_EQ (segments[i]->PeekPacketTag (tag), true,
+                             "Packet tag removed from a received packet");
+    }
+}
+
 void
 TcpRxBufferTestCase::DoTeardown ()
 {
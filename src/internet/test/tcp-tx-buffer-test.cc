@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the scoreboard with a window of thousands of segments */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -267,6 +271,87 @@ TcpTxBufferTestCase::TestNextSeg ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 100;
+  uint32_t segments = 2000;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segmentSize * segments);
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Add (Create<Packet> (segmentSize * segments)), true,
+                         "Data not added to the buffer");
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Every other segment is received, one SACK block at a time
+  for (uint32_t i = 1; i < segments; i += 2)
+    {
+      SequenceNumber32 begin = head + (segmentSize * i);
+      sack->AddSackBlock (TcpOptionSack::SackBlock (begin, begin + segmentSize));
+      txBuf.Update (sack->GetSackList ());
+      sack->ClearSackList ();
+    }
+
+  // An even segment is lost when at least three sacked segments are after it
+  uint32_t lostSegments = segments / 2 - 2;
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * segments / 2,
+                         "Wrong count of sacked bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize * lostSegments,
+                         "Wrong count of lost bytes");
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      bool lost = (i % 2 == 0) && (i + 6 <= segments);
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * i)), lost,
+                             "Wrong lost state of segment " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), segmentSize * 2,
+                         "Wrong count of bytes in flight");
+
+  // The holes are retransmitted in order, then the segments not yet lost
+  for (uint32_t i = 0; i < lostSegments; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                             "No NextSeq with lost segments");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * 2 * i),
+                             "Different NextSeq than expected for hole " << i);
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetRetransmitsCount (), segmentSize * lostSegments,
+                         "Wrong count of retransmitted bytes");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                         "No NextSeq for rule 3");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * (segments - 4)),
+                         "Different NextSeq than expected for rule 3");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.BytesInFlight (), segmentSize * segments / 2,
+                         "Wrong count of bytes in flight after the retransmissions");
+
+  // Acknowledge the first half of the window
+  head = head + (segmentSize * segments / 2);
+  txBuf.DiscardUpTo (head);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * segments / 4,
+                         "Wrong count of sacked bytes after a cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize * (segments / 4 - 2),
+                         "Wrong count of lost bytes after a cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * 2)), true,
+                         "Lost segment not lost after a cumulative ACK");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + segmentSize), false,
+                         "Sacked segment lost after a cumulative ACK");
+
+  txBuf.DiscardUpTo (head + (segmentSize * segments / 2));
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0, "Data inside the buffer");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), 0, "Sacked bytes left");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), 0, "Lost bytes left");
+}
+
 void
 TcpTxBufferTestCase::TestNewBlock ()
 {
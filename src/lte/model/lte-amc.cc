@@ -379,12 +379,23 @@ LteAmc::CreateCqiFeedbacks (const SpectrumValue& sinr, uint8_t rbgSize)
         rbgMap.push_back (rbId++);
         if ((rbId % rbgSize == 0)||((it+1)==sinr.ConstValuesEnd ()))
          {
+            // evaluate the TBs of all the MCSs at once, which share the MI
+            // of the RBs of each modulation
+            std::vector<TbDecodificationParams_t> tbs (29);
+            for (uint8_t mcs = 0; mcs <= 28; mcs++)
+              {
+                tbs[mcs].map = &rbgMap;
+                tbs[mcs].size = (uint16_t)GetDlTbSizeFromMcs (mcs, rbgSize) / 8;
+                tbs[mcs].mcs = mcs;
+                tbs[mcs].miHistory = 0;
+              }
+            std::vector<TbStats_t> tbsStats;
+            LteMiErrorModel::GetTbDecodificationStats (sinr, tbs, tbsStats);
             uint8_t mcs = 0;
             TbStats_t tbStats;
             while (mcs <= 28)
               {
-                HarqProcessInfoList_t harqInfoList;
-                tbStats = LteMiErrorModel::GetTbDecodificationStats (sinr, rbgMap, (uint16_t)GetDlTbSizeFromMcs (mcs, rbgSize) / 8, mcs, harqInfoList);
+                tbStats = tbsStats[mcs];
                 if (tbStats.tbler > 0.1)
                   {
                     break;
@@ -152,6 +152,9 @@ private:
 
   Ptr<const SpectrumValue> m_noise; ///< the noise value
 
+  Ptr<SpectrumValue> m_interf; ///< preallocated interference plus noise of the current chunk
+  Ptr<SpectrumValue> m_sinr; ///< preallocated SINR of the current chunk
+
   Time m_lastChangeTime;     /**< the time of the last change in
                                 m_TotalPower */
 
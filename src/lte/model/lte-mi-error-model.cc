@@ -331,97 +331,145 @@ static const double cEcrTable [9][38] = {
 };
 
 
-double 
+/// MiMap structure
+struct MiMap
+{
+  const double *mi; ///< the MI values
+  const double *axis; ///< the uniformly spaced SINR values of the MI values
+  uint16_t size; ///< the number of values
+  double scalingCoeff; ///< the number of values per unit of SINR
+};
+
+/**
+ * \param mi the MI values
+ * \param axis the uniformly spaced SINR values of the MI values
+ * \param size the number of values
+ * \return the MI map
+ */
+static MiMap
+MakeMiMap (const double *mi, const double *axis, uint16_t size)
+{
+  // since the values in the axis are uniformly spaced, we have
+  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
+  // the scaling coefficient is always the same, so it is computed once
+  MiMap map = { mi, axis, size, (size - 1) / (axis[size - 1] - axis[0]) };
+  return map;
+}
+
+/// MI maps of QPSK, 16-QAM and 64-QAM
+static const MiMap MiMaps[3] = {
+  MakeMiMap (MI_map_qpsk, MI_map_qpsk_axis, MI_MAP_QPSK_SIZE),
+  MakeMiMap (MI_map_16qam, MI_map_16qam_axis, MI_MAP_16QAM_SIZE),
+  MakeMiMap (MI_map_64qam, MI_map_64qam_axis, MI_MAP_64QAM_SIZE)
+};
+
+/**
+ * \param mcs the MCS
+ * \return the index in MiMaps of the modulation of the MCS
+ */
+static inline uint8_t
+GetMiMapId (uint8_t mcs)
+{
+  if (mcs <= MI_QPSK_MAX_ID)
+    {
+      return 0;
+    }
+  if (mcs <= MI_16QAM_MAX_ID)
+    {
+      return 1;
+    }
+  return 2;
+}
+
+/**
+ * \param map the MI map of the modulation
+ * \param sinrLin the sinr of the RB
+ * \return the MI of the RB
+ */
+static inline double
+GetRbMi (const MiMap& map, double sinrLin)
+{
+  if (sinrLin > map.axis[map.size - 1])
+    {
+      return 1;
+    }
+  double sinrIndexDouble = (sinrLin - map.axis[0]) * map.scalingCoeff + 1;
+  uint32_t sinrIndex = std::max (0.0, std::floor (sinrIndexDouble));
+  NS_ASSERT_MSG (sinrIndex < map.size, "MI map out of data");
+  return map.mi[sinrIndex];
+}
+
+double
 LteMiErrorModel::Mib (const SpectrumValue& sinr, const std::vector<int>& map, uint8_t mcs)
 {
   NS_LOG_FUNCTION (sinr << &map << (uint32_t) mcs);
-  
+
   double MI;
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  
+  const MiMap& miMap = MiMaps[GetMiMapId (mcs)];
+
   for (uint32_t i = 0; i < map.size (); i++)
     {
-      double sinrLin = sinrCopy[map.at (i)];
-      if (mcs <= MI_QPSK_MAX_ID) // QPSK
-        {
+      double sinrLin = sinr[map[i]];
+      MI = GetRbMi (miMap, sinrLin);
+      NS_LOG_LOGIC (" RB " << map[i] << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
+      MIsum += MI;
+    }
+  MI = MIsum / map.size ();
+  NS_LOG_LOGIC (" MI = " << MI);
+  return MI;
+}
 
-          if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
-            {
-              MI = 1;
-            }
-          else 
-            { 
-              // since the values in MI_map_qpsk_axis are uniformly spaced, we have
-              // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-              // the scaling coefficient is always the same, so we use a static const
-              // to speed up the calculation
-              static const double scalingCoeffQpsk = 
-                (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-              double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
-              uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-              NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
-              MI = MI_map_qpsk[sinrIndex];
-            }
-        }
-      else
+
+/// BlerCurveParams structure
+struct BlerCurveParams
+{
+  double b[9][38]; ///< the b parameter of each CB size and ECR
+  double sqrt2c[9][38]; ///< sqrt(2) times the c parameter of each CB size and ECR
+};
+
+/**
+ * \return the parameters of the BLER curves, where the missing ones are
+ * taken from the lowest larger CB size
+ */
+static BlerCurveParams
+MakeBlerCurveParams ()
+{
+  BlerCurveParams params;
+  for (int cbIndex = 0; cbIndex < 9; cbIndex++)
+    {
+      for (int ecrId = 0; ecrId <= MI_64QAM_BLER_MAX_ID; ecrId++)
         {
-          if (mcs > MI_QPSK_MAX_ID && mcs <= MI_16QAM_MAX_ID )	// 16-QAM
+          //take the lowest CB size including this CB for removing CB size
+          //quatization errors
+          double b = bEcrTable[cbIndex][ecrId];
+          int i = cbIndex;
+          while ((i<9)&&(b<0))
             {
-              if (sinrLin > MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else 
-                {
-                  // since the values in MI_map_16QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff16qam = 
-                    (MI_MAP_16QAM_SIZE - 1) / (MI_map_16qam_axis[MI_MAP_16QAM_SIZE-1] - MI_map_16qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_16qam_axis[0]) * scalingCoeff16qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_16QAM_SIZE, "MI map out of data");
-                  MI = MI_map_16qam[sinrIndex];
-                }
+              b = bEcrTable[i++][ecrId];
             }
-          else // 64-QAM
+          double c = cEcrTable[cbIndex][ecrId];
+          i = cbIndex;
+          while ((i<9)&&(c<0))
             {
-              if (sinrLin > MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1])
-                {
-                  MI = 1;
-                }
-              else
-                {
-                  // since the values in MI_map_64QAM_axis are uniformly spaced, we have
-                  // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-                  // the scaling coefficient is always the same, so we use a static const
-                  // to speed up the calculation
-                  static const double scalingCoeff64qam = 
-                    (MI_MAP_64QAM_SIZE - 1) / (MI_map_64qam_axis[MI_MAP_64QAM_SIZE-1] - MI_map_64qam_axis[0]);
-                  double sinrIndexDouble = (sinrLin -  MI_map_64qam_axis[0]) * scalingCoeff64qam + 1;
-                  uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-                  NS_ASSERT_MSG (sinrIndex < MI_MAP_64QAM_SIZE, "MI map out of data");
-                  MI = MI_map_64qam[sinrIndex];
-                }
+              c = cEcrTable[i++][ecrId];
             }
+          params.b[cbIndex][ecrId] = b;
+          params.sqrt2c[cbIndex][ecrId] = sqrt(2)*c;
         }
-      NS_LOG_LOGIC (" RB " << map.at (i) << "Minimum SNR = " << 10 * std::log10 (sinrLin) << " dB, " << sinrLin << " V, MCS = " << (uint16_t)mcs << ", MI = " << MI);
-      MIsum += MI;
     }
-  MI = MIsum / map.size ();
-  NS_LOG_LOGIC (" MI = " << MI);
-  return MI;
+  return params;
 }
 
+/// parameters of the BLER curves
+static const BlerCurveParams BlerCurves = MakeBlerCurveParams ();
+
 
 double 
 LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize)
 {
   NS_LOG_FUNCTION (mib << (uint32_t) ecrId << (uint32_t) cbSize);
   double b = 0;
-  double c = 0;
 
   NS_ASSERT_MSG (ecrId <= MI_64QAM_BLER_MAX_ID, "ECR out of range [0..37]: " << (uint16_t) ecrId);
   int cbIndex = 1;
@@ -432,31 +480,10 @@ LteMiErrorModel::MappingMiBler (double mib, uint8_t ecrId, uint16_t cbSize)
   cbIndex--;
   NS_LOG_LOGIC (" ECRid " << (uint16_t)ecrId << " ECR " << BlerCurvesEcrMap[ecrId] << " CB size " << cbSize << " CB size curve " << cbMiSizeTable[cbIndex]);
 
-  b = bEcrTable[cbIndex][ecrId];
-  if (b<0.0)
-    {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i<9)&&(b<0))
-        {
-          b = bEcrTable[i++][ecrId];
-        }
-    }
-  c = cEcrTable[cbIndex][ecrId];
-  if (c<0.0)
-    {
-      //take the lowest CB size including this CB for removing CB size
-      //quatization errors
-      int i = cbIndex;
-      while ((i<9)&&(c<0))
-        {
-          c = cEcrTable[i++][ecrId];
-        }
-    }
+  b = BlerCurves.b[cbIndex][ecrId];
   // see IEEE802.16m EMD formula 55 of section 4.3.2.1
-  double bler = 0.5*( 1 - erf((mib-b)/(sqrt(2)*c)) );
-  NS_LOG_LOGIC ("MIB: " << mib << " BLER:" << bler << " b:" << b << " c:" << c);
+  double bler = 0.5*( 1 - erf((mib-b)/BlerCurves.sqrt2c[cbIndex][ecrId]) );
+  NS_LOG_LOGIC ("MIB: " << mib << " BLER:" << bler << " b:" << b << " c:" << BlerCurves.sqrt2c[cbIndex][ecrId] / sqrt(2));
   return bler;
 }
 
@@ -468,30 +495,12 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
   NS_LOG_FUNCTION (sinr);
   double MI;
   double MIsum = 0.0;
-  SpectrumValue sinrCopy = sinr;
-  Values::iterator sinrIt = sinrCopy.ValuesBegin ();
+  Values::const_iterator sinrIt = sinr.ConstValuesBegin ();
   uint16_t rb = 0;
-  NS_ASSERT (sinrIt!=sinrCopy.ValuesEnd ());
-  while (sinrIt!=sinrCopy.ValuesEnd ())
+  NS_ASSERT (sinrIt!=sinr.ConstValuesEnd ());
+  while (sinrIt!=sinr.ConstValuesEnd ())
     {
-      double sinrLin = *sinrIt;
-      if (sinrLin > MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1])
-        {
-          MI = 1;
-        }
-      else 
-        { 
-          // since the values in MI_map_qpsk_axis are uniformly spaced, we have
-          // index = ((sinrLin - value[0]) / (value[SIZE-1] - value[0])) * (SIZE-1)
-              // the scaling coefficient is always the same, so we use a static const
-              // to speed up the calculation
-          static const double scalingCoeffQpsk = 
-            (MI_MAP_QPSK_SIZE - 1) / (MI_map_qpsk_axis[MI_MAP_QPSK_SIZE-1] - MI_map_qpsk_axis[0]);
-          double sinrIndexDouble = (sinrLin -  MI_map_qpsk_axis[0]) * scalingCoeffQpsk + 1;
-          uint32_t sinrIndex = std::max(0.0, std::floor (sinrIndexDouble));
-          NS_ASSERT_MSG (sinrIndex < MI_MAP_QPSK_SIZE, "MI map out of data");
-          MI = MI_map_qpsk[sinrIndex];
-        }
+      MI = GetRbMi (MiMaps[0], *sinrIt);
       MIsum += MI;
       sinrIt++;
       rb++;
@@ -553,12 +562,17 @@ LteMiErrorModel::GetPcfichPdcchError (const SpectrumValue& sinr)
 
 
 
-TbStats_t
-LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory)
+/**
+ * \brief run the error-model algorithm for a TB whose MI is known
+ * \param tbMi the MI of the TB
+ * \param size the size in bytes of the TB
+ * \param mcs the MCS of the TB
+ * \param miHistory MI of past transmissions (in case of retx)
+ * \return the TB error rate and MI
+ */
+static TbStats_t
+GetTbDecodificationStatsFromMi (double tbMi, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
 {
-  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
-
-  double tbMi = Mib(sinr, map, mcs);
   double MI = 0.0;
   double Reff = 0.0;
   NS_ASSERT (mcs < 29);
@@ -721,15 +735,15 @@ LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std:
 
   if (C!=1)
     {
-      double cbler = MappingMiBler (MI, ecrId, Kplus);
+      double cbler = LteMiErrorModel::MappingMiBler (MI, ecrId, Kplus);
       errorRate *= pow (1.0 - cbler, Cplus);
-      cbler = MappingMiBler (MI, ecrId, Kminus);
+      cbler = LteMiErrorModel::MappingMiBler (MI, ecrId, Kminus);
       errorRate *= pow (1.0 - cbler, Cminus);
       errorRate = 1.0 - errorRate;
     }
   else
     {
-      errorRate = MappingMiBler (MI, ecrId, Kplus);
+      errorRate = LteMiErrorModel::MappingMiBler (MI, ecrId, Kplus);
     }
 
   NS_LOG_LOGIC (" Error rate " << errorRate);
@@ -740,6 +754,54 @@ LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std:
 }
 
 
+TbStats_t
+LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory)
+{
+  NS_LOG_FUNCTION (sinr << &map << (uint32_t) size << (uint32_t) mcs);
+
+  double tbMi = Mib(sinr, map, mcs);
+  return GetTbDecodificationStatsFromMi (tbMi, size, mcs, miHistory);
+}
+
+
+void
+LteMiErrorModel::GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<TbDecodificationParams_t>& tbs, std::vector<TbStats_t>& stats)
+{
+  NS_LOG_FUNCTION (sinr << tbs.size ());
+
+  Values::const_iterator sinrLin = sinr.ConstValuesBegin ();
+  uint32_t nRbs = sinr.ConstValuesEnd () - sinrLin;
+  // MI of each RB for each modulation, computed at first use; the MIs are
+  // between 0 and 1, so that -1 marks those not computed yet
+  std::vector<double> rbMi (3 * nRbs, -1.0);
+  const HarqProcessInfoList_t noHistory;
+
+  stats.resize (tbs.size ());
+  for (uint32_t t = 0; t < tbs.size (); t++)
+    {
+      const TbDecodificationParams_t& tb = tbs[t];
+      uint8_t miMapId = GetMiMapId (tb.mcs);
+      const MiMap& miMap = MiMaps[miMapId];
+      double *mi = &rbMi[miMapId * nRbs];
+      // sum in the order of the RBs of the TB, as in Mib
+      double MIsum = 0.0;
+      for (uint32_t i = 0; i < tb.map->size (); i++)
+        {
+          uint32_t rb = (*tb.map)[i];
+          NS_ASSERT_MSG (rb < nRbs, "RB " << rb << " out of the " << nRbs << " RBs of the sinr");
+          if (mi[rb] < 0)
+            {
+              mi[rb] = GetRbMi (miMap, sinrLin[rb]);
+            }
+          MIsum += mi[rb];
+        }
+      double tbMi = MIsum / tb.map->size ();
+      NS_LOG_LOGIC (" TB " << t << " MCS = " << (uint16_t)tb.mcs << ", MI = " << tbMi);
+      stats[t] = GetTbDecodificationStatsFromMi (tbMi, tb.size, tb.mcs, tb.miHistory ? *tb.miHistory : noHistory);
+    }
+}
+
+
   
 
 } // namespace ns3
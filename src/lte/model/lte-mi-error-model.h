@@ -72,6 +72,15 @@ struct TbStats_t
   double tbler; ///< Transport block BLER
   double mi; ///< Mutual information
 };
+
+/// TbDecodificationParams_t structure
+struct TbDecodificationParams_t
+{
+  const std::vector<int> *map; ///< the active RBs of the TB
+  uint16_t size; ///< the size in bytes of the TB
+  uint8_t mcs; ///< the MCS of the TB
+  const HarqProcessInfoList_t *miHistory; ///< MI of past transmissions (in case of retx), or 0
+};
   
 
 
@@ -109,7 +118,21 @@ public:
    * \param miHistory MI of past transmissions (in case of retx)
    * \return the TB error rate and MI
    */
-  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, HarqProcessInfoList_t miHistory);
+  static TbStats_t GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<int>& map, uint16_t size, uint8_t mcs, const HarqProcessInfoList_t& miHistory);
+
+  /**
+   * \brief run the error-model algorithm for a set of TBs perceiving the
+   * same sinr, e.g., all the TBs of a subframe
+   *
+   * The MI of each RB is computed once for all the TBs using the same
+   * modulation, on the contiguous sinr values, and the results are the same
+   * as those of GetTbDecodificationStats called for each TB.
+   *
+   * \param sinr the perceived sinr values in the whole bandwidth in Watt
+   * \param tbs the TBs
+   * \param stats the TB error rate and MI of each TB, in the order of tbs
+   */
+  static void GetTbDecodificationStats (const SpectrumValue& sinr, const std::vector<TbDecodificationParams_t>& tbs, std::vector<TbStats_t>& stats);
   
   /** 
   * \brief run the error-model algorithm for the specified PCFICH+PDCCH channels
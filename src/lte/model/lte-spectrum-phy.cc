@@ -971,12 +971,15 @@ LteSpectrumPhy::EndRxData ()
   NS_ASSERT (m_transmissionMode < m_txModeGain.size ());
   m_sinrPerceived *= m_txModeGain.at (m_transmissionMode);
   
-  while (itTb!=m_expectedTbs.end ())
+  if ((m_dataErrorModelEnabled)&&(m_rxPacketBurstList.size ()>0)) // avoid to check for errors when there is no actual data transmitted
     {
-      if ((m_dataErrorModelEnabled)&&(m_rxPacketBurstList.size ()>0)) // avoid to check for errors when there is no actual data transmitted
+      // retrieve HARQ info and evaluate the error model of all the TBs at once
+      std::vector<HarqProcessInfoList_t> harqInfoLists (m_expectedTbs.size ());
+      std::vector<TbDecodificationParams_t> tbs (m_expectedTbs.size ());
+      uint32_t tb = 0;
+      for (itTb = m_expectedTbs.begin (); itTb != m_expectedTbs.end (); itTb++, tb++)
         {
-          // retrieve HARQ info
-          HarqProcessInfoList_t harqInfoList;
+          HarqProcessInfoList_t& harqInfoList = harqInfoLists[tb];
           if ((*itTb).second.ndi == 0)
             {
               // TB retxed: retrieve HARQ history
@@ -990,7 +993,19 @@ LteSpectrumPhy::EndRxData ()
                   harqInfoList = m_harqPhyModule->GetHarqProcessInfoUl ((*itTb).first.m_rnti, ulHarqId);
                 }
             }
-          TbStats_t tbStats = LteMiErrorModel::GetTbDecodificationStats (m_sinrPerceived, (*itTb).second.rbBitmap, (*itTb).second.size, (*itTb).second.mcs, harqInfoList);
+          tbs[tb].map = &(*itTb).second.rbBitmap;
+          tbs[tb].size = (*itTb).second.size;
+          tbs[tb].mcs = (*itTb).second.mcs;
+          tbs[tb].miHistory = &harqInfoList;
+        }
+      std::vector<TbStats_t> tbsStats;
+      LteMiErrorModel::GetTbDecodificationStats (m_sinrPerceived, tbs, tbsStats);
+
+      tb = 0;
+      for (itTb = m_expectedTbs.begin (); itTb != m_expectedTbs.end (); itTb++, tb++)
+        {
+          const HarqProcessInfoList_t& harqInfoList = harqInfoLists[tb];
+          const TbStats_t& tbStats = tbsStats[tb];
           (*itTb).second.mi = tbStats.mi;
           (*itTb).second.corrupt = m_random->GetValue () > tbStats.tbler ? false : true;
           NS_LOG_DEBUG (this << "RNTI " << (*itTb).first.m_rnti << " size " << (*itTb).second.size << " mcs " << (uint32_t)(*itTb).second.mcs << " bitmap " << (*itTb).second.rbBitmap.size () << " layer " << (uint16_t)(*itTb).first.m_layer << " TBLER " << tbStats.tbler << " corrupted " << (*itTb).second.corrupt);
@@ -1019,9 +1034,7 @@ LteSpectrumPhy::EndRxData ()
               params.m_rv = harqInfoList.size ();
               m_ulPhyReception (params);
             }
-       }
-      
-      itTb++;
+        }
     }
     std::map <uint16_t, DlInfoListElement_s> harqDlInfoMap;
     for (std::list<Ptr<PacketBurst> >::const_iterator i = m_rxPacketBurstList.begin (); 
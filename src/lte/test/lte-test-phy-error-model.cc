@@ -50,6 +50,8 @@
 #include <ns3/unused.h>
 #include <ns3/ff-mac-scheduler.h>
 #include <ns3/buildings-helper.h>
+#include <ns3/lte-mi-error-model.h>
+#include <ns3/random-variable-stream.h>
 
 #include "lte-test-phy-error-model.h"
 
@@ -127,6 +129,7 @@ LenaTestPhyErrorModelSuite::LenaTestPhyErrorModelSuite ()
 
     }
 
+  AddTestCase (new LenaMiErrorModelBatchTestCase, TestCase::QUICK);
 }
 
 static LenaTestPhyErrorModelSuite lenaTestPhyErrorModelSuite;
@@ -438,3 +441,74 @@ LenaDlCtrlPhyErrorModelTestCase::DoRun (void)
   
   Simulator::Destroy ();
 }
+
+
+
+LenaMiErrorModelBatchTestCase::LenaMiErrorModelBatchTestCase ()
+  : TestCase ("MiErrorModel batch of TBs")
+{
+}
+
+LenaMiErrorModelBatchTestCase::~LenaMiErrorModelBatchTestCase ()
+{
+}
+
+void
+LenaMiErrorModelBatchTestCase::DoRun (void)
+{
+  // 50 RBs, with SINRs from -10 dB to 30 dB
+  std::vector<double> freqs;
+  for (uint32_t rb = 0; rb < 50; rb++)
+    {
+      freqs.push_back (2.12e9 + rb * 180e3);
+    }
+  Ptr<SpectrumModel> model = Create<SpectrumModel> (freqs);
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+
+  for (uint32_t run = 0; run < 20; run++)
+    {
+      SpectrumValue sinr (model);
+      for (uint32_t rb = 0; rb < 50; rb++)
+        {
+          sinr[rb] = std::pow (10.0, random->GetValue (-10, 30) / 10);
+        }
+      // TBs of all the MCSs, on overlapping RBs, some of them retransmitted
+      uint32_t nTbs = 29;
+      std::vector<std::vector<int> > maps (nTbs);
+      std::vector<HarqProcessInfoList_t> harqInfoLists (nTbs);
+      std::vector<TbDecodificationParams_t> tbs (nTbs);
+      for (uint32_t tb = 0; tb < nTbs; tb++)
+        {
+          uint32_t first = random->GetInteger (0, 45);
+          uint32_t nRbs = random->GetInteger (1, 50 - first);
+          for (uint32_t rb = first; rb < first + nRbs; rb++)
+            {
+              maps[tb].push_back (rb);
+            }
+          if (tb % 3 == 0)
+            {
+              HarqProcessInfoElement_t el;
+              el.m_mi = random->GetValue (0, 1);
+              el.m_rv = 0;
+              el.m_infoBits = 8 * random->GetInteger (10, 500);
+              el.m_codeBits = el.m_infoBits * 2;
+              harqInfoLists[tb].push_back (el);
+            }
+          tbs[tb].map = &maps[tb];
+          tbs[tb].size = random->GetInteger (10, 3000);
+          tbs[tb].mcs = tb;
+          tbs[tb].miHistory = (tb % 3 == 0) ? &harqInfoLists[tb] : 0;
+        }
+
+      std::vector<TbStats_t> stats;
+      LteMiErrorModel::GetTbDecodificationStats (sinr, tbs, stats);
+      NS_TEST_ASSERT_MSG_EQ (stats.size (), nTbs, "wrong number of TB stats");
+      for (uint32_t tb = 0; tb < nTbs; tb++)
+        {
+          TbStats_t expected = LteMiErrorModel::GetTbDecodificationStats (sinr, maps[tb], tbs[tb].size, tbs[tb].mcs, harqInfoLists[tb]);
+          NS_TEST_ASSERT_MSG_EQ (stats[tb].tbler, expected.tbler, "wrong TBLER of TB " << tb);
+          NS_TEST_ASSERT_MSG_EQ (stats[tb].mi, expected.mi, "wrong MI of TB " << tb);
+        }
+    }
+}
@@ -123,6 +123,25 @@ private:
 
 
 
+/**
+ * \ingroup lte-test
+ * \ingroup tests
+ *
+ * \brief Test that the TBs evaluated at once by LteMiErrorModel get the same
+ * error rates and MIs as when they are evaluated one by one
+ */
+class LenaMiErrorModelBatchTestCase : public TestCase
+{
+public:
+  LenaMiErrorModelBatchTestCase ();
+  virtual ~LenaMiErrorModelBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+
+
 /**
  * \ingroup lte-test
  * \ingroup tests
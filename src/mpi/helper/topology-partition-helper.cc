@@ -0,0 +1,543 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "topology-partition-helper.h"
+
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TopologyPartitionHelper");
+
+namespace {
+
+/**
+ * Find the root of the set of an element, halving the path.
+ * \param [in,out] parent The parent of each element.
+ * \param [in] i The element.
+ * \returns The root of the set.
+ */
+uint32_t
+FindRoot (std::vector<uint32_t> &parent, uint32_t i)
+{
+  while (parent[i] != i)
+    {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+  return i;
+}
+
+} // unnamed namespace
+
+TopologyPartitionHelper::TopologyPartitionHelper ()
+  : m_imbalance (0.05)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TopologyPartitionHelper::SetImbalance (double imbalance)
+{
+  NS_LOG_FUNCTION (this << imbalance);
+  NS_ASSERT (imbalance >= 0);
+  m_imbalance = imbalance;
+}
+
+uint32_t
+TopologyPartitionHelper::GetIndex (Ptr<Node> node)
+{
+  std::map<uint32_t, uint32_t>::const_iterator it = m_index.find (node->GetId ());
+  if (it != m_index.end ())
+    {
+      return it->second;
+    }
+  uint32_t index = m_nodes.size ();
+  m_index[node->GetId ()] = index;
+  m_nodes.push_back (node);
+  m_weights.push_back (1.0);
+  return index;
+}
+
+void
+TopologyPartitionHelper::AddNodes (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      GetIndex (*i);
+    }
+}
+
+void
+TopologyPartitionHelper::SetNodeWeight (Ptr<Node> node, double weight)
+{
+  NS_LOG_FUNCTION (this << node << weight);
+  NS_ASSERT (weight >= 0);
+  m_weights[GetIndex (node)] = weight;
+}
+
+void
+TopologyPartitionHelper::AddLink (Ptr<Node> a, Ptr<Node> b, Time delay, double weight)
+{
+  NS_LOG_FUNCTION (this << a << b << delay << weight);
+  Link link;
+  link.a = GetIndex (a);
+  link.b = GetIndex (b);
+  link.delay = std::max (delay.GetTimeStep (), static_cast<int64_t> (0));
+  link.weight = weight;
+  m_links.push_back (link);
+}
+
+void
+TopologyPartitionHelper::AddChannels (NodeContainer nodes)
+{
+  NS_LOG_FUNCTION (this);
+  TypeId p2pTid;
+  bool p2pFound = TypeId::LookupByNameFailSafe ("ns3::PointToPointChannel", &p2pTid);
+  std::set<uint32_t> channels;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      GetIndex (*i);
+      for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j)
+        {
+          Ptr<Channel> channel = (*i)->GetDevice (j)->GetChannel ();
+          if (channel == 0 || !channels.insert (channel->GetId ()).second)
+            {
+              continue;
+            }
+          uint32_t nDevices = channel->GetNDevices ();
+          if (nDevices < 2)
+            {
+              continue;
+            }
+          TimeValue delay (Seconds (0));
+          TypeId tid = channel->GetInstanceTypeId ();
+          if (p2pFound && (tid == p2pTid || tid.IsChildOf (p2pTid)))
+            {
+              channel->GetAttribute ("Delay", delay);
+            }
+          // A star of links: with more than two devices, all the links
+          // have a zero delay and are never cut
+          Ptr<Node> first = channel->GetDevice (0)->GetNode ();
+          for (uint32_t k = 1; k < nDevices; ++k)
+            {
+              AddLink (first, channel->GetDevice (k)->GetNode (), delay.Get ());
+            }
+        }
+    }
+}
+
+uint32_t
+TopologyPartitionHelper::Cluster (int64_t threshold, std::vector<uint32_t> &cluster) const
+{
+  std::vector<uint32_t> parent (m_nodes.size ());
+  for (uint32_t i = 0; i < parent.size (); ++i)
+    {
+      parent[i] = i;
+    }
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (i->delay < threshold || i->delay == 0)
+        {
+          uint32_t a = FindRoot (parent, i->a);
+          uint32_t b = FindRoot (parent, i->b);
+          if (a != b)
+            {
+              parent[std::max (a, b)] = std::min (a, b);
+            }
+        }
+    }
+  // Number the groups in the order of their first node
+  uint32_t count = 0;
+  std::vector<uint32_t> number (m_nodes.size (), 0);
+  cluster.resize (m_nodes.size ());
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      uint32_t root = FindRoot (parent, i);
+      if (root == i)
+        {
+          number[i] = count++;
+        }
+      cluster[i] = number[root];
+    }
+  return count;
+}
+
+bool
+TopologyPartitionHelper::Fits (std::vector<double> weights, uint32_t systemCount, double bound)
+{
+  // Largest groups first, each one to the least loaded system id
+  std::sort (weights.begin (), weights.end (), std::greater<double> ());
+  std::priority_queue<double, std::vector<double>, std::greater<double> > loads;
+  for (uint32_t i = 0; i < systemCount; ++i)
+    {
+      loads.push (0);
+    }
+  for (std::vector<double>::const_iterator i = weights.begin (); i != weights.end (); ++i)
+    {
+      double load = loads.top () + *i;
+      if (load > bound)
+        {
+          return false;
+        }
+      loads.pop ();
+      loads.push (load);
+    }
+  return true;
+}
+
+void
+TopologyPartitionHelper::Partition (uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this << systemCount);
+  NS_ABORT_MSG_IF (systemCount == 0, "TopologyPartitionHelper::Partition(): no system id");
+
+  uint32_t nNodes = m_nodes.size ();
+  m_systemIds.assign (nNodes, 0);
+  m_loads.assign (systemCount, 0);
+  double total = 0;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      total += m_weights[i];
+    }
+  double bound = (1 + m_imbalance) * total / systemCount;
+
+  // The lookahead is one of the link delays: find the largest one such
+  // that the nodes joined by shorter links still fit in the system ids.
+  std::vector<int64_t> delays (1, 0);
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (i->delay > 0)
+        {
+          delays.push_back (i->delay);
+        }
+    }
+  std::sort (delays.begin (), delays.end ());
+  delays.erase (std::unique (delays.begin (), delays.end ()), delays.end ());
+  delays.push_back (std::numeric_limits<int64_t>::max ());
+
+  std::vector<uint32_t> cluster;
+  uint32_t low = 0;
+  uint32_t high = delays.size () - 1;
+  while (low < high)
+    {
+      uint32_t middle = (low + high + 1) / 2;
+      uint32_t nClusters = Cluster (delays[middle], cluster);
+      std::vector<double> weights (nClusters, 0);
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          weights[cluster[i]] += m_weights[i];
+        }
+      if (Fits (weights, systemCount, bound))
+        {
+          low = middle;
+        }
+      else
+        {
+          high = middle - 1;
+        }
+    }
+  uint32_t nClusters = Cluster (delays[low], cluster);
+  NS_LOG_LOGIC ("threshold " << delays[low] << ", " << nClusters << " groups of nodes");
+
+  // The graph of the groups of nodes
+  std::vector<double> weights (nClusters, 0);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      weights[cluster[i]] += m_weights[i];
+    }
+  typedef std::vector<std::pair<uint32_t, double> > Neighbors;
+  std::vector<Neighbors> neighbors (nClusters);
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      uint32_t a = cluster[i->a];
+      uint32_t b = cluster[i->b];
+      if (a != b)
+        {
+          neighbors[a].push_back (std::make_pair (b, i->weight));
+          neighbors[b].push_back (std::make_pair (a, i->weight));
+        }
+    }
+  for (uint32_t c = 0; c < nClusters; ++c)
+    {
+      Neighbors &n = neighbors[c];
+      std::sort (n.begin (), n.end ());
+      uint32_t k = 0;
+      for (uint32_t j = 0; j < n.size (); ++j)
+        {
+          if (k > 0 && n[k - 1].first == n[j].first)
+            {
+              n[k - 1].second += n[j].second;
+            }
+          else
+            {
+              n[k++] = n[j];
+            }
+        }
+      n.resize (k);
+    }
+
+  // Grow the system ids one by one from a seed group, adding the group
+  // most connected to the system id until it reaches its share.
+  std::vector<uint32_t> part (nClusters, systemCount);
+  std::vector<uint32_t> count (systemCount, 0);
+  double remaining = total;
+  uint32_t nextSeed = 0;
+  for (uint32_t r = 0; r < systemCount; ++r)
+    {
+      if (r == systemCount - 1)
+        {
+          for (uint32_t c = 0; c < nClusters; ++c)
+            {
+              if (part[c] == systemCount)
+                {
+                  part[c] = r;
+                  m_loads[r] += weights[c];
+                  count[r]++;
+                }
+            }
+          break;
+        }
+      double target = remaining / (systemCount - r);
+      std::set<std::pair<double, uint32_t> > frontier;
+      std::map<uint32_t, double> gains;
+      std::set<uint32_t> skipped;
+      uint32_t seed = nextSeed;
+      if (r > 0)
+        {
+          // Start next to the system ids already grown, so that the
+          // rest of the graph is not split
+          double best = 0;
+          for (uint32_t c = nextSeed; c < nClusters; ++c)
+            {
+              if (part[c] != systemCount)
+                {
+                  continue;
+                }
+              double connection = 0;
+              for (Neighbors::const_iterator n = neighbors[c].begin (); n != neighbors[c].end (); ++n)
+                {
+                  if (part[n->first] != systemCount)
+                    {
+                      connection += n->second;
+                    }
+                }
+              if (connection > best)
+                {
+                  best = connection;
+                  frontier.clear ();
+                  frontier.insert (std::make_pair (0.0, c));
+                }
+            }
+        }
+      while (m_loads[r] < target)
+        {
+          uint32_t c;
+          if (frontier.empty ())
+            {
+              while (seed < nClusters && (part[seed] != systemCount || skipped.count (seed)))
+                {
+                  seed++;
+                }
+              if (seed == nClusters)
+                {
+                  break;
+                }
+              c = seed;
+            }
+          else
+            {
+              c = frontier.begin ()->second;
+              frontier.erase (frontier.begin ());
+              gains.erase (c);
+            }
+          if (m_loads[r] > 0 && m_loads[r] + weights[c] > bound)
+            {
+              skipped.insert (c);
+              continue;
+            }
+          part[c] = r;
+          m_loads[r] += weights[c];
+          count[r]++;
+          for (Neighbors::const_iterator n = neighbors[c].begin (); n != neighbors[c].end (); ++n)
+            {
+              if (part[n->first] != systemCount || skipped.count (n->first))
+                {
+                  continue;
+                }
+              double &gain = gains[n->first];
+              frontier.erase (std::make_pair (-gain, n->first));
+              gain += n->second;
+              frontier.insert (std::make_pair (-gain, n->first));
+            }
+        }
+      while (nextSeed < nClusters && part[nextSeed] != systemCount)
+        {
+          nextSeed++;
+        }
+      remaining -= m_loads[r];
+    }
+
+  // Move groups of nodes to the system id they are most connected to,
+  // as long as this reduces the cut or the imbalance.
+  for (uint32_t pass = 0; pass < 16; ++pass)
+    {
+      bool moved = false;
+      for (uint32_t c = 0; c < nClusters; ++c)
+        {
+          uint32_t own = part[c];
+          if (count[own] == 1)
+            {
+              continue;
+            }
+          std::map<uint32_t, double> connection;
+          for (Neighbors::const_iterator n = neighbors[c].begin (); n != neighbors[c].end (); ++n)
+            {
+              connection[part[n->first]] += n->second;
+            }
+          double internal = connection[own];
+          bool overloaded = m_loads[own] > bound;
+          uint32_t best = own;
+          double bestGain = overloaded ? -std::numeric_limits<double>::max () : 0;
+          for (std::map<uint32_t, double>::const_iterator i = connection.begin (); i != connection.end (); ++i)
+            {
+              uint32_t r = i->first;
+              if (r == own || m_loads[r] + weights[c] > bound)
+                {
+                  continue;
+                }
+              double gain = i->second - internal;
+              if (gain > bestGain
+                  || (gain == bestGain && best == own && m_loads[r] + weights[c] < m_loads[own])
+                  || (gain == bestGain && best != own && m_loads[r] < m_loads[best]))
+                {
+                  best = r;
+                  bestGain = gain;
+                }
+            }
+          if (overloaded && best == own)
+            {
+              uint32_t lightest = std::min_element (m_loads.begin (), m_loads.end ()) - m_loads.begin ();
+              if (m_loads[lightest] + weights[c] < m_loads[own])
+                {
+                  best = lightest;
+                }
+            }
+          if (best != own)
+            {
+              part[c] = best;
+              m_loads[own] -= weights[c];
+              m_loads[best] += weights[c];
+              count[own]--;
+              count[best]++;
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      m_systemIds[i] = part[cluster[i]];
+    }
+  NS_LOG_LOGIC ("lookahead " << GetLookAhead () << ", cut weight " << GetCutWeight ());
+}
+
+uint32_t
+TopologyPartitionHelper::GetSystemId (Ptr<Node> node) const
+{
+  std::map<uint32_t, uint32_t>::const_iterator it = m_index.find (node->GetId ());
+  NS_ABORT_MSG_IF (it == m_index.end () || it->second >= m_systemIds.size (),
+                   "TopologyPartitionHelper::GetSystemId(): node " << node->GetId () << " not partitioned");
+  return m_systemIds[it->second];
+}
+
+Time
+TopologyPartitionHelper::GetLookAhead (void) const
+{
+  NS_ASSERT (m_systemIds.size () == m_nodes.size ());
+  Time lookAhead = Time::Max ();
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (m_systemIds[i->a] != m_systemIds[i->b])
+        {
+          lookAhead = std::min (lookAhead, TimeStep (i->delay));
+        }
+    }
+  return lookAhead;
+}
+
+double
+TopologyPartitionHelper::GetCutWeight (void) const
+{
+  NS_ASSERT (m_systemIds.size () == m_nodes.size ());
+  double weight = 0;
+  for (std::vector<Link>::const_iterator i = m_links.begin (); i != m_links.end (); ++i)
+    {
+      if (m_systemIds[i->a] != m_systemIds[i->b])
+        {
+          weight += i->weight;
+        }
+    }
+  return weight;
+}
+
+double
+TopologyPartitionHelper::GetLoad (uint32_t systemId) const
+{
+  NS_ASSERT (systemId < m_loads.size ());
+  return m_loads[systemId];
+}
+
+void
+TopologyPartitionHelper::Assign (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_systemIds.size () != m_nodes.size (),
+                   "TopologyPartitionHelper::Assign(): Partition() not called");
+  for (uint32_t i = 0; i < m_nodes.size (); ++i)
+    {
+      m_nodes[i]->SetAttribute ("SystemId", UintegerValue (m_systemIds[i]));
+    }
+}
+
+void
+TopologyPartitionHelper::Print (std::ostream &os) const
+{
+  for (uint32_t i = 0; i < m_systemIds.size (); ++i)
+    {
+      os << m_nodes[i]->GetId () << " " << m_systemIds[i] << std::endl;
+    }
+}
+
+} // namespace ns3
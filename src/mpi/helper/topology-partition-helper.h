@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef TOPOLOGY_PARTITION_HELPER_H
+#define TOPOLOGY_PARTITION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <map>
+#include <ostream>
+#include <vector>
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Compute the system ids of the nodes of a distributed simulation
+ *
+ * The helper is given the nodes, optionally weighted by their expected
+ * load, and the links between them with their delays, either explicitly
+ * (e.g., from the links of a TopologyReader, before they are installed)
+ * or from the channels of already installed devices.  Partition() then
+ * splits the nodes into the requested number of system ids:
+ *
+ *  - the lookahead, i.e., the smallest delay of the links between
+ *    different system ids, is made as large as possible, as long as the
+ *    load of each system id stays within the allowed imbalance;
+ *  - the total weight of the links between different system ids is then
+ *    reduced by moving groups of nodes across the cut.
+ *
+ * Links with a zero delay, and channels other than point-to-point ones,
+ * are never cut.  The result only depends on the order in which nodes
+ * and links were added, so every rank of an MPI simulation computes the
+ * same partition.
+ *
+ * Since the point-to-point helper chooses a remote channel from the
+ * system ids of the nodes, Assign() must be called before the links
+ * between nodes are installed in MPI simulations:
+ *
+ * \code
+ *   TopologyPartitionHelper partition;
+ *   partition.AddNodes (nodes);
+ *   for (... each link ...)
+ *     {
+ *       partition.AddLink (from, to, delay);
+ *     }
+ *   partition.Partition (MpiInterface::GetSize ());
+ *   partition.Assign ();
+ *   // install the point-to-point links
+ * \endcode
+ */
+class TopologyPartitionHelper
+{
+public:
+  TopologyPartitionHelper ();
+
+  /**
+   * Set the allowed load imbalance.
+   *
+   * The load of each system id is kept below (1 + imbalance) times the
+   * average load, unless a single group of nodes which cannot be split
+   * is larger than that.
+   *
+   * \param [in] imbalance The allowed imbalance, 0.05 by default.
+   */
+  void SetImbalance (double imbalance);
+  /**
+   * Add nodes to partition, with a weight of 1.
+   * \param [in] nodes The nodes.
+   */
+  void AddNodes (NodeContainer nodes);
+  /**
+   * Set the weight of a node, e.g., its expected number of events.
+   * The node is added if needed.
+   * \param [in] node The node.
+   * \param [in] weight The weight of the node.
+   */
+  void SetNodeWeight (Ptr<Node> node, double weight);
+  /**
+   * Add a link between two nodes.  The nodes are added if needed.
+   * \param [in] a The first node.
+   * \param [in] b The second node.
+   * \param [in] delay The delay of the link.
+   * \param [in] weight The cost of cutting the link, e.g., its expected traffic.
+   */
+  void AddLink (Ptr<Node> a, Ptr<Node> b, Time delay, double weight = 1.0);
+  /**
+   * Add the links of the channels of the devices of some nodes.
+   *
+   * Point-to-point channels, and their subclasses, are added as links
+   * with the delay given by their "Delay" attribute; other channels are
+   * never cut.  The point-to-point module is found by TypeId, since it
+   * depends on this module.
+   *
+   * \param [in] nodes The nodes.
+   */
+  void AddChannels (NodeContainer nodes);
+  /**
+   * Compute the partition.
+   * \param [in] systemCount The number of system ids.
+   */
+  void Partition (uint32_t systemCount);
+  /**
+   * \param [in] node A node.
+   * \returns The system id computed for the node.
+   */
+  uint32_t GetSystemId (Ptr<Node> node) const;
+  /**
+   * \returns The smallest delay of the links between different system
+   * ids, or Time::Max () if there is none.
+   */
+  Time GetLookAhead (void) const;
+  /**
+   * \returns The total weight of the links between different system ids.
+   */
+  double GetCutWeight (void) const;
+  /**
+   * \param [in] systemId A system id.
+   * \returns The total weight of the nodes of the system id.
+   */
+  double GetLoad (uint32_t systemId) const;
+  /**
+   * Set the SystemId attribute of the nodes to the computed system ids.
+   */
+  void Assign (void) const;
+  /**
+   * Print the mapping of the nodes to their system id, one
+   * "node-id system-id" pair per line.
+   * \param [in,out] os The output stream.
+   */
+  void Print (std::ostream &os) const;
+
+private:
+  /** A link between two nodes. */
+  struct Link
+  {
+    uint32_t a;       //!< The index of the first node.
+    uint32_t b;       //!< The index of the second node.
+    int64_t delay;    //!< The delay, in time steps.
+    double weight;    //!< The cost of cutting the link.
+  };
+
+  /**
+   * \param [in] node A node.
+   * \returns The index of the node, added if needed.
+   */
+  uint32_t GetIndex (Ptr<Node> node);
+  /**
+   * Group the nodes joined by links shorter than a threshold.
+   * \param [in] threshold The delay threshold, in time steps.
+   * \param [out] cluster The group of each node, numbered from 0.
+   * \returns The number of groups.
+   */
+  uint32_t Cluster (int64_t threshold, std::vector<uint32_t> &cluster) const;
+  /**
+   * Check that the groups of nodes can be spread over the system ids
+   * within the allowed imbalance.
+   * \param [in] weights The weights of the groups.
+   * \param [in] systemCount The number of system ids.
+   * \param [in] bound The maximum load of a system id.
+   * \returns true if the groups fit.
+   */
+  static bool Fits (std::vector<double> weights, uint32_t systemCount, double bound);
+
+  std::vector<Ptr<Node> > m_nodes;              //!< The nodes.
+  std::map<uint32_t, uint32_t> m_index;         //!< The index of each node id.
+  std::vector<double> m_weights;                //!< The weight of each node.
+  std::vector<Link> m_links;                    //!< The links.
+  std::vector<uint32_t> m_systemIds;            //!< The system id of each node.
+  std::vector<double> m_loads;                  //!< The load of each system id.
+  double m_imbalance;                           //!< The allowed imbalance.
+};
+
+} // namespace ns3
+
+#endif /* TOPOLOGY_PARTITION_HELPER_H */
@@ -389,7 +389,9 @@ DistributedSimulatorImpl::Run (void)
       if (nextTime > m_grantedTime || IsLocalFinished () )
         {
           // Can't process next event, calculate a new LBTS
-          // First receive any pending messages
+          // First send the packets buffered during this window
+          GrantedTimeWindowMpiInterface::FlushSendBuffers ();
+          // Then receive any pending messages
           GrantedTimeWindowMpiInterface::ReceiveMessages ();
           // reset next time
           nextTime = Next ();
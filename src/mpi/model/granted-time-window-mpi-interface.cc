@@ -23,6 +23,7 @@
 #include <iostream>
 #include <iomanip>
 #include <list>
+#include <cstring>
 
 #include "granted-time-window-mpi-interface.h"
 #include "mpi-receiver.h"
@@ -35,6 +36,8 @@
 #include "ns3/simulator-impl.h"
 #include "ns3/nstime.h"
 #include "ns3/log.h"
+#include "ns3/global-value.h"
+#include "ns3/boolean.h"
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -44,27 +47,63 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GrantedTimeWindowMpiInterface");
 
+/**
+ * \ingroup mpi
+ * Send the packets without their metadata, tags and nix vector.
+ */
+static GlobalValue g_mpiStripPackets = GlobalValue ("MpiStripPackets",
+                                                    "Send only the packet bytes between ranks, "
+                                                    "without metadata, tags and nix vector",
+                                                    BooleanValue (false),
+                                                    MakeBooleanChecker ());
+
+/**
+ * Header of a packet record in a message.  Each message holds the
+ * records of all the packets sent to a rank during a time window;
+ * each record is made of this header followed by the packet.
+ */
+struct PacketRecordHeader
+{
+  uint64_t time;    //!< The receive time
+  uint32_t node;    //!< The destination node
+  uint32_t dev;     //!< The destination device
+  uint32_t size;    //!< The size of the packet data
+  uint32_t format;  //!< 1 if the data is the packet bytes only, 0 if serialized
+};
+
 SentBuffer::SentBuffer ()
 {
-  m_buffer = 0;
   m_request = 0;
 }
 
 SentBuffer::~SentBuffer ()
 {
-  delete [] m_buffer;
 }
 
 uint8_t*
 SentBuffer::GetBuffer ()
 {
-  return m_buffer;
+  return m_buffer.empty () ? 0 : &m_buffer[0];
+}
+
+uint32_t
+SentBuffer::GetSize ()
+{
+  return m_buffer.size ();
+}
+
+uint8_t*
+SentBuffer::Append (uint32_t size)
+{
+  uint32_t start = m_buffer.size ();
+  m_buffer.resize (start + size);
+  return &m_buffer[start];
 }
 
 void
-SentBuffer::SetBuffer (uint8_t* buffer)
+SentBuffer::Clear ()
 {
-  m_buffer = buffer;
+  m_buffer.clear ();
 }
 
 #ifdef NS3_MPI
@@ -79,14 +118,13 @@ uint32_t              GrantedTimeWindowMpiInterface::m_sid = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_size = 1;
 bool                  GrantedTimeWindowMpiInterface::m_initialized = false;
 bool                  GrantedTimeWindowMpiInterface::m_enabled = false;
+bool                  GrantedTimeWindowMpiInterface::m_stripPackets = false;
 uint32_t              GrantedTimeWindowMpiInterface::m_rxCount = 0;
 uint32_t              GrantedTimeWindowMpiInterface::m_txCount = 0;
-std::list<SentBuffer> GrantedTimeWindowMpiInterface::m_pendingTx;
-
-#ifdef NS3_MPI
-MPI_Request* GrantedTimeWindowMpiInterface::m_requests;
-char**       GrantedTimeWindowMpiInterface::m_pRxBuffers;
-#endif
+std::vector<uint8_t>  GrantedTimeWindowMpiInterface::m_rxBuffer;
+std::vector<SentBuffer*> GrantedTimeWindowMpiInterface::m_sendBuffers;
+std::list<SentBuffer*> GrantedTimeWindowMpiInterface::m_pendingTx;
+std::list<SentBuffer*> GrantedTimeWindowMpiInterface::m_freeTx;
 
 TypeId 
 GrantedTimeWindowMpiInterface::GetTypeId (void)
@@ -104,14 +142,22 @@ GrantedTimeWindowMpiInterface::Destroy ()
   NS_LOG_FUNCTION (this);
 
 #ifdef NS3_MPI
-  for (uint32_t i = 0; i < GetSize (); ++i)
+  for (std::vector<SentBuffer*>::iterator i = m_sendBuffers.begin (); i != m_sendBuffers.end (); ++i)
     {
-      delete [] m_pRxBuffers[i];
+      delete *i;
+    }
+  m_sendBuffers.clear ();
+  for (std::list<SentBuffer*>::iterator i = m_pendingTx.begin (); i != m_pendingTx.end (); ++i)
+    {
+      delete *i;
     }
-  delete [] m_pRxBuffers;
-  delete [] m_requests;
-
   m_pendingTx.clear ();
+  for (std::list<SentBuffer*>::iterator i = m_freeTx.begin (); i != m_freeTx.end (); ++i)
+    {
+      delete *i;
+    }
+  m_freeTx.clear ();
+  std::vector<uint8_t> ().swap (m_rxBuffer);
 #endif
 }
 
@@ -173,15 +219,11 @@ GrantedTimeWindowMpiInterface::Enable (int* pargc, char*** pargv)
   MPI_Comm_size (MPI_COMM_WORLD, reinterpret_cast <int *> (&m_size));
   m_enabled = true;
   m_initialized = true;
-  // Post a non-blocking receive for all peers
-  m_pRxBuffers = new char*[m_size];
-  m_requests = new MPI_Request[m_size];
-  for (uint32_t i = 0; i < GetSize (); ++i)
-    {
-      m_pRxBuffers[i] = new char[MAX_MPI_MSG_SIZE];
-      MPI_Irecv (m_pRxBuffers[i], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[i]);
-    }
+  BooleanValue strip;
+  g_mpiStripPackets.GetValue (strip);
+  m_stripPackets = strip.Get ();
+  // One send buffer per peer, filled during a time window
+  m_sendBuffers.resize (m_size, 0);
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
@@ -193,30 +235,69 @@ GrantedTimeWindowMpiInterface::SendPacket (Ptr<Packet> p, const Time& rxTime, ui
   NS_LOG_FUNCTION (this << p << rxTime.GetTimeStep () << node << dev);
 
 #ifdef NS3_MPI
-  SentBuffer sendBuf;
-  m_pendingTx.push_back (sendBuf);
-  std::list<SentBuffer>::reverse_iterator i = m_pendingTx.rbegin (); // Points to the last element
-
-  uint32_t serializedSize = p->GetSerializedSize ();
-  uint8_t* buffer =  new uint8_t[serializedSize + 16];
-  i->SetBuffer (buffer);
-  // Add the time, dest node and dest device
-  uint64_t t = rxTime.GetInteger ();
-  uint64_t* pTime = reinterpret_cast <uint64_t *> (buffer);
-  *pTime++ = t;
-  uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-  *pData++ = node;
-  *pData++ = dev;
-  // Serialize the packet
-  p->Serialize (reinterpret_cast<uint8_t *> (pData), serializedSize);
-
   // Find the system id for the destination node
   Ptr<Node> destNode = NodeList::GetNode (node);
   uint32_t nodeSysId = destNode->GetSystemId ();
+  NS_ASSERT (nodeSysId < m_sendBuffers.size ());
+  if (m_sendBuffers[nodeSysId] == 0)
+    {
+      m_sendBuffers[nodeSysId] = GetFreeBuffer ();
+    }
+
+  PacketRecordHeader header;
+  header.time = rxTime.GetInteger ();
+  header.node = node;
+  header.dev = dev;
+  header.format = m_stripPackets ? 1 : 0;
+  header.size = m_stripPackets ? p->GetSize () : p->GetSerializedSize ();
+
+  // Append the record to the buffer of the destination rank
+  uint8_t* buffer = m_sendBuffers[nodeSysId]->Append (sizeof (header) + header.size);
+  std::memcpy (buffer, &header, sizeof (header));
+  if (m_stripPackets)
+    {
+      p->CopyData (buffer + sizeof (header), header.size);
+    }
+  else
+    {
+      p->Serialize (buffer + sizeof (header), header.size);
+    }
+#else
+  NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+SentBuffer*
+GrantedTimeWindowMpiInterface::GetFreeBuffer ()
+{
+  if (m_freeTx.empty ())
+    {
+      return new SentBuffer ();
+    }
+  SentBuffer* buffer = m_freeTx.front ();
+  m_freeTx.pop_front ();
+  return buffer;
+}
+
+void
+GrantedTimeWindowMpiInterface::FlushSendBuffers ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
 
-  MPI_Isend (reinterpret_cast<void *> (i->GetBuffer ()), serializedSize + 16, MPI_CHAR, nodeSysId,
-             0, MPI_COMM_WORLD, (i->GetRequest ()));
-  m_txCount++;
+#ifdef NS3_MPI
+  for (uint32_t rank = 0; rank < m_sendBuffers.size (); ++rank)
+    {
+      SentBuffer* buffer = m_sendBuffers[rank];
+      if (buffer == 0 || buffer->GetSize () == 0)
+        {
+          continue;
+        }
+      MPI_Isend (reinterpret_cast<void *> (buffer->GetBuffer ()), buffer->GetSize (), MPI_CHAR, rank,
+                 0, MPI_COMM_WORLD, buffer->GetRequest ());
+      m_pendingTx.push_back (buffer);
+      m_sendBuffers[rank] = 0;
+      m_txCount++;
+    }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
 #endif
@@ -228,58 +309,71 @@ GrantedTimeWindowMpiInterface::ReceiveMessages ()
   NS_LOG_FUNCTION_NOARGS ();
 
 #ifdef NS3_MPI
-  // Poll the non-block reads to see if data arrived
+  // Poll for arrived messages
   while (true)
     {
       int flag = 0;
-      int index = 0;
       MPI_Status status;
 
-      MPI_Testany (MpiInterface::GetSize (), m_requests, &index, &flag, &status);
+      MPI_Iprobe (MPI_ANY_SOURCE, 0, MPI_COMM_WORLD, &flag, &status);
       if (!flag)
         {
           break;        // No more messages
         }
       int count;
       MPI_Get_count (&status, MPI_CHAR, &count);
+      if (m_rxBuffer.size () < static_cast<uint32_t> (count))
+        {
+          m_rxBuffer.resize (count);
+        }
+      MPI_Recv (&m_rxBuffer[0], count, MPI_CHAR, status.MPI_SOURCE, 0,
+                MPI_COMM_WORLD, MPI_STATUS_IGNORE);
       m_rxCount++; // Count this receive
 
-      // Get the meta data first
-      uint64_t* pTime = reinterpret_cast<uint64_t *> (m_pRxBuffers[index]);
-      uint64_t time = *pTime++;
-      uint32_t* pData = reinterpret_cast<uint32_t *> (pTime);
-      uint32_t node = *pData++;
-      uint32_t dev  = *pData++;
-
-      Time rxTime (time);
-
-      count -= sizeof (time) + sizeof (node) + sizeof (dev);
-
-      Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (pData), count, true);
-
-      // Find the correct node/device to schedule receive event
-      Ptr<Node> pNode = NodeList::GetNode (node);
-      Ptr<MpiReceiver> pMpiRec = 0;
-      uint32_t nDevices = pNode->GetNDevices ();
-      for (uint32_t i = 0; i < nDevices; ++i)
+      // Schedule the receive event of each packet of the message
+      uint8_t* pData = &m_rxBuffer[0];
+      uint8_t* pEnd = pData + count;
+      while (pData < pEnd)
         {
-          Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
-          if (pThisDev->GetIfIndex () == dev)
+          PacketRecordHeader header;
+          NS_ASSERT (pData + sizeof (header) <= pEnd);
+          std::memcpy (&header, pData, sizeof (header));
+          pData += sizeof (header);
+          NS_ASSERT (pData + header.size <= pEnd);
+
+          Ptr<Packet> p;
+          if (header.format == 1)
             {
-              pMpiRec = pThisDev->GetObject<MpiReceiver> ();
-              break;
+              p = Create<Packet> (pData, header.size);
             }
-        }
+          else
+            {
+              p = Create<Packet> (pData, header.size, true);
+            }
+          pData += header.size;
 
-      NS_ASSERT (pNode && pMpiRec);
+          Time rxTime (header.time);
 
-      // Schedule the rx event
-      Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
-                                      &MpiReceiver::Receive, pMpiRec, p);
+          // Find the correct node/device to schedule receive event
+          Ptr<Node> pNode = NodeList::GetNode (header.node);
+          Ptr<MpiReceiver> pMpiRec = 0;
+          uint32_t nDevices = pNode->GetNDevices ();
+          for (uint32_t i = 0; i < nDevices; ++i)
+            {
+              Ptr<NetDevice> pThisDev = pNode->GetDevice (i);
+              if (pThisDev->GetIfIndex () == header.dev)
+                {
+                  pMpiRec = pThisDev->GetObject<MpiReceiver> ();
+                  break;
+                }
+            }
+
+          NS_ASSERT (pNode && pMpiRec);
 
-      // Re-queue the next read
-      MPI_Irecv (m_pRxBuffers[index], MAX_MPI_MSG_SIZE, MPI_CHAR, MPI_ANY_SOURCE, 0,
-                 MPI_COMM_WORLD, &m_requests[index]);
+          // Schedule the rx event
+          Simulator::ScheduleWithContext (pNode->GetId (), rxTime - Simulator::Now (),
+                                          &MpiReceiver::Receive, pMpiRec, p);
+        }
     }
 #else
   NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
@@ -292,16 +386,18 @@ GrantedTimeWindowMpiInterface::TestSendComplete ()
   NS_LOG_FUNCTION_NOARGS ();
 
 #ifdef NS3_MPI
-  std::list<SentBuffer>::iterator i = m_pendingTx.begin ();
+  std::list<SentBuffer*>::iterator i = m_pendingTx.begin ();
   while (i != m_pendingTx.end ())
     {
       MPI_Status status;
       int flag = 0;
-      MPI_Test (i->GetRequest (), &flag, &status);
-      std::list<SentBuffer>::iterator current = i; // Save current for erasing
+      MPI_Test ((*i)->GetRequest (), &flag, &status);
+      std::list<SentBuffer*>::iterator current = i; // Save current for erasing
       i++;                                    // Advance to next
       if (flag)
-        { // This message is complete
+        { // This message is complete, keep its buffer for reuse
+          (*current)->Clear ();
+          m_freeTx.push_back (*current);
           m_pendingTx.erase (current);
         }
     }
@@ -25,6 +25,7 @@
 
 #include <stdint.h>
 #include <list>
+#include <vector>
 
 #include "ns3/nstime.h"
 #include "ns3/buffer.h"
@@ -51,7 +52,9 @@ const uint32_t MAX_MPI_MSG_SIZE = 2000;
  * \brief Tracks non-blocking sends
  *
  * This class is used to keep track of the asynchronous non-blocking
- * sends that have been posted.
+ * sends that have been posted.  Each buffer aggregates all the packets
+ * sent to one rank during a time window; it keeps its storage once the
+ * send completed, to be reused for a later window.
  */
 class SentBuffer
 {
@@ -64,16 +67,25 @@ public:
    */
   uint8_t* GetBuffer ();
   /**
-   * \param buffer pointer to sent buffer
+   * \return the number of bytes in the buffer
    */
-  void SetBuffer (uint8_t* buffer);
+  uint32_t GetSize ();
+  /**
+   * \param size the number of bytes to append
+   * \return pointer to the appended bytes, valid until the next call
+   */
+  uint8_t* Append (uint32_t size);
+  /**
+   * Empty the buffer, keeping its storage
+   */
+  void Clear ();
   /**
    * \return MPI request
    */
   MPI_Request* GetRequest ();
 
 private:
-  uint8_t* m_buffer;
+  std::vector<uint8_t> m_buffer;
   MPI_Request m_request;
 };
 
@@ -128,9 +140,15 @@ public:
    * \param node destination node
    * \param dev destination device
    *
-   * Serialize and send a packet to the specified node and net device
+   * Serialize a packet for the specified node and net device.  The
+   * packet is appended to the buffer of the rank of the node, sent by
+   * the next call to FlushSendBuffers.
    */
   virtual void SendPacket (Ptr<Packet> p, const Time &rxTime, uint32_t node, uint32_t dev);
+  /**
+   * Send the packets buffered for each rank, one message per rank
+   */
+  static void FlushSendBuffers ();
   /**
    * Check for received messages complete
    */
@@ -140,11 +158,11 @@ public:
    */
   static void TestSendComplete ();
   /**
-   * \return received count in packets
+   * \return received count in messages
    */
   static uint32_t GetRxCount ();
   /**
-   * \return transmitted count in packets
+   * \return transmitted count in messages
    */
   static uint32_t GetTxCount ();
 
@@ -152,22 +170,33 @@ private:
   static uint32_t m_sid;
   static uint32_t m_size;
 
-  // Total packets received
+  /**
+   * \return an empty send buffer, reusing a completed one if possible
+   */
+  static SentBuffer* GetFreeBuffer ();
+
+  // Total messages received
   static uint32_t m_rxCount;
 
-  // Total packets sent
+  // Total messages sent
   static uint32_t m_txCount;
   static bool     m_initialized;
   static bool     m_enabled;
 
-  // Pending non-blocking receives
-  static MPI_Request* m_requests;
+  // Send only the packet bytes, without metadata, tags and nix vector
+  static bool     m_stripPackets;
 
-  // Data buffers for non-blocking reads
-  static char**   m_pRxBuffers;
+  // Data buffer for the received messages
+  static std::vector<uint8_t> m_rxBuffer;
+
+  // Packets buffered for each rank, not sent yet
+  static std::vector<SentBuffer*> m_sendBuffers;
 
   // List of pending non-blocking sends
-  static std::list<SentBuffer> m_pendingTx;
+  static std::list<SentBuffer*> m_pendingTx;
+
+  // Buffers of the completed sends, ready for reuse
+  static std::list<SentBuffer*> m_freeTx;
 };
 
 } // namespace ns3
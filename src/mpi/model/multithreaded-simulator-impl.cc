@@ -0,0 +1,773 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/core-config.h"
+#include "ns3/simulator.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/nstime.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
+
+#include <algorithm>
+#include <thread>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/** The time which never comes: no event, or no stop. */
+const uint64_t INFINITE_TS = 0x7fffffffffffffffLL;
+
+/** The partition run by the calling thread, if any. */
+thread_local void *g_partition = 0;
+
+/** The number of instances of MultithreadedSimulatorImpl. */
+std::atomic<uint32_t> g_instances (0);
+
+} // anonymous namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxLookAhead",
+                   "Upper bound of the time window in which the partitions "
+                   "run in parallel; zero to derive it from the channels "
+                   "between partitions only.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_maxLookAhead),
+                   MakeTimeChecker (Seconds (0)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_running (false),
+    m_lookAhead (INFINITE_TS),
+    m_uidStride (1),
+    m_barrierCount (0),
+    m_barrierGeneration (0),
+    m_nextWorker (0)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *partition = new Partition;
+  partition->systemId = 0;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  partition->uid = 4;
+  // before ::Run is entered, the m_currentUid will be zero
+  partition->currentUid = 0;
+  partition->currentTs = 0;
+  partition->currentContext = Simulator::NO_CONTEXT;
+  partition->eventCount = 0;
+  partition->unscheduledEvents = 0;
+  partition->stopTs = INFINITE_TS;
+  partition->windowEnd = 0;
+  partition->sequence = 0;
+  partition->nextTs = INFINITE_TS;
+  partition->publishedStopTs = INFINITE_TS;
+  partition->inbox = 0;
+  m_partitions.push_back (partition);
+  g_instances++;
+  LogLock::Enable ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  g_instances--;
+  LogLock::Disable ();
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      delete *i;
+    }
+  m_partitions.clear ();
+}
+
+bool
+MultithreadedSimulatorImpl::IsEnabled (void)
+{
+  return g_instances.load (std::memory_order_relaxed) != 0;
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      if (partition->events == 0)
+        {
+          continue;
+        }
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      partition->events = 0;
+    }
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  NS_ASSERT_MSG (!m_running, "Can't change the scheduler while running");
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (partition->events != 0)
+        {
+          while (!partition->events->IsEmpty ())
+            {
+              Scheduler::Event next = partition->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      partition->events = scheduler;
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsEarlier (const EventWithContext *a, const EventWithContext *b)
+{
+  if (a->timestamp != b->timestamp)
+    {
+      return a->timestamp < b->timestamp;
+    }
+  if (a->source != b->source)
+    {
+      return a->source < b->source;
+    }
+  return a->sequence < b->sequence;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (void) const
+{
+  if (!m_running)
+    {
+      return m_partitions[0];
+    }
+  NS_ABORT_MSG_IF (g_partition == 0, "MultithreadedSimulatorImpl: thread-unsafe invocation");
+  return static_cast<Partition *> (g_partition);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (!m_running || context >= m_contextPartition.size ())
+    {
+      return m_partitions[0];
+    }
+  return m_partitions[m_contextPartition[context]];
+}
+
+Scheduler::Event
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid += m_uidStride;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return ev;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessInbox (Partition *partition)
+{
+  EventWithContext *head = partition->inbox.exchange (0, std::memory_order_acquire);
+  if (head == 0)
+    {
+      return;
+    }
+  // The order of the pushes depends on the thread scheduling: sort the
+  // events to assign their uids deterministically.
+  while (head != 0)
+    {
+      partition->batch.push_back (head);
+      head = head->next;
+    }
+  std::sort (partition->batch.begin (), partition->batch.end (), &MultithreadedSimulatorImpl::IsEarlier);
+  for (std::vector<EventWithContext *>::iterator i = partition->batch.begin (); i != partition->batch.end (); ++i)
+    {
+      EventWithContext *event = *i;
+      Insert (partition, event->timestamp, event->context, event->event);
+      delete event;
+    }
+  partition->batch.clear ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+  partition->eventCount++;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  uint32_t size = m_partitions.size ();
+  if (size == 1)
+    {
+      return;
+    }
+  uint32_t generation = m_barrierGeneration.load ();
+  if (m_barrierCount.fetch_add (1) + 1 == size)
+    {
+      m_barrierCount.store (0);
+      m_barrierGeneration.fetch_add (1);
+    }
+  else
+    {
+      while (m_barrierGeneration.load () == generation)
+        {
+          std::this_thread::yield ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunPartition (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  Partition *partition = m_partitions[index];
+  g_partition = partition;
+
+  while (true)
+    {
+      // Publish the next event time of this partition.  The events sent
+      // during the previous window were all pushed before the barrier
+      // which ended it.
+      ProcessInbox (partition);
+      partition->nextTs = partition->events->IsEmpty () ?
+        INFINITE_TS : partition->events->PeekNext ().key.m_ts;
+      partition->publishedStopTs = partition->stopTs;
+      Barrier ();
+
+      // Every partition computes the same window from the published
+      // values, which are not written again before the next barrier.
+      uint64_t next = INFINITE_TS;
+      uint64_t stop = INFINITE_TS;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+        {
+          next = std::min (next, (*i)->nextTs);
+          stop = std::min (stop, (*i)->publishedStopTs);
+        }
+      if (next == INFINITE_TS || next >= stop)
+        {
+          break;
+        }
+      partition->windowEnd = (INFINITE_TS - next > m_lookAhead) ? next + m_lookAhead : INFINITE_TS;
+
+      // No other partition can send an event earlier than the end of
+      // the window.
+      while (!partition->events->IsEmpty ())
+        {
+          uint64_t limit = std::min (std::min (partition->windowEnd, stop), partition->stopTs);
+          if (partition->events->PeekNext ().key.m_ts >= limit)
+            {
+              break;
+            }
+          ProcessOneEvent (partition);
+        }
+      Barrier ();
+    }
+
+  g_partition = 0;
+}
+
+void
+MultithreadedSimulatorImpl::RunWorker (void)
+{
+  RunPartition (m_nextWorker.fetch_add (1));
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_lookAhead = INFINITE_TS;
+  if (m_maxLookAhead.IsStrictlyPositive ())
+    {
+      m_lookAhead = m_maxLookAhead.GetTimeStep ();
+    }
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> localNetDevice = (*node)->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (std::size_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              Ptr<Node> remoteNode = channel->GetDevice (j)->GetNode ();
+              if (remoteNode->GetSystemId () == (*node)->GetSystemId ())
+                {
+                  continue;
+                }
+              // only point-to-point channels have no state shared by
+              // the devices of both ends
+              NS_ABORT_MSG_UNLESS (localNetDevice->IsPointToPoint (),
+                                   "Channel " << channel->GetInstanceTypeId ().GetName () <<
+                                   " can't connect nodes of different system ids");
+              TimeValue delay;
+              channel->GetAttribute ("Delay", delay);
+              NS_ABORT_MSG_UNLESS (delay.Get ().IsStrictlyPositive (),
+                                   "Channels between system ids need a positive delay");
+              m_lookAhead = std::min<uint64_t> (m_lookAhead, delay.Get ().GetTimeStep ());
+            }
+        }
+    }
+  NS_LOG_INFO ("lookahead " << TimeStep (m_lookAhead));
+}
+
+void
+MultithreadedSimulatorImpl::SetupPartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *first = m_partitions[0];
+
+  m_contextPartition.clear ();
+  uint32_t size = 1;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      uint32_t systemId = (*node)->GetSystemId ();
+      m_contextPartition.push_back (systemId);
+      size = std::max (size, systemId + 1);
+    }
+
+  while (m_partitions.size () < size)
+    {
+      Partition *partition = new Partition;
+      partition->systemId = m_partitions.size ();
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+      partition->eventCount = 0;
+      partition->unscheduledEvents = 0;
+      partition->inbox = 0;
+      m_partitions.push_back (partition);
+    }
+  // The partitions allocate interleaved uids, from the next uid of the
+  // first partition, so that the uids remain unique when the events are
+  // merged back into the first partition, and increase in each partition.
+  m_uidStride = m_partitions.size ();
+  for (std::vector<Partition *>::iterator i = m_partitions.begin () + 1; i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      // Start from the state of the first partition.
+      partition->uid = first->uid + partition->systemId;
+      partition->currentUid = first->currentUid;
+      partition->currentTs = first->currentTs;
+      partition->currentContext = Simulator::NO_CONTEXT;
+      partition->stopTs = first->stopTs;
+      partition->windowEnd = 0;
+      partition->sequence = 0;
+    }
+  first->windowEnd = 0;
+  first->sequence = 0;
+
+  // Give each partition the events of its nodes.
+  std::vector<Scheduler::Event> events;
+  while (!first->events->IsEmpty ())
+    {
+      events.push_back (first->events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin (); i != events.end (); ++i)
+    {
+      uint32_t context = i->key.m_context;
+      Partition *partition = context < m_contextPartition.size () ?
+        m_partitions[m_contextPartition[context]] : first;
+      partition->events->Insert (*i);
+      if (partition != first)
+        {
+          first->unscheduledEvents--;
+          partition->unscheduledEvents++;
+        }
+    }
+
+  CalculateLookAhead ();
+}
+
+void
+MultithreadedSimulatorImpl::MergePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  Partition *first = m_partitions[0];
+
+  uint64_t now = first->currentTs;
+  uint32_t nowUid = first->currentUid;
+  uint64_t stop = first->publishedStopTs;
+  for (std::vector<Partition *>::iterator i = m_partitions.begin () + 1; i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      NS_ASSERT (partition->inbox.load () == 0);
+      while (!partition->events->IsEmpty ())
+        {
+          first->events->Insert (partition->events->RemoveNext ());
+        }
+      first->unscheduledEvents += partition->unscheduledEvents;
+      partition->unscheduledEvents = 0;
+      // Past all the uids allocated by the partitions
+      first->uid = std::max (first->uid, partition->uid);
+      if (partition->currentTs > now)
+        {
+          now = partition->currentTs;
+          nowUid = partition->currentUid;
+        }
+      stop = std::min (stop, partition->publishedStopTs);
+      partition->stopTs = INFINITE_TS;
+    }
+
+  if (stop != INFINITE_TS)
+    {
+      // Like with DefaultSimulatorImpl, the simulation ends at the
+      // time of the stop, before the events of that time.
+      first->currentTs = stop;
+      first->currentUid = 0;
+    }
+  else
+    {
+      // All the events ran.
+      first->currentTs = now;
+      first->currentUid = nowUid;
+    }
+  first->currentContext = Simulator::NO_CONTEXT;
+  first->stopTs = INFINITE_TS;
+  m_uidStride = 1;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  SetupPartitions ();
+  m_running = true;
+  m_barrierCount = 0;
+  m_barrierGeneration = 0;
+  m_nextWorker = 1;
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::RunWorker, this)));
+      threads.back ()->Start ();
+    }
+  RunPartition (0);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+#else
+  NS_ABORT_MSG_IF (m_partitions.size () > 1,
+                   "Can't run several partitions without threading support");
+  RunPartition (0);
+#endif
+
+  m_running = false;
+  MergePartitions ();
+
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!m_partitions[0]->events->IsEmpty () || m_partitions[0]->unscheduledEvents == 0);
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  Partition *partition = GetPartition ();
+  return partition->events->IsEmpty () || partition->stopTs <= partition->currentTs;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return GetPartition ()->systemId;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_running)
+    {
+      Partition *partition = GetPartition ();
+      partition->stopTs = partition->currentTs;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Partition *partition = GetPartition ();
+  partition->stopTs = std::min (partition->stopTs, partition->currentTs + delay.GetTimeStep ());
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+  Partition *partition = GetPartition ();
+  uint64_t ts = partition->currentTs + delay.GetTimeStep ();
+  Scheduler::Event ev = Insert (partition, ts, partition->currentContext, event);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+
+  Partition *partition = GetPartition ();
+  Partition *destination = GetPartition (context);
+  uint64_t ts = partition->currentTs + delay.GetTimeStep ();
+  if (destination == partition)
+    {
+      Insert (partition, ts, context, event);
+      return;
+    }
+
+  NS_ABORT_MSG_IF (ts < partition->windowEnd,
+                   "Event for context " << context << " in system id " << destination->systemId <<
+                   " scheduled within the lookahead of system id " << partition->systemId);
+  EventWithContext *ev = new EventWithContext;
+  ev->context = context;
+  ev->timestamp = ts;
+  ev->source = partition->systemId;
+  ev->sequence = partition->sequence++;
+  ev->event = event;
+  ev->next = destination->inbox.load (std::memory_order_relaxed);
+  while (!destination->inbox.compare_exchange_weak (ev->next, ev,
+                                                    std::memory_order_release,
+                                                    std::memory_order_relaxed))
+    {
+      // ev->next was updated with the current head; try again
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+
+  Partition *partition = GetPartition ();
+  Scheduler::Event ev = Insert (partition, partition->currentTs, partition->currentContext, event);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  NS_ASSERT_MSG (!m_running, "Can't schedule destroy events while running");
+
+  Partition *partition = GetPartition ();
+  EventId id (Ptr<EventImpl> (event, false), partition->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  partition->uid++;
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetPartition ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetPartition ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetPartition (id.GetContext ());
+  NS_ABORT_MSG_IF (partition != GetPartition (),
+                   "Can't remove an event of another system id");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *partition = GetPartition (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < partition->currentTs
+      || (id.GetTs () == partition->currentTs
+          && id.GetUid () <= partition->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (INFINITE_TS);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetPartition ()->currentContext;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t eventCount = 0;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin (); i != m_partitions.end (); ++i)
+    {
+      eventCount += (*i)->eventCount;
+    }
+  return eventCount;
+}
+
+} // namespace ns3
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ * \ingroup mpi
+ *
+ * \brief Conservative parallel simulator implementation using threads
+ *
+ * The nodes are partitioned by system id, like with
+ * DistributedSimulatorImpl, but all the partitions run in the same
+ * process, each in its own thread, and share the same address space.
+ * Each partition has its own event queue and clock.
+ *
+ * The partitions advance in windows of simulation time, separated by
+ * barriers.  The width of a window is the lookahead: the smallest delay
+ * of the point-to-point channels which connect nodes of different
+ * partitions, optionally capped by the MaxLookAhead attribute.  Within a
+ * window, events scheduled with Simulator::ScheduleWithContext for a
+ * node of another partition are pushed on a lock-free queue of that
+ * partition, by reference, and inserted in its event queue at the next
+ * window, in a deterministic order.
+ *
+ * Objects reachable from such an event must not be shared with the
+ * sending partition, since reference counts are not atomic.  When
+ * IsEnabled() is true, PointToPointChannel hands over a private copy of
+ * the packets it sends to another partition, and the event refers to
+ * the receiving device through the channel only.  Channels with shared
+ * state, such as CsmaChannel or wireless channels, must not span
+ * partitions.
+ *
+ * A Simulator::Stop scheduled before Simulator::Run applies to all the
+ * partitions; a Simulator::Stop called during the simulation applies to
+ * the other partitions at the end of the current window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  /**
+   * Check whether an instance of this simulator exists, so that the
+   * models can avoid sharing objects between system ids.
+   * \returns \c true if a MultithreadedSimulatorImpl exists.
+   */
+  static bool IsEnabled (void);
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /**
+   * An event sent by a partition to another one.
+   *
+   * Events are pushed on the lock-free intrusive stack of the
+   * destination partition, through the \c next field.
+   */
+  struct EventWithContext
+  {
+    uint32_t context;               //!< The event context.
+    uint64_t timestamp;             //!< The absolute event timestamp.
+    uint32_t source;                //!< The index of the sending partition.
+    uint32_t sequence;              //!< The send order in the sending partition.
+    EventImpl *event;               //!< The event implementation.
+    struct EventWithContext *next;  //!< The event pushed before this one.
+  };
+
+  /** The state of one partition: one system id, run by one thread. */
+  struct Partition
+  {
+    uint32_t systemId;              //!< The system id of this partition.
+    Ptr<Scheduler> events;          //!< The event priority queue.
+    uint32_t uid;                   //!< Next event unique id.
+    uint32_t currentUid;            //!< Unique id of the current event.
+    uint64_t currentTs;             //!< Timestamp of the current event.
+    uint32_t currentContext;        //!< Execution context of the current event.
+    uint64_t eventCount;            //!< The event count.
+    int unscheduledEvents;          //!< Events inserted but not yet run.
+    uint64_t stopTs;                //!< Stop time requested in this partition.
+    uint64_t windowEnd;             //!< End (excluded) of the current window.
+    uint32_t sequence;              //!< Counter of the events sent to other partitions.
+    uint64_t nextTs;                //!< Next event time, published at the barrier.
+    uint64_t publishedStopTs;       //!< Stop time, published at the barrier.
+    /** The events sent by other partitions, most recently pushed first. */
+    std::atomic<struct EventWithContext *> inbox;
+    /** Buffer used to sort the events taken from the inbox. */
+    std::vector<struct EventWithContext *> batch;
+  };
+
+  /**
+   * Compare two events sent by other partitions, to insert them in a
+   * deterministic order.
+   * \param [in] a The first event.
+   * \param [in] b The second event.
+   * \returns \c true if \c a must be inserted before \c b
+   */
+  static bool IsEarlier (const EventWithContext *a, const EventWithContext *b);
+  /**
+   * Get the partition of the calling thread.
+   * \returns The partition.
+   */
+  Partition * GetPartition (void) const;
+  /**
+   * Get the partition which runs the events of a context.
+   * \param [in] context The context.
+   * \returns The partition.
+   */
+  Partition * GetPartition (uint32_t context) const;
+  /**
+   * Insert an event in the event queue of a partition.
+   * \param [in] partition The partition.
+   * \param [in] ts The event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \returns The event, with its uid.
+   */
+  Scheduler::Event Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Move the events sent by other partitions into the event queue.
+   * \param [in] partition The receiving partition.
+   */
+  void ProcessInbox (Partition *partition);
+  /**
+   * Run the next event of a partition.
+   * \param [in] partition The partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Run the events of a partition, window by window.
+   * \param [in] index The index of the partition.
+   */
+  void RunPartition (uint32_t index);
+  /** Thread entry point for the partitions other than the first one. */
+  void RunWorker (void);
+  /** Wait until all the partitions reached the barrier. */
+  void Barrier (void);
+  /** Set up the partitions and the lookahead at the start of Run. */
+  void SetupPartitions (void);
+  /** Merge the partitions back into the first one at the end of Run. */
+  void MergePartitions (void);
+  /** Compute the lookahead from the channels between partitions. */
+  void CalculateLookAhead (void);
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** The factory of the event queues. */
+  ObjectFactory m_schedulerFactory;
+  /**
+   * The partitions.  Outside of Run, all the events are held by the
+   * first partition.
+   */
+  std::vector<Partition *> m_partitions;
+  /** The index of the partition of each context (node id). */
+  std::vector<uint32_t> m_contextPartition;
+  /** True while the partitions are running. */
+  bool m_running;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+  /**
+   * The difference between the successive uids allocated by a
+   * partition: the number of partitions while running, else 1.
+   */
+  uint32_t m_uidStride;
+  /** The upper bound of the lookahead set by attribute. */
+  Time m_maxLookAhead;
+  /** The number of partitions which reached the barrier. */
+  std::atomic<uint32_t> m_barrierCount;
+  /** The number of times all the partitions reached the barrier. */
+  std::atomic<uint32_t> m_barrierGeneration;
+  /** The index of the next partition to be run by a worker thread. */
+  std::atomic<uint32_t> m_nextWorker;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * Check that MultithreadedSimulatorImpl runs the same events as
+ * DefaultSimulatorImpl, with tokens hopping between nodes of different
+ * system ids.
+ */
+class MultithreadedSimulatorTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * Run the scenario with a simulator implementation.
+   * \param simulatorType The simulator implementation.
+   * \param checkSystemId Whether to check the system id of the events.
+   */
+  void RunScenario (std::string simulatorType, bool checkSystemId);
+  /**
+   * Receive a token.
+   * \param node The receiving node.
+   * \param token The token.
+   * \param hop The number of hops of the token so far.
+   */
+  void Receive (uint32_t node, uint32_t token, uint32_t hop);
+  /**
+   * Send a token to the next node.
+   * \param node The sending node.
+   * \param token The token.
+   * \param hop The number of hops of the token so far.
+   */
+  void Forward (uint32_t node, uint32_t token, uint32_t hop);
+
+  /** Number of nodes. */
+  static const uint32_t NODES = 8;
+  /** Number of system ids. */
+  static const uint32_t SYSTEMS = 4;
+  /** Number of hops of each token. */
+  static const uint32_t HOPS = 200;
+
+  /** The (time, token and hop) received by each node. */
+  std::vector<std::vector<std::pair<int64_t, uint32_t> > > m_log;
+  /** Whether the system id of each event is expected to be the one of its node. */
+  bool m_checkSystemId;
+  /**
+   * Whether each node saw the wrong system id; not a std::vector<bool>,
+   * whose elements share bytes, since the nodes are run by several threads.
+   */
+  std::vector<char> m_wrongSystemId;
+};
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase ()
+  : TestCase ("Check that MultithreadedSimulatorImpl runs the events of DefaultSimulatorImpl")
+{
+}
+
+void
+MultithreadedSimulatorTestCase::Receive (uint32_t node, uint32_t token, uint32_t hop)
+{
+  m_log[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), token * 1000 + hop));
+  if (m_checkSystemId && Simulator::GetSystemId () != node % SYSTEMS)
+    {
+      m_wrongSystemId[node] = 1;
+    }
+  if (hop < HOPS)
+    {
+      Simulator::Schedule (MicroSeconds (3), &MultithreadedSimulatorTestCase::Forward, this, node, token, hop);
+    }
+}
+
+void
+MultithreadedSimulatorTestCase::Forward (uint32_t node, uint32_t token, uint32_t hop)
+{
+  uint32_t next = (node * 3 + 1) % NODES;
+  Time delay = MilliSeconds (1) + MicroSeconds ((node * 7 + hop * 13) % 10);
+  Simulator::ScheduleWithContext (next, delay, &MultithreadedSimulatorTestCase::Receive, this, next, token, hop + 1);
+}
+
+void
+MultithreadedSimulatorTestCase::RunScenario (std::string simulatorType, bool checkSystemId)
+{
+  m_checkSystemId = checkSystemId;
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  m_log.assign (NODES, std::vector<std::pair<int64_t, uint32_t> > ());
+  m_wrongSystemId.assign (NODES, 0);
+
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      CreateObject<Node> (i % SYSTEMS);
+    }
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i), &MultithreadedSimulatorTestCase::Receive, this, i, i, 0);
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), Seconds (1), "Wrong time at the end of " << simulatorType);
+  Simulator::Destroy ();
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun (void)
+{
+  RunScenario ("ns3::DefaultSimulatorImpl", false);
+  std::vector<std::vector<std::pair<int64_t, uint32_t> > > expected = m_log;
+
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxLookAhead", TimeValue (MilliSeconds (1)));
+  RunScenario ("ns3::MultithreadedSimulatorImpl", true);
+
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      // Only the order of simultaneous events may differ
+      std::sort (expected[i].begin (), expected[i].end ());
+      std::sort (m_log[i].begin (), m_log[i].end ());
+      NS_TEST_EXPECT_MSG_EQ ((m_log[i] == expected[i]), true, "Different events at node " << i);
+      NS_TEST_EXPECT_MSG_EQ ((m_wrongSystemId[i] != 0), false, "Wrong system id at node " << i);
+      total += m_log[i].size ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (total, NODES * (HOPS + 1), "Wrong number of events");
+}
+
+void
+MultithreadedSimulatorTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::MultithreadedSimulatorImpl::MaxLookAhead", TimeValue (Seconds (0)));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * Check that the events left in several partitions at a stop, for the
+ * same time, remain distinct events when the simulation is resumed.
+ */
+class MultithreadedSimulatorResumeTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   * \param schedulerType The scheduler.
+   */
+  MultithreadedSimulatorResumeTestCase (std::string schedulerType);
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /**
+   * Schedule the event of a node after the stop.
+   * \param node The node.
+   */
+  void ScheduleLater (uint32_t node);
+  /**
+   * Record that the event of a node ran.
+   * \param node The node.
+   */
+  void Run (uint32_t node);
+
+  /** Number of nodes, one per system id. */
+  static const uint32_t NODES = 4;
+
+  /** The scheduler. */
+  std::string m_schedulerType;
+  /** The event of each node after the stop. */
+  std::vector<EventId> m_events;
+  /** Whether the event of each node ran. */
+  std::vector<char> m_ran;
+};
+
+MultithreadedSimulatorResumeTestCase::MultithreadedSimulatorResumeTestCase (std::string schedulerType)
+  : TestCase ("Check that MultithreadedSimulatorImpl can resume with the events of several system ids, with " + schedulerType),
+    m_schedulerType (schedulerType)
+{
+}
+
+void
+MultithreadedSimulatorResumeTestCase::ScheduleLater (uint32_t node)
+{
+  // The partitions each schedule one event, for the same time
+  m_events[node] = Simulator::Schedule (Seconds (1), &MultithreadedSimulatorResumeTestCase::Run, this, node);
+}
+
+void
+MultithreadedSimulatorResumeTestCase::Run (uint32_t node)
+{
+  m_ran[node] = 1;
+}
+
+void
+MultithreadedSimulatorResumeTestCase::DoRun (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::MultithreadedSimulatorImpl"));
+  Config::SetGlobal ("SchedulerType", StringValue (m_schedulerType));
+  m_events.assign (NODES, EventId ());
+  m_ran.assign (NODES, 0);
+
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      CreateObject<Node> (i);
+      Simulator::ScheduleWithContext (i, MilliSeconds (500), &MultithreadedSimulatorResumeTestCase::ScheduleLater, this, i);
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_events[i].IsRunning (), true, "Event of node " << i << " not pending");
+    }
+  Simulator::Remove (m_events[1]);
+  Simulator::Cancel (m_events[2]);
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((m_ran[i] != 0), (i != 1 && i != 2), "Wrong event run for node " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (1500), "Wrong time at the end");
+  Simulator::Destroy ();
+}
+
+void
+MultithreadedSimulatorResumeTestCase::DoTeardown (void)
+{
+  Config::SetGlobal ("SchedulerType", StringValue ("ns3::MapScheduler"));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    AddTestCase (new MultithreadedSimulatorTestCase (), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorResumeTestCase ("ns3::MapScheduler"), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorResumeTestCase ("ns3::HeapScheduler"), TestCase::QUICK);
+    AddTestCase (new MultithreadedSimulatorResumeTestCase ("ns3::ListScheduler"), TestCase::QUICK);
+  }
+};
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/topology-partition-helper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * Two groups of nodes joined by short links, with a single long link
+ * between them, must be split along the long link.
+ */
+class TopologyPartitionLookAheadTestCase : public TestCase
+{
+public:
+  TopologyPartitionLookAheadTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+TopologyPartitionLookAheadTestCase::TopologyPartitionLookAheadTestCase ()
+  : TestCase ("Split two groups along the longest link")
+{
+}
+
+void
+TopologyPartitionLookAheadTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (8);
+  TopologyPartitionHelper partition;
+  partition.AddNodes (nodes);
+  // Nodes 0-3 and 4-7 are fully connected with 1 ms links
+  for (uint32_t g = 0; g < 8; g += 4)
+    {
+      for (uint32_t i = g; i < g + 4; ++i)
+        {
+          for (uint32_t j = i + 1; j < g + 4; ++j)
+            {
+              partition.AddLink (nodes.Get (i), nodes.Get (j), MilliSeconds (1));
+            }
+        }
+    }
+  partition.AddLink (nodes.Get (2), nodes.Get (5), MilliSeconds (10));
+  partition.Partition (2);
+
+  for (uint32_t i = 1; i < 4; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (partition.GetSystemId (nodes.Get (i)), partition.GetSystemId (nodes.Get (0)),
+                             "Node " << i << " not with node 0");
+      NS_TEST_EXPECT_MSG_EQ (partition.GetSystemId (nodes.Get (i + 4)), partition.GetSystemId (nodes.Get (4)),
+                             "Node " << i + 4 << " not with node 4");
+    }
+  NS_TEST_EXPECT_MSG_NE (partition.GetSystemId (nodes.Get (0)), partition.GetSystemId (nodes.Get (4)),
+                         "The groups are not split");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLookAhead (), MilliSeconds (10), "Wrong lookahead");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetCutWeight (), 1, "Wrong cut");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLoad (0), 4, "Unbalanced partition");
+
+  partition.Assign ();
+  for (uint32_t i = 0; i < 8; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (nodes.Get (i)->GetSystemId (), partition.GetSystemId (nodes.Get (i)),
+                             "System id of node " << i << " not assigned");
+    }
+}
+
+void
+TopologyPartitionLookAheadTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * A ring of nodes with equal delays must be split into balanced arcs.
+ */
+class TopologyPartitionRingTestCase : public TestCase
+{
+public:
+  TopologyPartitionRingTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+TopologyPartitionRingTestCase::TopologyPartitionRingTestCase ()
+  : TestCase ("Split a ring into balanced arcs")
+{
+}
+
+void
+TopologyPartitionRingTestCase::DoRun (void)
+{
+  const uint32_t nodeCount = 64;
+  const uint32_t systemCount = 4;
+  NodeContainer nodes;
+  nodes.Create (nodeCount);
+  TopologyPartitionHelper partition;
+  partition.SetImbalance (0);
+  // Add the links in a scrambled order
+  for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+      uint32_t a = (i * 37) % nodeCount;
+      partition.AddLink (nodes.Get (a), nodes.Get ((a + 1) % nodeCount), MilliSeconds (2));
+    }
+  partition.Partition (systemCount);
+
+  for (uint32_t r = 0; r < systemCount; ++r)
+    {
+      NS_TEST_EXPECT_MSG_EQ (partition.GetLoad (r), nodeCount / systemCount, "Unbalanced system id " << r);
+    }
+  NS_TEST_EXPECT_MSG_EQ (partition.GetCutWeight (), systemCount, "The arcs are not contiguous");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLookAhead (), MilliSeconds (2), "Wrong lookahead");
+}
+
+void
+TopologyPartitionRingTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * The links found from the channels of the devices: channels with more
+ * than two devices must not be cut.
+ */
+class TopologyPartitionChannelsTestCase : public TestCase
+{
+public:
+  TopologyPartitionChannelsTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+TopologyPartitionChannelsTestCase::TopologyPartitionChannelsTestCase ()
+  : TestCase ("Keep shared channels in a system id")
+{
+}
+
+void
+TopologyPartitionChannelsTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (6);
+  // Nodes 0, 2, 4 and nodes 1, 3, 5 share a channel
+  for (uint32_t g = 0; g < 2; ++g)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      for (uint32_t i = g; i < 6; i += 2)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetChannel (channel);
+          nodes.Get (i)->AddDevice (device);
+        }
+    }
+  TopologyPartitionHelper partition;
+  partition.AddChannels (nodes);
+  partition.AddLink (nodes.Get (0), nodes.Get (1), MicroSeconds (500));
+  partition.Partition (2);
+
+  NS_TEST_EXPECT_MSG_NE (partition.GetSystemId (nodes.Get (0)), partition.GetSystemId (nodes.Get (1)),
+                         "The channels are not split");
+  for (uint32_t i = 2; i < 6; ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (partition.GetSystemId (nodes.Get (i)), partition.GetSystemId (nodes.Get (i % 2)),
+                             "Channel of node " << i << " is cut");
+    }
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLookAhead (), MicroSeconds (500), "Wrong lookahead");
+}
+
+void
+TopologyPartitionChannelsTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * Only the point-to-point channels are cut: a simple channel between two
+ * devices has a "Delay" attribute too, but it cannot cross system ids.
+ */
+class TopologyPartitionSimpleChannelTestCase : public TestCase
+{
+public:
+  TopologyPartitionSimpleChannelTestCase ();
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+TopologyPartitionSimpleChannelTestCase::TopologyPartitionSimpleChannelTestCase ()
+  : TestCase ("Keep simple channels between two devices in a system id")
+{
+}
+
+void
+TopologyPartitionSimpleChannelTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  // Nodes 0, 1 and nodes 2, 3 share a channel with a long delay
+  for (uint32_t g = 0; g < 2; ++g)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+      for (uint32_t i = 2 * g; i < 2 * g + 2; ++i)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetChannel (channel);
+          nodes.Get (i)->AddDevice (device);
+        }
+    }
+  TopologyPartitionHelper partition;
+  partition.AddChannels (nodes);
+  partition.AddLink (nodes.Get (1), nodes.Get (2), MicroSeconds (100));
+  partition.Partition (2);
+
+  NS_TEST_EXPECT_MSG_EQ (partition.GetSystemId (nodes.Get (0)), partition.GetSystemId (nodes.Get (1)),
+                         "The channel of nodes 0 and 1 is cut");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetSystemId (nodes.Get (2)), partition.GetSystemId (nodes.Get (3)),
+                         "The channel of nodes 2 and 3 is cut");
+  NS_TEST_EXPECT_MSG_NE (partition.GetSystemId (nodes.Get (1)), partition.GetSystemId (nodes.Get (2)),
+                         "The link is not cut");
+  NS_TEST_EXPECT_MSG_EQ (partition.GetLookAhead (), MicroSeconds (100), "Wrong lookahead");
+}
+
+void
+TopologyPartitionSimpleChannelTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * TopologyPartitionHelper test suite.
+ */
+class TopologyPartitionTestSuite : public TestSuite
+{
+public:
+  TopologyPartitionTestSuite ()
+    : TestSuite ("topology-partition")
+  {
+    AddTestCase (new TopologyPartitionLookAheadTestCase (), TestCase::QUICK);
+    AddTestCase (new TopologyPartitionRingTestCase (), TestCase::QUICK);
+    AddTestCase (new TopologyPartitionChannelsTestCase (), TestCase::QUICK);
+    AddTestCase (new TopologyPartitionSimpleChannelTestCase (), TestCase::QUICK);
+  }
+};
+
+static TopologyPartitionTestSuite g_topologyPartitionTestSuite; //!< Static variable for test initialization
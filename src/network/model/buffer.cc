@@ -50,7 +50,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+thread_local uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -60,6 +60,7 @@ uint32_t Buffer::g_recommendedStart = 0;
  *  - initialized means that the free list exists and is valid
  *  - destroyed means that the static destructors of this compilation unit
  *    have run so, the free list has been cleared from its content
+ * Each thread has its own g_freeList, destroyed when the thread exits.
  * The key is that in destroyed state, we are careful not re-create it
  * which is a typical weakness of lazy evaluation schemes which use 
  * '0' as a special value to indicate both un-initialized and destroyed.
@@ -75,9 +76,9 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
-struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+thread_local uint32_t Buffer::g_maxSize = 0;
+thread_local Buffer::FreeList *Buffer::g_freeList = 0;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
@@ -123,6 +124,9 @@ Buffer::Create (uint32_t dataSize)
   if (IS_UNINITIALIZED (g_freeList))
     {
       g_freeList = new Buffer::FreeList ();
+      // the destructor of a thread_local is only registered once the
+      // variable is used in the thread
+      (void) &g_localStaticDestructor;
     }
   else if (IS_INITIALIZED (g_freeList))
     {
@@ -400,9 +404,23 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
-      m_end == m_zeroAreaEnd &&
-      m_end == m_data->m_dirtyEnd &&
+  if (m_data == o.m_data &&
+      m_end == o.m_start &&
+      m_zeroAreaStart == m_zeroAreaEnd &&
+      o.m_zeroAreaStart == o.m_zeroAreaEnd)
+    {
+      /**
+       * The two buffers are adjacent parts of the same data,
+       * e.g., two fragments of the same packet: without zero
+       * areas, offsets are offsets in the data, so the bytes
+       * of the other buffer are already in place.
+       */
+      m_end = o.m_end;
+      LOG_INTERNAL_STATE ("join ");
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (m_end == m_zeroAreaEnd &&
       o.m_start == o.m_zeroAreaStart &&
       o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
     {
@@ -411,25 +429,116 @@ Buffer::AddAtEnd (const Buffer &o)
        * we attempt to aggregate two buffers which contain
        * adjacent zero areas.
        */
+      uint32_t endData = o.m_end - o.m_zeroAreaEnd;
+      if (m_data->m_count != 1 || m_end != m_data->m_dirtyEnd)
+        {
+          /**
+           * Make a private copy of the bytes stored before the
+           * zero area, with room for the bytes stored after the
+           * zero area of the other buffer, and keep the zero area.
+           */
+          uint32_t dataStart = m_zeroAreaStart - m_start;
+          struct Buffer::Data *newData = Buffer::Create (dataStart + endData);
+          memcpy (newData->m_data, m_data->m_data + m_start, dataStart);
+          m_data->m_count--;
+          if (m_data->m_count == 0)
+            {
+              Buffer::Recycle (m_data);
+            }
+          m_data = newData;
+          m_zeroAreaEnd -= m_start;
+          m_zeroAreaStart = dataStart;
+          m_start = 0;
+          m_end = m_zeroAreaEnd;
+          m_data->m_dirtyStart = m_start;
+        }
       uint32_t zeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
       m_zeroAreaEnd += zeroSize;
       m_end = m_zeroAreaEnd;
       m_data->m_dirtyEnd = m_zeroAreaEnd;
-      uint32_t endData = o.m_end - o.m_zeroAreaEnd;
       AddAtEnd (endData);
       Buffer::Iterator dst = End ();
       dst.Prev (endData);
       Buffer::Iterator src = o.End ();
       src.Prev (endData);
       dst.Write (src, o.End ());
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  if (oZeroSize > zeroSize)
+    {
+      /**
+       * The other buffer has the larger zero area, e.g., a payload
+       * appended to headers or to a smaller payload: keep its zero
+       * area, and store our bytes before its own real bytes.
+       */
+      uint32_t size = GetSize ();
+      uint32_t dataStart = o.m_zeroAreaStart - o.m_start;
+      uint32_t dataEnd = o.m_end - o.m_zeroAreaEnd;
+      struct Buffer::Data *newData = Buffer::Create (size + dataStart + dataEnd);
+      CopyData (newData->m_data, size);
+      memcpy (newData->m_data + size, o.m_data->m_data + o.m_start, dataStart);
+      memcpy (newData->m_data + size + dataStart, o.m_data->m_data + o.m_zeroAreaStart, dataEnd);
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          Buffer::Recycle (m_data);
+        }
+      m_data = newData;
+      m_start = 0;
+      m_zeroAreaStart = size + dataStart;
+      m_zeroAreaEnd = m_zeroAreaStart + oZeroSize;
+      m_end = m_zeroAreaEnd + dataEnd;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+      LOG_INTERNAL_STATE ("join zero area ");
       NS_ASSERT (CheckInternalState ());
       return;
     }
 
-  *this = CreateFullCopy ();
-  AddAtEnd (o.GetSize ());
+  /**
+   * Keep our zero area, which is the larger one, and write the
+   * bytes of the other buffer after our bytes.
+   */
+  uint32_t size = o.GetSize ();
+  bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+  if (GetInternalEnd () + size > m_data->m_size || isDirty)
+    {
+      /**
+       * Move the data to a larger buffer.  If this buffer is not
+       * shared, it is likely being extended repeatedly, e.g., to
+       * reassemble fragments: reserve as many bytes again, so that
+       * appending buffers one by one takes linear time.
+       */
+      uint32_t internalSize = GetInternalSize ();
+      uint32_t newSize = internalSize + size;
+      if (m_data->m_count == 1)
+        {
+          newSize *= 2;
+        }
+      struct Buffer::Data *newData = Buffer::Create (newSize);
+      memcpy (newData->m_data, m_data->m_data + m_start, internalSize);
+      m_data->m_count--;
+      if (m_data->m_count == 0)
+        {
+          Buffer::Recycle (m_data);
+        }
+      m_data = newData;
+      m_zeroAreaStart -= m_start;
+      m_zeroAreaEnd -= m_start;
+      m_end -= m_start;
+      m_start = 0;
+      m_data->m_dirtyStart = m_start;
+      m_data->m_dirtyEnd = m_end;
+    }
+  AddAtEnd (size);
   Buffer::Iterator destStart = End ();
-  destStart.Prev (o.GetSize ());
+  destStart.Prev (size);
   destStart.Write (o.Begin (), o.End ());
   NS_ASSERT (CheckInternalState ());
 }
@@ -843,25 +952,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the written bytes are either all before or all after the zero area
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
   m_current += toCopy;
 }
@@ -65,10 +65,12 @@ namespace ns3 {
  * contains real data bytes in its BufferData instance but it also
  * contains "virtual zero data" which typically is used to represent
  * application-level payload. No memory is allocated to store the
- * zero bytes of application-level payload unless the user fragments
- * a Buffer: this application-level payload is kept track of with
- * a pair of integers which describe where in the buffer content
- * the "virtual zero area" starts and ends.
+ * zero bytes of application-level payload: this application-level
+ * payload is kept track of with a pair of integers which describe
+ * where in the buffer content the "virtual zero area" starts and ends.
+ * The zero area is kept by fragmentation, and by AddAtEnd (Buffer),
+ * which merges adjacent zero areas; when the two buffers have separate
+ * zero areas, only the smaller one is written as real bytes.
  *
  * \verbatim
  * ***: unused bytes
@@ -765,9 +767,9 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value.  Kept per thread, like the free list.
    */
-  static uint32_t g_recommendedStart;
+  static thread_local uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -798,9 +800,13 @@ private:
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
-  static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+  /*
+   * The free list is kept per thread, since the packets of the
+   * partitions of MultithreadedSimulatorImpl are handled concurrently.
+   */
+  static thread_local uint32_t g_maxSize; //!< Max observed data size
+  static thread_local FreeList *g_freeList; //!< Buffer data container
+  static thread_local struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
 
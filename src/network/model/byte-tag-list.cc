@@ -49,16 +49,26 @@ struct ByteTagListData {
 /**
  * \ingroup packet
  *
- * \brief Container class for struct ByteTagListData
+ * \brief Container class for struct ByteTagListData of a thread
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
+class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
   ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+};
+/**
+ * Container for struct ByteTagListData of each thread, since the packets
+ * of the partitions of MultithreadedSimulatorImpl are handled concurrently.
+ */
+static thread_local ByteTagListDataFreeList g_freeList;
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+/**
+ * True once g_freeList has been destroyed at thread exit; it is trivially
+ * destructible, so that it can still be read afterwards.
+ */
+static thread_local bool g_freeListDestroyed = false;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
@@ -69,6 +79,7 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList ()
       uint8_t *buffer = (uint8_t *)(*i);
       delete [] buffer;
     }
+  g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -345,7 +356,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (!g_freeListDestroyed && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -359,10 +370,13 @@ ByteTagList::Allocate (uint32_t size)
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
+  // Record the real size of the buffer so that it can be recycled and
+  // grown in place by later Add calls.
+  uint32_t allocated = std::max (size, g_maxSize);
+  uint8_t *buffer = new uint8_t [allocated + sizeof (struct ByteTagListData) - 4];
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
-  data->size = size;
+  data->size = allocated;
   data->dirty = 0;
   return data;
 }
@@ -379,7 +393,8 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeListDestroyed ||
+          g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -33,10 +33,12 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
-bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+std::atomic<bool> PacketMetadata::m_metadataSkipped (false);
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local uint64_t PacketMetadata::m_allocatedBytes = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local bool PacketMetadata::m_freeListDestroyed = false;
 
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
@@ -45,7 +47,7 @@ PacketMetadata::DataFreeList::~DataFreeList ()
     {
       PacketMetadata::Deallocate (*i);
     }
-  PacketMetadata::m_enable = false;
+  PacketMetadata::m_freeListDestroyed = true;
 }
 
 void 
@@ -70,6 +72,24 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+uint64_t
+PacketMetadata::GetAllocatedBytes (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return m_allocatedBytes;
+}
+
+void
+PacketMetadata::NotifySkipped (void)
+{
+  // all the threads write the flag: read it first, so that the cache
+  // line is only written once
+  if (!m_metadataSkipped.load (std::memory_order_relaxed))
+    {
+      m_metadataSkipped.store (true, std::memory_order_relaxed);
+    }
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -566,6 +586,236 @@ PacketMetadata::ReadItems (uint16_t current,
   return buffer - &m_data->m_data[current];
 }
 
+bool
+PacketMetadata::MustLog (bool costly) const
+{
+  NS_LOG_FUNCTION (this << costly);
+  // Once a log is started, the order of the operations requires to
+  // log all of them.
+  return m_log != 0 || (costly && !m_enableChecking);
+}
+
+void
+PacketMetadata::AddLogItem (const struct PacketMetadata::LogItem *item)
+{
+  NS_LOG_FUNCTION (this << static_cast<uint32_t> (item->operation) << item->typeUid <<
+                   item->size << item->chunkUid << item->appended);
+  uint32_t n = 1;
+  switch (item->operation)
+    {
+    case LOG_ADD_HEADER:
+    case LOG_ADD_TRAILER:
+      n += GetUleb128Size (item->typeUid) + GetUleb128Size (item->size) + 2;
+      break;
+    case LOG_REMOVE_HEADER:
+    case LOG_REMOVE_TRAILER:
+      n += GetUleb128Size (item->typeUid) + GetUleb128Size (item->size);
+      break;
+    case LOG_REMOVE_AT_START:
+    case LOG_REMOVE_AT_END:
+      n += GetUleb128Size (item->size);
+      break;
+    case LOG_ADD_AT_END:
+      n += sizeof (item->appended);
+      break;
+    default:
+      NS_ASSERT (false);
+      break;
+    }
+  if (m_log != 0 &&
+      (m_log->m_dirtyEnd != m_logUsed ||
+       (m_log->m_data[0] & PACKET_METADATA_LOG_SEALED) ||
+       m_logUsed + n > PACKET_METADATA_MAX_LOG_SIZE ||
+       (m_logUsed + n > m_log->m_size && m_log->m_count != 1)))
+    {
+      /* Another packet appended to the log after us, or the log is
+       * sealed or full, or it must be copied while it is shared: the
+       * entries which hold an appended metadata cannot be shared by
+       * two logs, so we apply the log and start a new one.
+       */
+      Materialize ();
+    }
+  if (m_log == 0)
+    {
+      m_log = PacketMetadata::Create (2 + n);
+      m_log->m_data[0] = 0;
+      m_log->m_data[1] = 0;
+      m_log->m_dirtyEnd = 2;
+      m_logUsed = 2;
+    }
+  else if (m_logUsed + n > m_log->m_size)
+    {
+      // move the log, and the ownership of its entries, to a larger buffer.
+      NS_ASSERT (m_log->m_count == 1);
+      struct PacketMetadata::Data *log = PacketMetadata::Create (m_logUsed + n);
+      memcpy (log->m_data, m_log->m_data, m_logUsed);
+      log->m_dirtyEnd = m_logUsed;
+      m_log->m_count--;
+      PacketMetadata::Recycle (m_log);
+      m_log = log;
+    }
+  uint8_t *buffer = &m_log->m_data[m_logUsed];
+  buffer[0] = item->operation;
+  buffer++;
+  switch (item->operation)
+    {
+    case LOG_ADD_HEADER:
+    case LOG_ADD_TRAILER:
+      AppendValue (item->typeUid, buffer);
+      buffer += GetUleb128Size (item->typeUid);
+      AppendValue (item->size, buffer);
+      buffer += GetUleb128Size (item->size);
+      Append16 (item->chunkUid, buffer);
+      break;
+    case LOG_REMOVE_HEADER:
+    case LOG_REMOVE_TRAILER:
+      AppendValue (item->typeUid, buffer);
+      buffer += GetUleb128Size (item->typeUid);
+      AppendValue (item->size, buffer);
+      break;
+    case LOG_REMOVE_AT_START:
+    case LOG_REMOVE_AT_END:
+      AppendValue (item->size, buffer);
+      break;
+    case LOG_ADD_AT_END:
+      memcpy (buffer, &item->appended, sizeof (item->appended));
+      m_log->m_data[0] |= PACKET_METADATA_LOG_HAS_APPENDED;
+      if (item->appended->m_log != 0)
+        {
+          m_log->m_data[1] = std::max<uint8_t> (m_log->m_data[1],
+                                                item->appended->m_log->m_data[1] + 1);
+        }
+      break;
+    }
+  m_logUsed += n;
+  m_log->m_dirtyEnd = m_logUsed;
+}
+
+void
+PacketMetadata::ReadLogItem (const uint8_t **pBuffer,
+                             struct PacketMetadata::LogItem *item) const
+{
+  NS_LOG_FUNCTION (this << &pBuffer);
+  const uint8_t *buffer = *pBuffer;
+  item->operation = buffer[0];
+  buffer++;
+  item->typeUid = 0;
+  item->size = 0;
+  item->chunkUid = 0;
+  item->appended = 0;
+  switch (item->operation)
+    {
+    case LOG_ADD_HEADER:
+    case LOG_ADD_TRAILER:
+      item->typeUid = ReadUleb128 (&buffer);
+      item->size = ReadUleb128 (&buffer);
+      item->chunkUid = buffer[0];
+      item->chunkUid |= (buffer[1]) << 8;
+      buffer += 2;
+      break;
+    case LOG_REMOVE_HEADER:
+    case LOG_REMOVE_TRAILER:
+      item->typeUid = ReadUleb128 (&buffer);
+      item->size = ReadUleb128 (&buffer);
+      break;
+    case LOG_REMOVE_AT_START:
+    case LOG_REMOVE_AT_END:
+      item->size = ReadUleb128 (&buffer);
+      break;
+    case LOG_ADD_AT_END:
+      memcpy (&item->appended, buffer, sizeof (item->appended));
+      buffer += sizeof (item->appended);
+      break;
+    default:
+      NS_ASSERT (false);
+      break;
+    }
+  *pBuffer = buffer;
+}
+
+void
+PacketMetadata::Materialize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_log == 0)
+    {
+      return;
+    }
+  PacketMetadata *self = const_cast<PacketMetadata *> (this);
+  // detach the log so that its entries are applied to the items.
+  struct PacketMetadata::Data *log = m_log;
+  const uint8_t *buffer = &log->m_data[2];
+  const uint8_t *end = &log->m_data[m_logUsed];
+  self->m_log = 0;
+  self->m_logUsed = 0;
+  while (buffer < end)
+    {
+      struct PacketMetadata::LogItem item;
+      ReadLogItem (&buffer, &item);
+      switch (item.operation)
+        {
+        case LOG_ADD_HEADER:
+          self->ApplyAddHeader (item.typeUid, item.size, item.chunkUid);
+          break;
+        case LOG_ADD_TRAILER:
+          self->ApplyAddTrailer (item.typeUid, item.size, item.chunkUid);
+          break;
+        case LOG_REMOVE_HEADER:
+          self->ApplyRemoveHeader (item.typeUid, item.size);
+          break;
+        case LOG_REMOVE_TRAILER:
+          self->ApplyRemoveTrailer (item.typeUid, item.size);
+          break;
+        case LOG_REMOVE_AT_START:
+          self->ApplyRemoveAtStart (item.size);
+          break;
+        case LOG_REMOVE_AT_END:
+          self->ApplyRemoveAtEnd (item.size);
+          break;
+        case LOG_ADD_AT_END:
+          {
+            PacketMetadata appended = *item.appended;
+            appended.Materialize ();
+            self->ApplyAddAtEnd (appended);
+          }
+          break;
+        }
+    }
+  NS_ASSERT (buffer == end);
+  NS_ASSERT (m_log == 0);
+  self->m_log = log;
+  self->ReleaseLog ();
+}
+
+void
+PacketMetadata::ReleaseLog (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_log != 0);
+  struct PacketMetadata::Data *log = m_log;
+  m_log = 0;
+  m_logUsed = 0;
+  log->m_count--;
+  if (log->m_count != 0)
+    {
+      return;
+    }
+  if (log->m_data[0] & PACKET_METADATA_LOG_HAS_APPENDED)
+    {
+      const uint8_t *buffer = &log->m_data[2];
+      while (buffer < &log->m_data[log->m_dirtyEnd])
+        {
+          struct PacketMetadata::LogItem item;
+          ReadLogItem (&buffer, &item);
+          if (item.operation == LOG_ADD_AT_END)
+            {
+              delete item.appended;
+            }
+        }
+    }
+  PacketMetadata::Recycle (log);
+}
+
 struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
@@ -575,7 +825,7 @@ PacketMetadata::Create (uint32_t size)
     {
       m_maxSize = size;
     }
-  while (!m_freeList.empty ()) 
+  while (!m_freeListDestroyed && !m_freeList.empty ()) 
     {
       struct PacketMetadata::Data *data = m_freeList.back ();
       m_freeList.pop_back ();
@@ -583,12 +833,14 @@ PacketMetadata::Create (uint32_t size)
         {
           NS_LOG_LOGIC ("create found size="<<data->m_size);
           data->m_count = 1;
+          m_allocatedBytes += data->m_size;
           return data;
         }
       NS_LOG_LOGIC ("create dealloc size="<<data->m_size);
       PacketMetadata::Deallocate (data);
     }
   NS_LOG_LOGIC ("create alloc size="<<m_maxSize);
+  m_allocatedBytes += m_maxSize;
   return PacketMetadata::Allocate (m_maxSize);
 }
 
@@ -596,7 +848,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || m_freeListDestroyed)
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -665,17 +917,34 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
   NS_LOG_FUNCTION (this << uid << size);
   if (!m_enable)
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
       return;
     }
-
+  uint16_t chunkUid = m_chunkUid;
+  m_chunkUid++;
+  if (MustLog (!IsWritable ()))
+    {
+      struct PacketMetadata::LogItem item;
+      item.operation = LOG_ADD_HEADER;
+      item.typeUid = uid;
+      item.size = size;
+      item.chunkUid = chunkUid;
+      item.appended = 0;
+      AddLogItem (&item);
+      return;
+    }
+  ApplyAddHeader (uid, size, chunkUid);
+}
+void
+PacketMetadata::ApplyAddHeader (uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
   item.prev = 0xffff;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateHead (written);
 }
@@ -687,9 +956,26 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
       return;
     }
+  if (MustLog (false))
+    {
+      struct PacketMetadata::LogItem item;
+      item.operation = LOG_REMOVE_HEADER;
+      item.typeUid = uid;
+      item.size = size;
+      item.chunkUid = 0;
+      item.appended = 0;
+      AddLogItem (&item);
+      return;
+    }
+  ApplyRemoveHeader (uid, size);
+}
+void
+PacketMetadata::ApplyRemoveHeader (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -735,19 +1021,37 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   NS_ASSERT (IsStateOk ());
   if (!m_enable)
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
       return;
     }
+  uint16_t chunkUid = m_chunkUid;
+  m_chunkUid++;
+  if (MustLog (!IsWritable ()))
+    {
+      struct PacketMetadata::LogItem item;
+      item.operation = LOG_ADD_TRAILER;
+      item.typeUid = uid;
+      item.size = size;
+      item.chunkUid = chunkUid;
+      item.appended = 0;
+      AddLogItem (&item);
+      return;
+    }
+  ApplyAddTrailer (uid, size, chunkUid);
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::ApplyAddTrailer (uint32_t uid, uint32_t size, uint16_t chunkUid)
+{
+  NS_LOG_FUNCTION (this << uid << size << chunkUid);
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
   item.typeUid = uid;
   item.size = size;
-  item.chunkUid = m_chunkUid;
-  m_chunkUid++;
+  item.chunkUid = chunkUid;
   uint16_t written = AddSmall (&item);
   UpdateTail (written);
-  NS_ASSERT (IsStateOk ());
 }
 void 
 PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
@@ -757,9 +1061,26 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
       return;
     }
+  if (MustLog (false))
+    {
+      struct PacketMetadata::LogItem item;
+      item.operation = LOG_REMOVE_TRAILER;
+      item.typeUid = uid;
+      item.size = size;
+      item.chunkUid = 0;
+      item.appended = 0;
+      AddLogItem (&item);
+      return;
+    }
+  ApplyRemoveTrailer (uid, size);
+}
+void
+PacketMetadata::ApplyRemoveTrailer (uint32_t uid, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << uid << size);
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -804,9 +1125,61 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
+      return;
+    }
+  if (m_log == 0 && m_tail == 0xffff)
+    {
+      // We have no items so 'AddAtEnd' is 
+      // equivalent to self-assignment.
+      *this = o;
+      return;
+    }
+  if (o.m_log == 0 && o.m_head == 0xffff)
+    {
+      // we have nothing to append.
+      return;
+    }
+  if (MustLog (true))
+    {
+      struct PacketMetadata::LogItem item;
+      item.operation = LOG_ADD_AT_END;
+      item.typeUid = 0;
+      item.size = 0;
+      item.chunkUid = 0;
+      item.appended = new PacketMetadata (o);
+      struct PacketMetadata::Data *log = item.appended->m_log;
+      if (log != 0)
+        {
+          if (log->m_data[1] >= PACKET_METADATA_MAX_LOG_DEPTH)
+            {
+              item.appended->Materialize ();
+            }
+          else
+            {
+              log->m_data[0] |= PACKET_METADATA_LOG_SEALED;
+            }
+        }
+      AddLogItem (&item);
       return;
     }
+  if (o.m_log != 0)
+    {
+      PacketMetadata appended = o;
+      appended.Materialize ();
+      ApplyAddAtEnd (appended);
+    }
+  else
+    {
+      ApplyAddAtEnd (o);
+    }
+  NS_ASSERT (IsStateOk ());
+}
+void
+PacketMetadata::ApplyAddAtEnd (PacketMetadata const&o)
+{
+  NS_LOG_FUNCTION (this << &o);
+  NS_ASSERT (o.m_log == 0);
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -881,7 +1254,7 @@ PacketMetadata::AddPaddingAtEnd (uint32_t end)
   NS_LOG_FUNCTION (this << end);
   if (!m_enable)
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
       return;
     }
 }
@@ -892,9 +1265,26 @@ PacketMetadata::RemoveAtStart (uint32_t start)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
       return;
     }
+  if (MustLog (m_head != 0xffff))
+    {
+      struct PacketMetadata::LogItem item;
+      item.operation = LOG_REMOVE_AT_START;
+      item.typeUid = 0;
+      item.size = start;
+      item.chunkUid = 0;
+      item.appended = 0;
+      AddLogItem (&item);
+      return;
+    }
+  ApplyRemoveAtStart (start);
+}
+void
+PacketMetadata::ApplyRemoveAtStart (uint32_t start)
+{
+  NS_LOG_FUNCTION (this << start);
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -955,9 +1345,26 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
   NS_ASSERT (IsStateOk ());
   if (!m_enable) 
     {
-      m_metadataSkipped = true;
+      NotifySkipped ();
+      return;
+    }
+  if (MustLog (m_head != 0xffff))
+    {
+      struct PacketMetadata::LogItem item;
+      item.operation = LOG_REMOVE_AT_END;
+      item.typeUid = 0;
+      item.size = end;
+      item.chunkUid = 0;
+      item.appended = 0;
+      AddLogItem (&item);
       return;
     }
+  ApplyRemoveAtEnd (end);
+}
+void
+PacketMetadata::ApplyRemoveAtEnd (uint32_t end)
+{
+  NS_LOG_FUNCTION (this << end);
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -1046,6 +1453,7 @@ PacketMetadata::ItemIterator
 PacketMetadata::BeginItem (Buffer buffer) const
 {
   NS_LOG_FUNCTION (this << &buffer);
+  Materialize ();
   return ItemIterator (this, buffer);
 }
 PacketMetadata::ItemIterator::ItemIterator (const PacketMetadata *metadata, Buffer buffer)
@@ -1146,6 +1554,7 @@ PacketMetadata::GetSerializedSize (void) const
       return totalSize;
     }
 
+  Materialize ();
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t current = m_head;
@@ -1178,6 +1587,7 @@ uint32_t
 PacketMetadata::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  Materialize ();
   uint8_t* start = buffer;
 
   buffer = AddToRawU64 (m_packetUid, start, buffer, maxSize);
@@ -1279,6 +1689,7 @@ uint32_t
 PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
 {
   NS_LOG_FUNCTION (this << &buffer << size);
+  Materialize ();
   const uint8_t* start = buffer;
   uint32_t desSize = size - 4;
 
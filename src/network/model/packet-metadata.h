@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <vector>
 #include <limits>
+#include <atomic>
 #include "ns3/callback.h"
 #include "ns3/assert.h"
 #include "ns3/type-id.h"
@@ -74,6 +75,18 @@ class Trailer;
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
  * encoding.
+ *
+ * Unless checking is enabled, the operations which would copy or
+ * rebuild the linked list (fragmentation, concatenation, and the
+ * addition of an item to a list shared with another packet) are not
+ * applied immediately: they are recorded in a log, another byte buffer
+ * of struct PacketMetadata::Data, whose entries are made of an
+ * operation code followed by its uleb128-encoded arguments. Once a
+ * packet has a log, all its operations are appended to the log, and
+ * the log is applied to the linked list only when the items are needed,
+ * that is, by BeginItem, GetSerializedSize and Serialize. The packets
+ * which are never printed thus never pay for the maintenance of their
+ * linked list.
  */
 class PacketMetadata 
 {
@@ -158,8 +171,20 @@ private:
   static void Enable (void);
   /**
    * \brief Enable the packet metadata checking
+   *
+   * The operations are then applied immediately to the item list
+   * rather than recorded in a log, so that they can be checked.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Get the amount of metadata storage handed out so far
+   *
+   * This counts the storage of both the item lists and the logs,
+   * whether it was newly allocated or recycled, by the calling thread.
+   *
+   * \return the number of bytes of metadata storage
+   */
+  static uint64_t GetAllocatedBytes (void);
 
   /**
    * \brief Constructor
@@ -494,6 +519,71 @@ private:
     uint64_t packetUid;
   };
 
+  /**
+   * \brief Operations recorded in the log
+   */
+  enum LogOperation {
+    LOG_ADD_HEADER = 0,     //!< AddHeader: uid, size, chunkUid
+    LOG_ADD_TRAILER = 1,    //!< AddTrailer: uid, size, chunkUid
+    LOG_REMOVE_HEADER = 2,  //!< RemoveHeader: uid, size
+    LOG_REMOVE_TRAILER = 3, //!< RemoveTrailer: uid, size
+    LOG_REMOVE_AT_START = 4, //!< RemoveAtStart: size
+    LOG_REMOVE_AT_END = 5,  //!< RemoveAtEnd: size
+    LOG_ADD_AT_END = 6      //!< AddAtEnd: appended
+  };
+
+  /**
+   * \brief LogItem structure
+   *
+   * The first byte of a log buffer holds flags, the second one the
+   * nesting depth of the appended metadata; the entries follow.
+   * Each entry is made of the operation code, stored as a byte, and
+   * of the fields used by this operation.
+   */
+  struct LogItem {
+    /** the operation, one of LogOperation. */
+    uint8_t operation;
+    /** the typeUid of the header or trailer, as in SmallItem.
+       stored as a variable-size 32 bit integer.
+     */
+    uint32_t typeUid;
+    /** the size of the header or trailer, or the number of bytes
+       removed by RemoveAtStart and RemoveAtEnd.
+       stored as a variable-size 32 bit integer.
+     */
+    uint32_t size;
+    /** the chunkUid of the added header or trailer.
+       stored as a fixed-size 16 bit integer.
+     */
+    uint16_t chunkUid;
+    /** a copy of the metadata appended by AddAtEnd, owned by the
+       log buffer. stored as a pointer.
+     */
+    PacketMetadata *appended;
+  };
+
+  /**
+   * \brief Flag of the first byte of a log buffer, set if some of
+   * its entries hold an appended metadata.
+   */
+#define PACKET_METADATA_LOG_HAS_APPENDED 0x1
+  /**
+   * \brief Flag of the first byte of a log buffer, set if an appended
+   * metadata refers to it: the log must then not be extended, so that
+   * the logs never refer to themselves.
+   */
+#define PACKET_METADATA_LOG_SEALED 0x2
+  /**
+   * the nesting depth of the appended metadata beyond which the
+   * appended metadata is applied to its item list rather than logged
+   */
+#define PACKET_METADATA_MAX_LOG_DEPTH 8
+  /**
+   * the log size beyond which the log is applied to the item list
+   * rather than extended
+   */
+#define PACKET_METADATA_MAX_LOG_SIZE 256
+
   /**
    * \brief Class to hold all the metadata
    */
@@ -620,6 +710,87 @@ public:
    * \param size header serialized size
    */
   void DoAddHeader (uint32_t uid, uint32_t size);
+
+  /**
+   * \brief Check whether an item can be added to the item list without
+   * copying it
+   * \returns true if the item list is not shared or if this object
+   * holds its most recent items
+   */
+  inline bool IsWritable (void) const;
+  /**
+   * \brief Check whether the next operation should be recorded in the log
+   * \param costly true if applying the operation may copy or rebuild the
+   *        item list
+   * \returns true if the operation should be recorded in the log
+   */
+  bool MustLog (bool costly) const;
+  /**
+   * \brief Append an entry to the log
+   * \param item the entry to append
+   */
+  void AddLogItem (const struct PacketMetadata::LogItem *item);
+  /**
+   * \brief Read an entry of a log
+   * \param pBuffer the position of the entry, moved to the next entry
+   * \param item pointer to where we should store the entry
+   */
+  void ReadLogItem (const uint8_t **pBuffer,
+                    struct PacketMetadata::LogItem *item) const;
+  /**
+   * \brief Apply the log to the item list
+   *
+   * The log is a deferred form of the item list, so applying it does
+   * not change the value of the metadata, and can be done on a const
+   * object.
+   */
+  void Materialize (void) const;
+  /**
+   * \brief Drop the reference of this object to its log
+   */
+  void ReleaseLog (void);
+
+  /**
+   * \brief Add an header to the item list
+   * \param uid header's uid to add
+   * \param size header serialized size
+   * \param chunkUid the chunk uid of the header
+   */
+  void ApplyAddHeader (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Add a trailer to the item list
+   * \param uid trailer's uid to add
+   * \param size trailer serialized size
+   * \param chunkUid the chunk uid of the trailer
+   */
+  void ApplyAddTrailer (uint32_t uid, uint32_t size, uint16_t chunkUid);
+  /**
+   * \brief Remove an header from the item list
+   * \param uid header's uid to remove
+   * \param size header serialized size
+   */
+  void ApplyRemoveHeader (uint32_t uid, uint32_t size);
+  /**
+   * \brief Remove a trailer from the item list
+   * \param uid trailer's uid to remove
+   * \param size trailer serialized size
+   */
+  void ApplyRemoveTrailer (uint32_t uid, uint32_t size);
+  /**
+   * \brief Append the items of another metadata to the item list
+   * \param o the metadata to add, without log
+   */
+  void ApplyAddAtEnd (PacketMetadata const&o);
+  /**
+   * \brief Remove a chunk of the item list at its start
+   * \param start the size of metadata to remove
+   */
+  void ApplyRemoveAtStart (uint32_t start);
+  /**
+   * \brief Remove a chunk of the item list at its end
+   * \param end the size of metadata to remove
+   */
+  void ApplyRemoveAtEnd (uint32_t end);
   /**
    * \brief Check if the metadata state is ok
    * \returns true if the internal state is ok
@@ -661,7 +832,22 @@ public:
    */
   static void Deallocate (struct PacketMetadata::Data *data);
 
-  static DataFreeList m_freeList; //!< the metadata data storage
+  /**
+   * \brief Record that adding metadata to a packet was skipped
+   */
+  static void NotifySkipped (void);
+
+  /*
+   * The free list and the counters are kept per thread, since the
+   * packets of the partitions of MultithreadedSimulatorImpl are handled
+   * concurrently.
+   */
+  static thread_local DataFreeList m_freeList; //!< the metadata data storage
+  /**
+   * True once m_freeList has been destroyed at thread exit; it is
+   * trivially destructible, so that it can still be read afterwards.
+   */
+  static thread_local bool m_freeListDestroyed;
   static bool m_enable; //!< Enable the packet metadata
   static bool m_enableChecking; //!< Enable the packet metadata checking
 
@@ -670,10 +856,11 @@ public:
    * m_enable is false; used to detect enabling of metadata in the
    * middle of a simulation, which isn't allowed.
    */
-  static bool m_metadataSkipped;
+  static std::atomic<bool> m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
-  static uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint32_t m_maxSize; //!< maximum metadata size
+  static thread_local uint16_t m_chunkUid; //!< Chunk Uid
+  static thread_local uint64_t m_allocatedBytes; //!< metadata storage handed out
 
   struct Data *m_data; //!< Metadata storage
   /*
@@ -685,6 +872,8 @@ public:
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
   uint64_t m_packetUid; //!< packet Uid
+  struct Data *m_log; //!< operations not yet applied to the items, or zero
+  uint16_t m_logUsed; //!< used portion of the log
 };
 
 } // namespace ns3
@@ -696,7 +885,9 @@ PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
-    m_packetUid (uid)
+    m_packetUid (uid),
+    m_log (0),
+    m_logUsed (0)
 {
   memset (m_data->m_data, 0xff, 4);
   if (size > 0)
@@ -709,11 +900,17 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
-    m_packetUid (o.m_packetUid)
+    m_packetUid (o.m_packetUid),
+    m_log (o.m_log),
+    m_logUsed (o.m_logUsed)
 {
   NS_ASSERT (m_data != 0);
   NS_ASSERT (m_data->m_count < std::numeric_limits<uint32_t>::max());
   m_data->m_count++;
+  if (m_log != 0)
+    {
+      m_log->m_count++;
+    }
 }
 PacketMetadata &
 PacketMetadata::operator = (PacketMetadata const& o)
@@ -735,6 +932,19 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_tail = o.m_tail;
   m_used = o.m_used;
   m_packetUid = o.m_packetUid;
+  if (m_log != o.m_log)
+    {
+      if (o.m_log != 0)
+        {
+          o.m_log->m_count++;
+        }
+      if (m_log != 0)
+        {
+          ReleaseLog ();
+        }
+      m_log = o.m_log;
+    }
+  m_logUsed = o.m_logUsed;
   return *this;
 }
 PacketMetadata::~PacketMetadata ()
@@ -745,6 +955,17 @@ PacketMetadata::~PacketMetadata ()
     {
       PacketMetadata::Recycle (m_data);
     }
+  if (m_log != 0)
+    {
+      ReleaseLog ();
+    }
+}
+bool
+PacketMetadata::IsWritable (void) const
+{
+  return m_head == 0xffff ||
+         m_data->m_count == 1 ||
+         m_data->m_dirtyEnd == m_used;
 }
 
 } // namespace ns3
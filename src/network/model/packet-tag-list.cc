@@ -29,11 +29,89 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <cstring>
+#include <vector>
+
+/**
+ * Size of the data area of the recycled TagData, large enough for
+ * the tags attached to packets by the Wi-Fi and LTE models.
+ */
+#define PACKET_TAG_DATA_SIZE 32
+/** Maximum number of TagData kept in the free list of a thread. */
+#define PACKET_TAG_FREE_LIST_SIZE 1000
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+namespace {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Container of the recycled TagData of small tags of a thread.
+ *
+ * Internal use only.
+ */
+class TagDataFreeList : public std::vector<struct PacketTagList::TagData *>
+{
+public:
+  ~TagDataFreeList ();
+};
+
+/**
+ * The recycled TagData of each thread, since the packets of the
+ * partitions of MultithreadedSimulatorImpl are handled concurrently.
+ */
+thread_local TagDataFreeList g_freeList;
+/**
+ * True once g_freeList has been destroyed at thread exit; it is trivially
+ * destructible, so that it can still be read afterwards.
+ */
+thread_local bool g_freeListDestroyed = false;
+
+TagDataFreeList::~TagDataFreeList ()
+{
+  for (iterator i = begin (); i != end (); i++)
+    {
+      std::free (*i);
+    }
+  g_freeListDestroyed = true;
+}
+
+/**
+ * \param [in] tid The type of a tag.
+ * \returns The bit of the tag type in TagData::mask.
+ */
+inline uint32_t
+GetTagMask (TypeId tid)
+{
+  return 1U << (tid.GetUid () % 32);
+}
+
+/**
+ * Recompute the masks of a list up to its first merge.
+ *
+ * \param [in] cur The head of the list.
+ * \returns The mask of \pname{cur}.
+ */
+uint32_t
+UpdateMasksFrom (struct PacketTagList::TagData *cur)
+{
+  if (cur == 0)
+    {
+      return 0;
+    }
+  if (cur->count > 1)
+    {
+      // shared with other lists, hence unchanged
+      return cur->mask;
+    }
+  cur->mask = GetTagMask (cur->tid) | UpdateMasksFrom (cur->next);
+  return cur->mask;
+}
+
+} // unnamed namespace
+
 PacketTagList::TagData *
 PacketTagList::CreateTagData (size_t dataSize)
 {
@@ -43,14 +121,49 @@ PacketTagList::CreateTagData (size_t dataSize)
                  << " exceeds maximum "
                  << std::numeric_limits<decltype(TagData::size)>::max () );
 
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
+  void * p;
+  if (dataSize > PACKET_TAG_DATA_SIZE)
+    {
+      p = std::malloc (sizeof (TagData) + dataSize - 1);
+    }
+  else if (!g_freeListDestroyed && !g_freeList.empty ())
+    {
+      p = g_freeList.back ();
+      g_freeList.pop_back ();
+    }
+  else
+    {
+      p = std::malloc (sizeof (TagData) + PACKET_TAG_DATA_SIZE - 1);
+    }
+  // The matching frees are in FreeTagData
 
   TagData * tag = new (p) TagData;
   tag->size = dataSize;
   return tag;
 }
 
+void
+PacketTagList::FreeTagData (TagData * data)
+{
+  bool recycle = data->size <= PACKET_TAG_DATA_SIZE;
+  data->~TagData ();
+  if (recycle && !g_freeListDestroyed
+      && g_freeList.size () < PACKET_TAG_FREE_LIST_SIZE)
+    {
+      g_freeList.push_back (data);
+    }
+  else
+    {
+      std::free (data);
+    }
+}
+
+void
+PacketTagList::UpdateMasks (void)
+{
+  UpdateMasksFrom (m_next);
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -58,8 +171,8 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
   NS_LOG_FUNCTION (this << tid);
   NS_LOG_INFO     ("looking for " << tid);
 
-  // trivial case when list is empty
-  if (m_next == 0)
+  // trivial case when list is empty or has no tag of this type
+  if (m_next == 0 || (m_next->mask & GetTagMask (tid)) == 0)
     {
       return false;
     }
@@ -153,6 +266,7 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
       struct TagData * copy = CreateTagData (cur->size);
       copy->tid = cur->tid;
       copy->count = 1;
+      copy->mask = cur->mask;
       copy->size = cur->size;
       memcpy (copy->data, cur->data, copy->size);
       copy->next = cur->next;             // merge into tail
@@ -175,7 +289,12 @@ PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
+  bool found = COWTraverse (tag, &PacketTagList::RemoveWriter);
+  if (found)
+    {
+      UpdateMasks ();
+    }
+  return found;
 }
 
 // COWWriter implementing Remove
@@ -194,8 +313,7 @@ PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
   if (preMerge)
     {
       // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      FreeTagData (cur);
     }
   else
     {
@@ -245,6 +363,7 @@ PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
       struct TagData * copy = CreateTagData (tag.GetSerializedSize ());
       copy->tid = tag.GetInstanceTypeId ();
       copy->count = 1;
+      copy->mask = cur->mask;
       tag.Serialize (TagBuffer (copy->data, copy->data + copy->size));
       copy->next = cur->next;           // merge into tail
       if (copy->next != 0)
@@ -271,6 +390,7 @@ PacketTagList::Add (const Tag &tag) const
   head->next = 0;
   head->tid = tag.GetInstanceTypeId ();
   head->next = m_next;
+  head->mask = GetTagMask (head->tid) | (m_next != 0 ? m_next->mask : 0);
   tag.Serialize (TagBuffer (head->data, head->data + head->size));
 
   const_cast<PacketTagList *> (this)->m_next = head;
@@ -281,7 +401,8 @@ PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  uint32_t mask = GetTagMask (tid);
+  for (struct TagData *cur = m_next; cur != 0 && (cur->mask & mask) != 0; cur = cur->next) 
     {
       if (cur->tid == tid) 
         {
@@ -119,6 +119,21 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Allocation and lookup </b>
+ *
+ *   - The TagData of small tags, up to \c PACKET_TAG_DATA_SIZE bytes,
+ *     which covers the tags attached by the Wi-Fi and LTE models, all
+ *     have the same size and are recycled through a free list per
+ *     thread instead of being returned to the heap, so that adding and
+ *     removing tags on every hop does not call malloc and free.
+ *
+ *   - Each TagData holds in \c mask a filter of the types of the tags
+ *     found from it to the root: the bit of a type is bit (uid % 32) of
+ *     its TypeId uid, which it shares with other types.  #Peek, #Remove
+ *     and #Replace return without walking the list when the bit of the
+ *     tag they look for is not set in the head of the list; when it is
+ *     set, the list may still not hold that type, and is walked.
  */
 class PacketTagList 
 {
@@ -142,6 +157,7 @@ public:
   {
     struct TagData * next;      /**< Pointer to next in list */
     uint32_t count;             /**< Number of incoming links */
+    uint32_t mask;              /**< Bits of the tag types from this node to the root */
     TypeId tid;                 /**< Type of the tag serialized into #data */
     uint32_t size;              /**< Size of the \c data buffer */
     uint8_t data[1];            /**< Serialization buffer */
@@ -228,6 +244,19 @@ private:
    */
   static
   TagData * CreateTagData (size_t dataSize);
+  /**
+   * Destroy a TagData struct created by CreateTagData, and recycle
+   * its memory if it is a small tag.
+   *
+   * \param [in] data The TagData to free.
+   */
+  static
+  void FreeTagData (TagData * data);
+  /**
+   * Recompute the \c mask of the TagData of this list up to the
+   * first merge, after a tag has been removed.
+   */
+  void UpdateMasks (void);
   
   /**
    * Typedef of method function pointer for copy-on-write operations
@@ -341,15 +370,13 @@ PacketTagList::RemoveAll (void)
         }
       if (prev != 0) 
         {
-          prev->~TagData ();
-          std::free (prev);
+          FreeTagData (prev);
         }
       prev = cur;
     }
   if (prev != 0) 
     {
-      prev->~TagData ();
-      std::free (prev);
+      FreeTagData (prev);
     }
   m_next = 0;
 }
@@ -21,14 +21,70 @@
 #include "ns3/assert.h"
 #include "ns3/log.h"
 #include "ns3/simulator.h"
+#include "ns3/system-mutex.h"
 #include <string>
 #include <cstdarg>
+#include <map>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+namespace {
+
+/**
+ * \ingroup packet
+ * Get the mutex of the packet uid counters.
+ * \returns The mutex.
+ */
+SystemMutex &
+GetUidMutex (void)
+{
+  static SystemMutex g_uidMutex;
+  return g_uidMutex;
+}
+
+/**
+ * \ingroup packet
+ * Get the next packet uid of each system id, guarded by GetUidMutex().
+ * The elements are never erased, so that the threads can keep pointers
+ * to them.
+ * \returns The counters, indexed by system id.
+ */
+std::map<uint32_t, uint32_t> &
+GetUidCounters (void)
+{
+  static std::map<uint32_t, uint32_t> g_uidCounters;
+  return g_uidCounters;
+}
+
+/** The counter of the system id last used by the thread, or 0. */
+thread_local uint32_t *g_uidCounter = 0;
+/** The system id of g_uidCounter. */
+thread_local uint32_t g_uidSystemId = 0;
+
+} // anonymous namespace
+
+uint64_t
+Packet::AllocateUid (void)
+{
+  /* The upper 32 bits of the packet id in 
+   * metadata is for the system id. For non-
+   * distributed simulations, this is simply 
+   * zero.  The lower 32 bits are for the 
+   * global UID, counted per system id, since
+   * the system ids of MultithreadedSimulatorImpl
+   * create packets concurrently.
+   */
+  uint32_t systemId = Simulator::GetSystemId ();
+  if (g_uidCounter == 0 || g_uidSystemId != systemId)
+    {
+      CriticalSection critical (GetUidMutex ());
+      g_uidCounter = &GetUidCounters ()[systemId];
+      g_uidSystemId = systemId;
+    }
+  return static_cast<uint64_t> (systemId) << 32 | (*g_uidCounter)++;
+}
 
 TypeId 
 ByteTagIterator::Item::GetTypeId (void) const
@@ -130,16 +186,9 @@ Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -172,16 +221,9 @@ Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -198,16 +240,9 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
-    /* The upper 32 bits of the packet id in 
-     * metadata is for the system id. For non-
-     * distributed simulations, this is simply 
-     * zero.  The lower 32 bits are for the 
-     * global UID
-     */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
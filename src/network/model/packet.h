@@ -766,7 +766,11 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-  static uint32_t m_globalUid; //!< Global counter of packets Uid
+  /**
+   * \brief Allocate the uid of a new packet
+   * \returns the uid, made of the system id and of a counter of this system id
+   */
+  static uint64_t AllocateUid (void);
 };
 
 /**
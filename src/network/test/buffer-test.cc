@@ -378,6 +378,131 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer::AddAtEnd (const Buffer &) tests: joining fragments of a
+ * buffer must not copy their bytes, nor fill their zero area.
+ */
+class BufferJoinTest : public TestCase {
+public:
+  virtual void DoRun (void);
+  BufferJoinTest ();
+};
+
+BufferJoinTest::BufferJoinTest ()
+  : TestCase ("Buffer fragments join") {
+}
+
+void
+BufferJoinTest::DoRun (void)
+{
+  // adjacent fragments of the same bytes are joined in place
+  Buffer buffer;
+  buffer.AddAtStart (1000);
+  Buffer::Iterator i = buffer.Begin ();
+  for (uint32_t j = 0; j < 1000; j++)
+    {
+      i.WriteU8 (j % 251);
+    }
+  Buffer joined = buffer.CreateFragment (0, 300);
+  joined.AddAtEnd (buffer.CreateFragment (300, 400));
+  joined.AddAtEnd (buffer.CreateFragment (700, 300));
+  NS_TEST_EXPECT_MSG_EQ (joined.GetSize (), 1000, "Bad joined size");
+  NS_TEST_EXPECT_MSG_EQ (joined.PeekData (), buffer.PeekData (), "Fragments copied");
+  // a later addition must not overwrite the shared bytes
+  joined.AddAtEnd (1);
+  i = joined.End ();
+  i.Prev ();
+  i.WriteU8 (0x77);
+  i = joined.Begin ();
+  for (uint32_t j = 0; j < 1000; j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), j % 251, "Bad joined byte " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), 0x77, "Bad added byte");
+  NS_TEST_EXPECT_MSG_EQ (buffer.GetSize (), 1000, "Bad original size");
+
+  // fragments of a zero area keep it, even if the buffer is shared
+  Buffer zeroes (10000);
+  zeroes.AddAtStart (4);
+  zeroes.Begin ().WriteHtonU32 (0x01020304);
+  zeroes.AddAtEnd (2);
+  i = zeroes.End ();
+  i.Prev (2);
+  i.WriteU8 (0x55, 2);
+  joined = zeroes.CreateFragment (0, 5004);
+  Buffer copy = joined;
+  joined.AddAtEnd (zeroes.CreateFragment (5004, 5002));
+  NS_TEST_EXPECT_MSG_EQ (joined.GetSize (), 10006, "Bad joined size");
+  NS_TEST_EXPECT_MSG_LT (joined.GetSerializedSize (), 100, "Zero area filled");
+  NS_TEST_EXPECT_MSG_EQ (copy.GetSize (), 5004, "Bad copy size");
+  i = joined.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU32 (), 0x01020304, "Bad joined header");
+  for (uint32_t j = 0; j < 10000; j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), 0, "Bad joined zero " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU16 (), 0x5555, "Bad joined trailer");
+
+  // separate zero areas: only the smaller one is filled
+  joined = Buffer ();
+  joined.AddAtStart (2);
+  joined.Begin ().WriteHtonU16 (0x0a0b);
+  joined.AddAtEnd (zeroes);
+  NS_TEST_EXPECT_MSG_EQ (joined.GetSize (), 10008, "Bad joined size");
+  NS_TEST_EXPECT_MSG_LT (joined.GetSerializedSize (), 100, "Zero area filled after a header");
+  Buffer small (1000);
+  small.AddAtStart (1);
+  small.Begin ().WriteU8 (0x66);
+  joined.AddAtEnd (small);
+  Buffer large (20000);
+  large.AddAtStart (1);
+  large.Begin ().WriteU8 (0x99);
+  joined.AddAtEnd (large);
+  NS_TEST_EXPECT_MSG_EQ (joined.GetSize (), 31010, "Bad joined size");
+  NS_TEST_EXPECT_MSG_LT (joined.GetSerializedSize (), 12000, "Larger zero area filled");
+  NS_TEST_EXPECT_MSG_GT (joined.GetSerializedSize (), 11000, "Smaller zero areas not filled");
+  i = joined.Begin ();
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU16 (), 0x0a0b, "Bad first header");
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU32 (), 0x01020304, "Bad second header");
+  for (uint32_t j = 0; j < 10000; j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), 0, "Bad first zero " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.ReadNtohU16 (), 0x5555, "Bad trailer");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), 0x66, "Bad third header");
+  for (uint32_t j = 0; j < 1000; j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), 0, "Bad second zero " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), 0x99, "Bad fourth header");
+  for (uint32_t j = 0; j < 20000; j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), 0, "Bad third zero " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, "Bad joined end");
+  NS_TEST_EXPECT_MSG_EQ (zeroes.GetSize (), 10006, "Joined buffer modified");
+  NS_TEST_EXPECT_MSG_EQ (zeroes.Begin ().ReadNtohU32 (), 0x01020304, "Joined buffer modified");
+
+  // many separate buffers appended one by one
+  joined = Buffer ();
+  for (uint32_t k = 0; k < 100; k++)
+    {
+      Buffer part;
+      part.AddAtStart (100);
+      part.Begin ().WriteU8 (k, 100);
+      joined.AddAtEnd (part);
+    }
+  NS_TEST_EXPECT_MSG_EQ (joined.GetSize (), 10000, "Bad appended size");
+  i = joined.Begin ();
+  for (uint32_t j = 0; j < 10000; j++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((uint32_t)i.ReadU8 (), j / 100, "Bad appended byte " << j);
+    }
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +519,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferJoinTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
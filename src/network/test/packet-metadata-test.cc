@@ -900,6 +900,52 @@ PacketMetadataTest::DoRun (void)
                                  p3->GetSize ());
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
+
+  // Operations recorded in the logs of the packets, and applied only
+  // when the items are read.
+  uint64_t allocated = PacketMetadata::GetAllocatedBytes ();
+  p = Create<Packet> (1000);
+  NS_TEST_EXPECT_MSG_GT (PacketMetadata::GetAllocatedBytes (), allocated, "Metadata storage not counted");
+  ADD_HEADER (p, 10);
+  ADD_TRAILER (p, 20);
+  Ptr<Packet> f0 = p->CreateFragment (0, 5);
+  Ptr<Packet> f1 = p->CreateFragment (5, 300);
+  Ptr<Packet> f2 = p->CreateFragment (305, 500);
+  Ptr<Packet> f3 = p->CreateFragment (805, 225);
+  f2->AddAtEnd (f3);
+  f1->AddAtEnd (f2);
+  f0->AddAtEnd (f1);
+  CHECK_HISTORY (f0, 3, 10, 1000, 20);
+  CHECK_HISTORY (f1, 3, 5, 1000, 20);
+
+  p1 = p->CreateFragment (0, 1030);
+  p2 = p1->Copy ();
+  ADD_HEADER (p1, 1);
+  ADD_HEADER (p2, 2);
+  REM_HEADER (p1, 1);
+  REM_TRAILER (p2, 20);
+  ADD_TRAILER (p1, 3);
+  CHECK_HISTORY (p1, 4, 10, 1000, 20, 3);
+  CHECK_HISTORY (p2, 3, 2, 10, 1000);
+  CHECK_HISTORY (p, 3, 10, 1000, 20);
+
+  p1 = p->CreateFragment (0, 515);
+  p2 = p1->Copy ();
+  p1->AddAtEnd (p2);
+  p2->AddAtEnd (p1);
+  CHECK_HISTORY (p1, 4, 10, 505, 10, 505);
+  CHECK_HISTORY (p2, 6, 10, 505, 10, 505, 10, 505);
+
+  p1 = p->CreateFragment (10, 1000);
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      ADD_HEADER (p1, 3);
+      ADD_TRAILER (p1, 4);
+      REM_HEADER (p1, 3);
+      REM_TRAILER (p1, 4);
+    }
+  ADD_HEADER (p1, 7);
+  CHECK_HISTORY (p1, 2, 7, 1000);
 }
 
 
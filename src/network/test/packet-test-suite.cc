@@ -993,6 +993,36 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (6);
     ReplaceCheck (7);
   }
+
+  { // Recycled and large tags
+    std::cout << GetName () << "check recycled and large tags" << std::endl;
+    MAKE_TEST_TAGS ;
+    ALargeTestTag large;
+    for (int i = 0; i < 3; ++i)
+      {
+        // Remove and add again the tags, recycling their TagData
+        PacketTagList ptl = ref;
+        ptl.Add (large);
+        for (int j = 0; j < 3; ++j)
+          {
+            ptl.Remove (t7);
+            ptl.Remove (t4);
+            ptl.Remove (t1);
+            CheckRef (ptl, t7, "recycled, removed 7", true);
+            CheckRef (ptl, t4, "recycled, removed 4", true);
+            CheckRef (ptl, t1, "recycled, removed 1", true);
+            ptl.Add (t1);
+            ptl.Add (t4);
+            ptl.Add (t7);
+            CheckRefList (ptl, "recycled, added again");
+          }
+        ALargeTestTag found;
+        NS_TEST_EXPECT_MSG_EQ (ptl.Peek (found), true, "recycled, large tag");
+        NS_TEST_EXPECT_MSG_EQ (ptl.Remove (found), true, "recycled, remove large tag");
+        NS_TEST_EXPECT_MSG_EQ (ptl.Peek (found), false, "recycled, large tag removed");
+        CheckRefList (ref, "recycled, orig");
+      }
+  }
   
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
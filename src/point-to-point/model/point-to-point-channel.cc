@@ -20,8 +20,13 @@
 #include "point-to-point-net-device.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
+#include "ns3/node.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/multithreaded-simulator-impl.h"
+
+#include <vector>
 
 namespace ns3 {
 
@@ -57,7 +62,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_nodeIdsSet (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -80,9 +86,28 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      SetNodeIds ();
     }
 }
 
+bool
+PointToPointChannel::SetNodeIds (void)
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Node> node0 = m_link[0].m_src->GetNode ();
+  Ptr<Node> node1 = m_link[1].m_src->GetNode ();
+  if (node0 == 0 || node1 == 0)
+    {
+      return false;
+    }
+  m_link[0].m_dstNodeId = node1->GetId ();
+  m_link[0].m_dstSystemId = node1->GetSystemId ();
+  m_link[1].m_dstNodeId = node0->GetId ();
+  m_link[1].m_dstSystemId = node0->GetSystemId ();
+  m_nodeIdsSet = true;
+  return true;
+}
+
 bool
 PointToPointChannel::TransmitStart (
   Ptr<const Packet> p,
@@ -97,7 +122,39 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
+  if (!m_nodeIdsSet)
+    {
+      // The devices were attached before being added to their nodes.
+      // Looking up the nodes now would share them between the threads
+      // of MultithreadedSimulatorImpl.
+      NS_ABORT_MSG_IF (MultithreadedSimulatorImpl::IsEnabled (),
+                       "The devices of a PointToPointChannel must be added to their nodes "
+                       "before being attached to the channel");
+      NS_ABORT_MSG_UNLESS (SetNodeIds (),
+                           "The devices of a PointToPointChannel must be added to their nodes "
+                           "before transmitting");
+    }
+
+  if (m_link[0].m_dstSystemId != m_link[1].m_dstSystemId
+      && MultithreadedSimulatorImpl::IsEnabled ())
+    {
+      // The destination is run by another thread: hand over a packet
+      // which shares no reference-counted data with the packets of the
+      // source, and let the destination look up its device.
+      NS_ABORT_MSG_UNLESS (m_txrxPointToPoint.IsEmpty (),
+                           "TxRxPointToPoint can't be traced on a PointToPointChannel "
+                           "between system ids of MultithreadedSimulatorImpl");
+      uint32_t size = p->GetSerializedSize ();
+      std::vector<uint8_t> buffer (size);
+      p->Serialize (&buffer[0], size);
+      Ptr<Packet> packet = Create<Packet> (&buffer[0], size, true);
+      Simulator::ScheduleWithContext (m_link[wire].m_dstNodeId,
+                                      txTime + m_delay, &PointToPointChannel::Deliver,
+                                      this, wire, packet);
+      return true;
+    }
+
+  Simulator::ScheduleWithContext (m_link[wire].m_dstNodeId,
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p->Copy ());
 
@@ -106,6 +163,13 @@ PointToPointChannel::TransmitStart (
   return true;
 }
 
+void
+PointToPointChannel::Deliver (uint32_t wire, Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << wire << p);
+  m_link[wire].m_dst->Receive (p);
+}
+
 std::size_t
 PointToPointChannel::GetNDevices (void) const
 {
@@ -149,8 +149,26 @@ private:
   /** Each point to point link has exactly two net devices. */
   static const std::size_t N_DEVICES = 2;
 
+  /**
+   * \brief Record the node id and system id of the destination of each
+   * wire, if both devices were added to their nodes.
+   * \returns true if the ids were recorded
+   */
+  bool SetNodeIds (void);
+
+  /**
+   * \brief Deliver a packet to the destination device of a wire.
+   *
+   * Run by the partition of the destination, so that the event refers
+   * to the device through the channel only.
+   * \param wire the wire
+   * \param p the packet
+   */
+  void Deliver (uint32_t wire, Ptr<Packet> p);
+
   Time          m_delay;    //!< Propagation delay
   std::size_t        m_nDevices; //!< Devices of this channel
+  bool          m_nodeIdsSet; //!< True once the ids of the links are recorded
 
   /**
    * The trace source for the packet transmission animation events that the 
@@ -194,11 +212,13 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNodeId (0), m_dstSystemId (0) {}
 
     WireState                  m_state; //!< State of the link
     Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
     Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    uint32_t                   m_dstNodeId;   //!< Node id of the second NetDevice
+    uint32_t                   m_dstSystemId; //!< System id of the second NetDevice
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
@@ -24,6 +24,13 @@
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+
+#include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -94,6 +101,164 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the PointToPointChannel between the system ids of
+ * MultithreadedSimulatorImpl
+ *
+ * Tokens hop around a ring of nodes of alternating system ids, and the
+ * receptions must be the same as with DefaultSimulatorImpl.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultithreadedTest ();
+
+private:
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+
+  /**
+   * \brief Run the scenario with a simulator implementation
+   *
+   * \param simulatorType the simulator implementation
+   * \param checkSystemId whether to check the system id of the receptions
+   */
+  void RunScenario (std::string simulatorType, bool checkSystemId);
+  /**
+   * \brief Send a token to the next node of the ring
+   *
+   * \param node the sending node
+   * \param token the token
+   * \param hop the number of hops of the token so far
+   */
+  void Send (uint32_t node, uint32_t token, uint32_t hop);
+  /**
+   * \brief Receive a token, and forward it
+   *
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol
+   * \param from the sender address
+   * \param to the destination address
+   * \param packetType the packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+
+  /** Number of nodes. */
+  static const uint32_t NODES = 6;
+  /** Number of system ids. */
+  static const uint32_t SYSTEMS = 3;
+  /** Number of hops of each token. */
+  static const uint32_t HOPS = 50;
+
+  /** The device of each node to the next node of the ring. */
+  std::vector<Ptr<NetDevice> > m_next;
+  /** The time and the (token, hop) received by each node. */
+  std::vector<std::vector<std::pair<int64_t, uint32_t> > > m_log;
+  /** Whether the system id of each reception is expected to be the one of its node. */
+  bool m_checkSystemId;
+  /** Whether each node saw the wrong system id. */
+  std::vector<char> m_wrongSystemId;
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint between the system ids of MultithreadedSimulatorImpl"),
+    m_checkSystemId (false)
+{
+}
+
+void
+PointToPointMultithreadedTest::Send (uint32_t node, uint32_t token, uint32_t hop)
+{
+  uint32_t data[2] = { token, hop };
+  Ptr<Packet> p = Create<Packet> (reinterpret_cast<uint8_t *> (data), sizeof (data));
+  m_next[node]->Send (p, m_next[node]->GetBroadcast (), 0x800);
+}
+
+void
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                        const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  uint32_t node = device->GetNode ()->GetId ();
+  uint32_t data[2];
+  packet->CopyData (reinterpret_cast<uint8_t *> (data), sizeof (data));
+  m_log[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), data[0] * 1000 + data[1]));
+  if (m_checkSystemId && Simulator::GetSystemId () != node % SYSTEMS)
+    {
+      m_wrongSystemId[node] = 1;
+    }
+  if (data[1] < HOPS)
+    {
+      Send (node, data[0], data[1] + 1);
+    }
+}
+
+void
+PointToPointMultithreadedTest::RunScenario (std::string simulatorType, bool checkSystemId)
+{
+  m_checkSystemId = checkSystemId;
+  Config::SetGlobal ("SimulatorImplementationType", StringValue (simulatorType));
+  m_log.assign (NODES, std::vector<std::pair<int64_t, uint32_t> > ());
+  m_wrongSystemId.assign (NODES, 0);
+  m_next.clear ();
+
+  NodeContainer nodes;
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      nodes.Add (CreateObject<Node> (i % SYSTEMS));
+    }
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("1Mbps"));
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      // The lookahead is the smallest delay
+      p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (2) + MicroSeconds (100 * i)));
+      NetDeviceContainer devices = p2p.Install (nodes.Get (i), nodes.Get ((i + 1) % NODES));
+      m_next.push_back (devices.Get (0));
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&PointToPointMultithreadedTest::Receive, this),
+                                              0x800, 0);
+    }
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i), &PointToPointMultithreadedTest::Send, this, i, i, 0);
+    }
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_next.clear ();
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  RunScenario ("ns3::DefaultSimulatorImpl", false);
+  std::vector<std::vector<std::pair<int64_t, uint32_t> > > expected = m_log;
+
+  RunScenario ("ns3::MultithreadedSimulatorImpl", true);
+
+  uint32_t total = 0;
+  for (uint32_t i = 0; i < NODES; ++i)
+    {
+      // Only the order of simultaneous receptions may differ
+      std::sort (expected[i].begin (), expected[i].end ());
+      std::sort (m_log[i].begin (), m_log[i].end ());
+      NS_TEST_EXPECT_MSG_EQ ((m_log[i] == expected[i]), true, "Different receptions at node " << i);
+      NS_TEST_EXPECT_MSG_EQ ((m_wrongSystemId[i] != 0), false, "Wrong system id at node " << i);
+      total += m_log[i].size ();
+    }
+  NS_TEST_EXPECT_MSG_EQ (total, NODES * (HOPS + 1), "Wrong number of receptions");
+}
+
+void
+PointToPointMultithreadedTest::DoTeardown (void)
+{
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -110,6 +275,7 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
@@ -143,6 +143,8 @@ private:
 
   Ptr<const SpectrumValue> m_noise; //!< Noise spectral power density
 
+  Ptr<SpectrumValue> m_sinr; //!< Preallocated SINR of the current chunk
+
   Time m_lastChangeTime;     //!< the time of the last change in m_TotalPower
 
   Ptr<SpectrumErrorModel> m_errorModel; //!< Error model
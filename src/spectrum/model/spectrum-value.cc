@@ -22,6 +22,7 @@
 #include <ns3/spectrum-value.h>
 #include <ns3/math.h>
 #include <ns3/log.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -106,17 +107,14 @@ SpectrumValue::ConstBandsEnd () const
 void
 SpectrumValue::Add (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *xv = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 += *it2;
-      ++it1;
-      ++it2;
+      v[i] += xv[i];
     }
 }
 
@@ -124,12 +122,10 @@ SpectrumValue::Add (const SpectrumValue& x)
 void
 SpectrumValue::Add (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 += s;
-      ++it1;
+      v[i] += s;
     }
 }
 
@@ -138,17 +134,14 @@ SpectrumValue::Add (double s)
 void
 SpectrumValue::Subtract (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *xv = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 -= *it2;
-      ++it1;
-      ++it2;
+      v[i] -= xv[i];
     }
 }
 
@@ -164,17 +157,14 @@ SpectrumValue::Subtract (double s)
 void
 SpectrumValue::Multiply (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *xv = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 *= *it2;
-      ++it1;
-      ++it2;
+      v[i] *= xv[i];
     }
 }
 
@@ -182,12 +172,10 @@ SpectrumValue::Multiply (const SpectrumValue& x)
 void
 SpectrumValue::Multiply (double s)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 *= s;
-      ++it1;
+      v[i] *= s;
     }
 }
 
@@ -197,17 +185,14 @@ SpectrumValue::Multiply (double s)
 void
 SpectrumValue::Divide (const SpectrumValue& x)
 {
-  Values::iterator it1 = m_values.begin ();
-  Values::const_iterator it2 = x.m_values.begin ();
-
   NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
 
-  while (it1 != m_values.end ())
+  double *v = m_values.data ();
+  const double *xv = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      NS_ASSERT ( it2 != x.m_values.end ());
-      *it1 /= *it2;
-      ++it1;
-      ++it2;
+      v[i] /= xv[i];
     }
 }
 
@@ -216,12 +201,93 @@ void
 SpectrumValue::Divide (double s)
 {
   NS_LOG_FUNCTION (this << s);
-  Values::iterator it1 = m_values.begin ();
+  double *v = m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
+    {
+      v[i] /= s;
+    }
+}
 
-  while (it1 != m_values.end ())
+
+void
+SpectrumValue::AddScaled (const SpectrumValue& x, double s)
+{
+  NS_ASSERT (m_spectrumModel == x.m_spectrumModel);
+  NS_ASSERT (m_values.size () == x.m_values.size ());
+
+  double *v = m_values.data ();
+  const double *xv = x.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
     {
-      *it1 /= s;
-      ++it1;
+      v[i] += s * xv[i];
+    }
+}
+
+
+void
+SpectrumValue::AssignSum (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (m_spectrumModel == lhs.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == rhs.m_spectrumModel);
+  NS_ASSERT (m_values.size () == lhs.m_values.size () && m_values.size () == rhs.m_values.size ());
+
+  double *v = m_values.data ();
+  const double *lv = lhs.m_values.data ();
+  const double *rv = rhs.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
+    {
+      v[i] = lv[i] + rv[i];
+    }
+}
+
+
+void
+SpectrumValue::AssignDifference (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (m_spectrumModel == lhs.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == rhs.m_spectrumModel);
+  NS_ASSERT (m_values.size () == lhs.m_values.size () && m_values.size () == rhs.m_values.size ());
+
+  double *v = m_values.data ();
+  const double *lv = lhs.m_values.data ();
+  const double *rv = rhs.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
+    {
+      v[i] = lv[i] - rv[i];
+    }
+}
+
+
+void
+SpectrumValue::AssignProduct (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (m_spectrumModel == lhs.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == rhs.m_spectrumModel);
+  NS_ASSERT (m_values.size () == lhs.m_values.size () && m_values.size () == rhs.m_values.size ());
+
+  double *v = m_values.data ();
+  const double *lv = lhs.m_values.data ();
+  const double *rv = rhs.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
+    {
+      v[i] = lv[i] * rv[i];
+    }
+}
+
+
+void
+SpectrumValue::AssignQuotient (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (m_spectrumModel == lhs.m_spectrumModel);
+  NS_ASSERT (m_spectrumModel == rhs.m_spectrumModel);
+  NS_ASSERT (m_values.size () == lhs.m_values.size () && m_values.size () == rhs.m_values.size ());
+
+  double *v = m_values.data ();
+  const double *lv = lhs.m_values.data ();
+  const double *rv = rhs.m_values.data ();
+  for (size_t i = 0, n = m_values.size (); i < n; ++i)
+    {
+      v[i] = lv[i] / rv[i];
     }
 }
 
@@ -348,11 +414,10 @@ double
 Norm (const SpectrumValue& x)
 {
   double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const double *v = x.m_values.data ();
+  for (size_t i = 0, n = x.m_values.size (); i < n; ++i)
     {
-      s += (*it1) * (*it1);
-      ++it1;
+      s += v[i] * v[i];
     }
   return std::sqrt (s);
 }
@@ -362,11 +427,10 @@ double
 Sum (const SpectrumValue& x)
 {
   double s = 0;
-  Values::const_iterator it1 = x.ConstValuesBegin ();
-  while (it1 != x.ConstValuesEnd ())
+  const double *v = x.m_values.data ();
+  for (size_t i = 0, n = x.m_values.size (); i < n; ++i)
     {
-      s += (*it1);
-      ++it1;
+      s += v[i];
     }
   return s;
 }
@@ -403,6 +467,24 @@ Integral (const SpectrumValue& arg)
   return i;
 }
 
+double
+IntegralOfProduct (const SpectrumValue& lhs, const SpectrumValue& rhs)
+{
+  NS_ASSERT (lhs.m_spectrumModel == rhs.m_spectrumModel);
+  NS_ASSERT (lhs.m_values.size () == rhs.m_values.size ());
+  NS_ASSERT (lhs.m_values.size () == lhs.m_spectrumModel->GetNumBands ());
+
+  double i = 0;
+  const double *lv = lhs.m_values.data ();
+  const double *rv = rhs.m_values.data ();
+  Bands::const_iterator bit = lhs.ConstBandsBegin ();
+  for (size_t k = 0, n = lhs.m_values.size (); k < n; ++k, ++bit)
+    {
+      i += lv[k] * rv[k] * (bit->fh - bit->fl);
+    }
+  return i;
+}
+
 
 
 Ptr<SpectrumValue>
@@ -664,13 +746,7 @@ SpectrumValue::operator/= (double rhs)
 SpectrumValue&
 SpectrumValue::operator= (double rhs)
 {
-  Values::iterator it1 = m_values.begin ();
-
-  while (it1 != m_values.end ())
-    {
-      *it1 = rhs;
-      ++it1;
-    }
+  std::fill (m_values.begin (), m_values.end (), rhs);
   return *this;
 }
 
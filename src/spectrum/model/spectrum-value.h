@@ -410,6 +410,53 @@ public:
   SpectrumValue& operator= (double rhs);
 
 
+  /**
+   * Add to each component of *this the matching component of x
+   * multiplied by a scalar, i.e., *this += s * x, without creating any
+   * temporary SpectrumValue
+   *
+   * @param x the SpectrumValue to add
+   * @param s the scalar by which x is multiplied
+   */
+  void AddScaled (const SpectrumValue& x, double s);
+
+  /**
+   * Assign *this to lhs + rhs. Unlike operator+, no temporary
+   * SpectrumValue is created and the storage of *this is reused, hence
+   * *this must already use the SpectrumModel of the operands.
+   *
+   * @param lhs Left Hand Side of the addition
+   * @param rhs Right Hand Side of the addition
+   */
+  void AssignSum (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
+  /**
+   * Assign *this to lhs - rhs, reusing the storage of *this.
+   *
+   * @param lhs Left Hand Side of the subtraction
+   * @param rhs Right Hand Side of the subtraction
+   */
+  void AssignDifference (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
+  /**
+   * Assign *this to lhs * rhs component-by-component, reusing the storage
+   * of *this.
+   *
+   * @param lhs Left Hand Side of the multiplication
+   * @param rhs Right Hand Side of the multiplication
+   */
+  void AssignProduct (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
+  /**
+   * Assign *this to lhs / rhs component-by-component, reusing the storage
+   * of *this.
+   *
+   * @param lhs Left Hand Side of the division
+   * @param rhs Right Hand Side of the division
+   */
+  void AssignQuotient (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
+
 
   /**
    *
@@ -497,6 +544,17 @@ public:
    */
   friend double Integral (const SpectrumValue&  arg);
 
+  /**
+   *
+   *
+   * @param lhs the first argument
+   * @param rhs the second argument
+   *
+   * @return the value of the integral \f$\int_F g(f) h(f) df  \f$,
+   * computed without creating the temporary SpectrumValue lhs * rhs
+   */
+  friend double IntegralOfProduct (const SpectrumValue& lhs, const SpectrumValue& rhs);
+
   /**
    *
    * @return a Ptr to a copy of this instance
@@ -619,6 +677,7 @@ SpectrumValue Log10 (const SpectrumValue& arg);
 SpectrumValue Log2 (const SpectrumValue& arg);
 SpectrumValue Log (const SpectrumValue& arg);
 double Integral (const SpectrumValue& arg);
+double IntegralOfProduct (const SpectrumValue& lhs, const SpectrumValue& rhs);
 
 
 } // namespace ns3
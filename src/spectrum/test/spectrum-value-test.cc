@@ -203,6 +203,26 @@ SpectrumValueTestSuite::SpectrumValueTestSuite ()
   AddTestCase (new SpectrumValueTestCase (tv5, v5, "tv5 *= v2"), TestCase::QUICK);
   AddTestCase (new SpectrumValueTestCase (tv6, v6, "tv6 div= v2"), TestCase::QUICK);
 
+  SpectrumValue tv11 (f), tv12 (f), tv13 (f), tv14 (f), tv15 (f), tv16 (f);
+  tv11.AssignSum (v1, v2);
+  tv12.AssignDifference (v1, v2);
+  tv13.AssignProduct (v1, v2);
+  tv14.AssignQuotient (v1, v2);
+  tv15 = v1;
+  tv15.AddScaled (v2, doubleValue);
+  tv16[0] = IntegralOfProduct (v1, v2);
+
+  AddTestCase (new SpectrumValueTestCase (tv11, v3, "tv11.AssignSum (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv12, v4, "tv12.AssignDifference (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv13, v5, "tv13.AssignProduct (v1, v2)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv14, v6, "tv14.AssignQuotient (v1, v2)"), TestCase::QUICK);
+
+  SpectrumValue ev15 (f), ev16 (f);
+  ev15 = v1 + v2 * doubleValue;
+  ev16[0] = Integral (v1 * v2);
+  AddTestCase (new SpectrumValueTestCase (tv15, ev15, "tv15.AddScaled (v2, doubleValue)"), TestCase::QUICK);
+  AddTestCase (new SpectrumValueTestCase (tv16, ev16, "IntegralOfProduct (v1, v2)"), TestCase::QUICK);
+
   SpectrumValue tv7a (f), tv8a (f), tv9a (f), tv10a (f);
   tv7a = v1 + doubleValue;
   tv8a = v1 - doubleValue;
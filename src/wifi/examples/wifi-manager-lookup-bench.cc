@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the lookup of the remote stations of a
+// WifiRemoteStationManager, as done by an access point serving many
+// stations.  ConstantRateWifiManager is driven through the calls made by
+// the MAC for each frame (GetDataTxVector, NeedRts, NeedFragmentation,
+// ReportDataOk and ReportRxOk), with the frames spread over the stations
+// and the TIDs, without the rest of the stack.
+//
+// Sample usage:  ./waf --run 'wifi-manager-lookup-bench --stations=500 --frames=200000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/constant-rate-wifi-manager.h"
+#include "ns3/wifi-mac-header.h"
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nStations = 500;
+  uint32_t nFrames = 200000;
+  uint32_t nTids = 4;
+
+  CommandLine cmd;
+  cmd.AddValue ("stations", "number of remote stations", nStations);
+  cmd.AddValue ("frames", "number of frames sent and received", nFrames);
+  cmd.AddValue ("tids", "number of TIDs used by each station", nTids);
+  cmd.Parse (argc, argv);
+
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+  manager->SetupPhy (phy);
+
+  std::vector<Mac48Address> addresses;
+  for (uint32_t i = 0; i < nStations; i++)
+    {
+      addresses.push_back (Mac48Address::Allocate ());
+      manager->RecordGotAssocTxOk (addresses.back ());
+    }
+  Ptr<Packet> packet = Create<Packet> (1000);
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_QOSDATA);
+  WifiMode mode = phy->GetMode (0);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < nFrames; i++)
+    {
+      Mac48Address address = addresses[i % nStations];
+      header.SetQosTid ((i / nStations) % nTids);
+      WifiTxVector txVector = manager->GetDataTxVector (address, &header, packet);
+      manager->NeedRts (address, &header, packet, txVector);
+      manager->NeedFragmentation (address, &header, packet);
+      manager->ReportDataOk (address, &header, 20, mode, 20, packet->GetSize ());
+      manager->ReportRxOk (address, &header, 20, mode);
+    }
+  int64_t elapsed = clock.End ();
+
+  std::cout << nStations << " stations, " << nTids << " TIDs, "
+            << nFrames << " frames: " << elapsed << " ms" << std::endl;
+  return 0;
+}
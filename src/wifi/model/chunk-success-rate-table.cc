@@ -0,0 +1,208 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "chunk-success-rate-table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ChunkSuccessRateTable");
+
+/// The SNR (dB) range in which the tables are looked for
+static const double TABLE_MIN_DB = -30;
+static const double TABLE_MAX_DB = 100;
+/// The first step (dB) of the grid of a table, and the smallest one
+static const double TABLE_FIRST_STEP_DB = 0.25;
+static const double TABLE_MIN_STEP_DB = 1.0 / 1024;
+/// The number of bisections locating the ends of a table within 1 dB
+static const uint32_t TABLE_BISECTIONS = 20;
+
+thread_local std::map<ChunkSuccessRateTable::Key, ChunkSuccessRateTable::Table> ChunkSuccessRateTable::m_tables;
+
+ChunkSuccessRateTable::ChunkSuccessRateTable (uint16_t modelUid, ChunkSuccessRateCallback model, bool txVectorDependent)
+  : m_modelUid (modelUid),
+    m_model (model),
+    m_txVectorDependent (txVectorDependent),
+    m_maxError (1e-4)
+{
+}
+
+void
+ChunkSuccessRateTable::SetMaxError (double maxError)
+{
+  NS_ASSERT (maxError > 0 && maxError < 1);
+  m_maxError = maxError;
+}
+
+double
+ChunkSuccessRateTable::GetMaxError (void) const
+{
+  return m_maxError;
+}
+
+double
+ChunkSuccessRateTable::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  if (nbits == 0)
+    {
+      return 1.0;
+    }
+  uint8_t log2Bits = 0;
+  while ((nbits >> (log2Bits + 1)) != 0)
+    {
+      log2Bits++;
+    }
+  uint16_t channelWidth = 0;
+  uint16_t guardInterval = 0;
+  uint8_t nss = 0;
+  if (m_txVectorDependent)
+    {
+      channelWidth = txVector.GetChannelWidth ();
+      guardInterval = txVector.GetGuardInterval ();
+      nss = txVector.GetNss ();
+    }
+  Key key (m_modelUid, mode.GetUid (), channelWidth, guardInterval, nss, log2Bits, m_maxError);
+  uint64_t tableBits = static_cast<uint64_t> (1) << log2Bits;
+  auto it = m_tables.find (key);
+  if (it == m_tables.end ())
+    {
+      it = m_tables.insert (std::make_pair (key, Table ())).first;
+      Build (&it->second, mode, txVector, tableBits);
+    }
+  const Table &table = it->second;
+  if (table.rates.empty ())
+    {
+      return m_model (mode, txVector, snr, nbits);
+    }
+
+  double x = (10 * std::log10 (snr) - table.minDb) / table.stepDb;
+  double rate;
+  if (x < 0)
+    {
+      if (!table.zeroBelow)
+        {
+          return m_model (mode, txVector, snr, nbits);
+        }
+      rate = 0;
+    }
+  else if (x >= table.rates.size () - 1)
+    {
+      if (!table.oneAbove)
+        {
+          return m_model (mode, txVector, snr, nbits);
+        }
+      rate = 1;
+    }
+  else
+    {
+      uint32_t i = static_cast<uint32_t> (x);
+      rate = table.rates[i] + (x - i) * (table.rates[i + 1] - table.rates[i]);
+    }
+  if (nbits == tableBits || rate == 0 || rate == 1)
+    {
+      return rate;
+    }
+  return std::pow (rate, static_cast<double> (nbits) / tableBits);
+}
+
+void
+ChunkSuccessRateTable::Build (Table *table, WifiMode mode, WifiTxVector txVector, uint64_t nbits) const
+{
+  NS_LOG_FUNCTION (this << mode << nbits);
+  // The error of the rates of 2^k bits is at most doubled when they are
+  // raised to a power between 1 and 2
+  double maxError = m_maxError / 2;
+
+  // Look for the transition from 0 to 1, downwards by steps of 1 dB
+  double maxDb = TABLE_MAX_DB;
+  table->oneAbove = m_model (mode, txVector, std::pow (10.0, maxDb / 10), nbits) >= 1 - maxError;
+  if (table->oneAbove)
+    {
+      while (maxDb > TABLE_MIN_DB
+             && m_model (mode, txVector, std::pow (10.0, (maxDb - 1) / 10), nbits) >= 1 - maxError)
+        {
+          maxDb -= 1;
+        }
+    }
+  double minDb = maxDb - 1;
+  while (minDb > TABLE_MIN_DB
+         && m_model (mode, txVector, std::pow (10.0, minDb / 10), nbits) > maxError)
+    {
+      minDb -= 1;
+    }
+  table->zeroBelow = m_model (mode, txVector, std::pow (10.0, minDb / 10), nbits) <= maxError;
+
+  // Narrow the ends of the table down to the transition, which leaves out
+  // the kink of the models where the rate leaves 0
+  for (uint32_t i = 0; i < TABLE_BISECTIONS; i++)
+    {
+      double step = std::ldexp (1.0, -i - 1);
+      if (table->zeroBelow
+          && m_model (mode, txVector, std::pow (10.0, (minDb + step) / 10), nbits) <= maxError)
+        {
+          minDb += step;
+        }
+      if (table->oneAbove
+          && m_model (mode, txVector, std::pow (10.0, (maxDb - step) / 10), nbits) >= 1 - maxError)
+        {
+          maxDb -= step;
+        }
+    }
+
+  // Halve the step until the rates interpolated in the middle of the
+  // intervals are accurate enough.  The table is left empty, and the model
+  // used instead, if they are not at the smallest step.
+  double stepDb = TABLE_FIRST_STEP_DB;
+  uint32_t n = static_cast<uint32_t> (std::ceil ((maxDb - minDb) / stepDb)) + 1;
+  std::vector<double> rates (n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      rates[i] = m_model (mode, txVector, std::pow (10.0, (minDb + i * stepDb) / 10), nbits);
+    }
+  while (true)
+    {
+      if (stepDb < TABLE_MIN_STEP_DB)
+        {
+          NS_LOG_DEBUG ("mode=" << mode << " nbits=" << nbits << " not tabulated");
+          return;
+        }
+      std::vector<double> refined (2 * n - 1);
+      double error = 0;
+      for (uint32_t i = 0; i < n - 1; i++)
+        {
+          double middle = m_model (mode, txVector, std::pow (10.0, (minDb + (i + 0.5) * stepDb) / 10), nbits);
+          error = std::max (error, std::abs (middle - (rates[i] + rates[i + 1]) / 2));
+          refined[2 * i] = rates[i];
+          refined[2 * i + 1] = middle;
+        }
+      refined[2 * n - 2] = rates[n - 1];
+      if (error <= maxError)
+        {
+          break;
+        }
+      rates.swap (refined);
+      n = 2 * n - 1;
+      stepDb /= 2;
+    }
+  table->minDb = minDb;
+  table->stepDb = stepDb;
+  table->rates.swap (rates);
+  NS_LOG_DEBUG ("mode=" << mode << " nbits=" << nbits << " from " << minDb << " dB to " << maxDb
+                << " dB by " << stepDb << " dB, " << table->rates.size () << " rates");
+}
+
+} //namespace ns3
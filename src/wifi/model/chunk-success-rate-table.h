@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHUNK_SUCCESS_RATE_TABLE_H
+#define CHUNK_SUCCESS_RATE_TABLE_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include "ns3/callback.h"
+#include "wifi-mode.h"
+#include "wifi-tx-vector.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup wifi
+ * \brief Tables of the chunk success rates of an error rate model
+ *
+ * The success rates of the chunks are computed with the model, at first
+ * use, on a grid of SNR values in dB for each mode and for numbers of bits
+ * that are powers of two.  The rate of a chunk of n bits, with
+ * 2^k <= n < 2^(k+1), is interpolated in the table of 2^k bits and raised
+ * to the power n / 2^k, which is exact for the models whose rates are the
+ * success rate of a bit raised to the number of bits.
+ *
+ * Each table covers the SNR values for which the rates are between half
+ * the maximum error and one minus half the maximum error: 0 is returned
+ * below and 1 above.  The grid is refined until the interpolation error in
+ * the middle of every interval is below half the maximum error, so that the
+ * error of the returned rates stays below the maximum error, except close
+ * to the discontinuities of the model.
+ *
+ * The tables are shared by all the instances of a model with the same
+ * maximum error in a thread.  Each thread builds its own tables, like the
+ * packet free lists, so that the partitions of MultithreadedSimulatorImpl
+ * neither lock nor race on them; the tables of a thread are the same as
+ * those of the other threads, since they only depend on the model.
+ */
+class ChunkSuccessRateTable
+{
+public:
+  /**
+   * The chunk success rate of a model, with the arguments of
+   * ErrorRateModel::GetChunkSuccessRate
+   */
+  typedef Callback<double, WifiMode, WifiTxVector, double, uint64_t> ChunkSuccessRateCallback;
+
+  /**
+   * \param modelUid the TypeId uid of the model, which identifies the tables
+   * \param model the chunk success rates of the model
+   * \param txVectorDependent whether the rates of a mode depend on the
+   *        channel width, guard interval and number of spatial streams of
+   *        the TXVECTOR, through the PHY rate
+   */
+  ChunkSuccessRateTable (uint16_t modelUid, ChunkSuccessRateCallback model, bool txVectorDependent);
+
+  /**
+   * \param maxError the maximum error of the returned rates
+   */
+  void SetMaxError (double maxError);
+  /**
+   * \return the maximum error of the returned rates
+   */
+  double GetMaxError (void) const;
+
+  /**
+   * \param mode the Wi-Fi mode applicable to this chunk
+   * \param txVector TXVECTOR of the overall transmission
+   * \param snr the SNR of the chunk
+   * \param nbits the number of bits in this chunk
+   *
+   * \return the probability of successfully receiving the chunk, read in
+   *         the table of the mode
+   */
+  double GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+
+
+private:
+  /**
+   * The rates of a mode for a number of bits
+   */
+  struct Table
+  {
+    double minDb;              //!< SNR (dB) of the first rate
+    double stepDb;             //!< SNR (dB) between two rates
+    std::vector<double> rates; //!< the rates, none if the model is used
+    bool zeroBelow;            //!< whether the rate is 0 below the table
+    bool oneAbove;             //!< whether the rate is 1 above the table
+  };
+  /**
+   * The model uid, mode uid, channel width, guard interval, number of
+   * spatial streams, log2 of the number of bits and maximum error of a table
+   */
+  typedef std::tuple<uint16_t, uint32_t, uint16_t, uint16_t, uint8_t, uint8_t, double> Key;
+
+  /**
+   * Fill a table with the rates of the model.
+   *
+   * \param table the table
+   * \param mode the Wi-Fi mode
+   * \param txVector the TXVECTOR
+   * \param nbits the number of bits
+   */
+  void Build (Table *table, WifiMode mode, WifiTxVector txVector, uint64_t nbits) const;
+
+  uint16_t m_modelUid;                //!< the TypeId uid of the model
+  ChunkSuccessRateCallback m_model;   //!< the rates of the model
+  bool m_txVectorDependent;           //!< whether the rates depend on the TXVECTOR
+  double m_maxError;                  //!< the maximum error of the returned rates
+
+  static thread_local std::map<Key, Table> m_tables; //!< the tables of all the models, in this thread
+};
+
+} //namespace ns3
+
+#endif /* CHUNK_SUCCESS_RATE_TABLE_H */
@@ -22,6 +22,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "interference-helper.h"
 #include "wifi-phy.h"
 #include "error-rate-model.h"
@@ -200,17 +201,17 @@ InterferenceHelper::AppendEvent (Ptr<Event> event)
   NS_LOG_FUNCTION (this);
   double previousPowerStart = 0;
   double previousPowerEnd = 0;
-  previousPowerStart = GetPreviousPosition (event->GetStartTime ())->second.GetPower ();
+  auto nextStart = GetNextPosition (event->GetStartTime ());
+  previousPowerStart = std::prev (nextStart)->second.GetPower ();
   previousPowerEnd = GetPreviousPosition (event->GetEndTime ())->second.GetPower ();
 
   if (!m_rxing)
     {
       m_firstPower = previousPowerStart;
       // Always leave the first zero power noise event in the list
-      m_niChanges.erase (++(m_niChanges.begin ()),
-                         GetNextPosition (event->GetStartTime ()));
+      m_niChanges.erase (++(m_niChanges.begin ()), nextStart);
     }
-  auto first = AddNiChangeEvent (event->GetStartTime (), NiChange (previousPowerStart, event));
+  auto first = m_niChanges.insert (nextStart, std::make_pair (event->GetStartTime (), NiChange (previousPowerStart, event)));
   auto last = AddNiChangeEvent (event->GetEndTime (), NiChange (previousPowerEnd, event));
   for (auto i = first; i != last; ++i)
     {
@@ -234,7 +235,7 @@ InterferenceHelper::CalculateSnr (double signal, double noiseInterference, uint1
 }
 
 double
-InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const
+InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges::const_iterator *first) const
 {
   double noiseInterference = m_firstPower;
   auto it = m_niChanges.find (event->GetStartTime ());
@@ -242,12 +243,8 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni
     {
       noiseInterference = it->second.GetPower ();
     }
-  ni->emplace (event->GetStartTime (), NiChange (0, event));
-  while (++it != m_niChanges.end () && it->second.GetEvent () != event)
-    {
-      ni->insert (*it);
-    }
-  ni->emplace (event->GetEndTime (), NiChange (0, event));
+  NS_ABORT_MSG_IF (it == m_niChanges.end (), "Start of the event not found in the interference changes");
+  *first = it;
   return noiseInterference;
 }
 
@@ -274,12 +271,12 @@ InterferenceHelper::CalculateChunkSuccessRate (double snir, Time duration, WifiM
 }
 
 double
-InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges::const_iterator first) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = first;
   Time previous = j->first;
   WifiMode payloadMode = event->GetPayloadMode ();
   WifiPreamble preamble = txVector.GetPreambleType ();
@@ -289,7 +286,8 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  // Walk the changes up to the end of the event, included
+  while (++j != m_niChanges.end ())
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -316,18 +314,22 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
         }
       noiseInterferenceW = j->second.GetPower () - powerW;
       previous = j->first;
+      if (j->second.GetEvent () == event)
+        {
+          break;
+        }
     }
   double per = 1 - psr;
   return per;
 }
 
 double
-InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const
+InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges::const_iterator first) const
 {
   NS_LOG_FUNCTION (this);
   const WifiTxVector txVector = event->GetTxVector ();
   double psr = 1.0; /* Packet Success Rate */
-  auto j = ni->begin ();
+  auto j = first;
   Time previous = j->first;
   WifiPreamble preamble = txVector.GetPreambleType ();
   WifiMode mcsHeaderMode;
@@ -353,7 +355,8 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
   Time plcpPayloadStart = plcpTrainingSymbolsStart + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble); //packet start time + preamble + L-SIG + HT-SIG or SIG-A + Training + SIG-B
   double noiseInterferenceW = m_firstPower;
   double powerW = event->GetRxPowerW ();
-  while (++j != ni->end ())
+  // Walk the changes up to the end of the event, included
+  while (++j != m_niChanges.end ())
     {
       Time current = j->first;
       NS_LOG_DEBUG ("previous= " << previous << ", current=" << current);
@@ -730,6 +733,10 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
 
       noiseInterferenceW = j->second.GetPower () - powerW;
       previous = j->first;
+      if (j->second.GetEvent () == event)
+        {
+          break;
+        }
     }
 
   double per = 1 - psr;
@@ -739,8 +746,8 @@ InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *n
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  NiChanges::const_iterator first;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &first);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetTxVector ().GetChannelWidth ());
@@ -748,7 +755,7 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpPayloadPer (event, &ni);
+  double per = CalculatePlcpPayloadPer (event, first);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -759,8 +766,8 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
 struct InterferenceHelper::SnrPer
 InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
 {
-  NiChanges ni;
-  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &ni);
+  NiChanges::const_iterator first;
+  double noiseInterferenceW = CalculateNoiseInterferenceW (event, &first);
   double snr = CalculateSnr (event->GetRxPowerW (),
                              noiseInterferenceW,
                              event->GetTxVector ().GetChannelWidth ());
@@ -768,7 +775,7 @@ InterferenceHelper::CalculatePlcpHeaderSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the plcp header and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpHeaderPer (event, &ni);
+  double per = CalculatePlcpHeaderPer (event, first);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
@@ -824,6 +831,12 @@ InterferenceHelper::NotifyRxEnd ()
   auto it = m_niChanges.find (Simulator::Now ());
   it--;
   m_firstPower = it->second.GetPower ();
+  //The changes up to it are only needed while receiving, those at now
+  //are kept for the signals starting now
+  if (it != m_niChanges.begin ())
+    {
+      m_niChanges.erase (++(m_niChanges.begin ()), ++it);
+    }
 }
 
 } //namespace ns3
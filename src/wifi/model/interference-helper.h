@@ -245,6 +245,11 @@ private:
 
   /**
    * typedef for a multimap of NiChanges
+   *
+   * Each NiChange holds the total power received from its time until
+   * the next NiChange.  The NiChanges older than the current reception,
+   * or older than now when not receiving, are erased, so that the map
+   * only holds the signals overlapping the current reception.
    */
   typedef std::multimap<Time, NiChange> NiChanges;
 
@@ -258,11 +263,11 @@ private:
    * Calculate noise and interference power in W.
    *
    * \param event
-   * \param ni
+   * \param first set to the NiChange at the start of the event
    *
    * \return noise and interference power
    */
-  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges *ni) const;
+  double CalculateNoiseInterferenceW (Ptr<Event> event, NiChanges::const_iterator *first) const;
   /**
    * Calculate SNR (linear ratio) from the given signal power and noise+interference power.
    * (Mode is not currently used)
@@ -291,21 +296,23 @@ private:
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param first the NiChange at the start of the event, the chunks are
+   *        delimited by the following NiChanges up to the end of the event
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges::const_iterator first) const;
   /**
    * Calculate the error rate of the plcp header. The plcp header can be divided into
    * multiple chunks (e.g. due to interference from other transmissions).
    *
    * \param event
-   * \param ni
+   * \param first the NiChange at the start of the event, the chunks are
+   *        delimited by the following NiChanges up to the end of the event
    *
    * \return the error rate of the packet
    */
-  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const;
+  double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges::const_iterator first) const;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel; ///< error rate model
@@ -20,6 +20,8 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "nist-error-rate-model.h"
 #include "dsss-error-rate-model.h"
 #include "wifi-phy.h"
@@ -37,14 +39,44 @@ NistErrorRateModel::GetTypeId (void)
     .SetParent<ErrorRateModel> ()
     .SetGroupName ("Wifi")
     .AddConstructor<NistErrorRateModel> ()
+    .AddAttribute ("Tabulated",
+                   "If true, the chunk success rates are interpolated in tables "
+                   "computed at first use for each mode and number of bits, "
+                   "instead of being computed for each chunk.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NistErrorRateModel::m_tabulated),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TableMaxError",
+                   "The maximum error of the chunk success rates interpolated "
+                   "in the tables.",
+                   DoubleValue (1e-4),
+                   MakeDoubleAccessor (&NistErrorRateModel::SetTableMaxError,
+                                       &NistErrorRateModel::GetTableMaxError),
+                   MakeDoubleChecker<double> (0, 0.5))
   ;
   return tid;
 }
 
 NistErrorRateModel::NistErrorRateModel ()
+  : m_tabulated (false),
+    m_table (GetTypeId ().GetUid (),
+             MakeCallback (&NistErrorRateModel::DoGetChunkSuccessRate, this),
+             false)
 {
 }
 
+void
+NistErrorRateModel::SetTableMaxError (double maxError)
+{
+  m_table.SetMaxError (maxError);
+}
+
+double
+NistErrorRateModel::GetTableMaxError (void) const
+{
+  return m_table.GetMaxError ();
+}
+
 double
 NistErrorRateModel::GetBpskBer (double snr) const
 {
@@ -275,6 +307,16 @@ NistErrorRateModel::GetFec1024QamBer (double snr, uint64_t nbits,
 
 double
 NistErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  if (m_tabulated)
+    {
+      return m_table.GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  return DoGetChunkSuccessRate (mode, txVector, snr, nbits);
+}
+
+double
+NistErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
 {
   NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
   if (mode.GetModulationClass () == WIFI_MOD_CLASS_ERP_OFDM
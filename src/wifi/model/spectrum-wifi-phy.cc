@@ -74,6 +74,7 @@ SpectrumWifiPhy::DoDispose (void)
   NS_LOG_FUNCTION (this);
   m_channel = 0;
   m_wifiSpectrumPhyInterface = 0;
+  m_rxFilter = 0;
   WifiPhy::DoDispose ();
 }
 
@@ -231,11 +232,15 @@ SpectrumWifiPhy::StartRx (Ptr<SpectrumSignalParameters> rxParams)
   // spectral mask representing our filtering allows) to find the
   // total energy apparent to the "demodulator".
   uint16_t channelWidth = GetChannelWidth ();
-  Ptr<SpectrumValue> filter = WifiSpectrumValueHelper::CreateRfFilter (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth));
-  SpectrumValue filteredSignal = (*filter) * (*receivedSignalPsd);
+  Ptr<const SpectrumModel> filterModel = WifiSpectrumValueHelper::GetSpectrumModel (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth));
+  if (m_rxFilter == 0 || m_rxFilter->GetSpectrumModel () != filterModel)
+    {
+      m_rxFilter = WifiSpectrumValueHelper::CreateRfFilter (GetFrequency (), channelWidth, GetBandBandwidth (), GetGuardBandwidth (channelWidth));
+    }
+  double filteredPowerW = IntegralOfProduct (*m_rxFilter, *receivedSignalPsd);
   // Add receiver antenna gain
-  NS_LOG_DEBUG ("Signal power received (watts) before antenna gain: " << Integral (filteredSignal));
-  double rxPowerW = Integral (filteredSignal) * DbToRatio (GetRxGain ());
+  NS_LOG_DEBUG ("Signal power received (watts) before antenna gain: " << filteredPowerW);
+  double rxPowerW = filteredPowerW * DbToRatio (GetRxGain ());
   NS_LOG_DEBUG ("Signal power received after antenna gain: " << rxPowerW << " W (" << WToDbm (rxPowerW) << " dBm)");
 
   Ptr<WifiSpectrumSignalParameters> wifiRxParams = DynamicCast<WifiSpectrumSignalParameters> (rxParams);
@@ -215,6 +215,7 @@ private:
   Ptr<WifiSpectrumPhyInterface> m_wifiSpectrumPhyInterface; //!< Spectrum phy interface
   Ptr<AntennaModel> m_antenna; //!< antenna model
   mutable Ptr<const SpectrumModel> m_rxSpectrumModel; //!< receive spectrum model
+  Ptr<SpectrumValue> m_rxFilter;                      //!< receive filter, cached for its spectrum model
   bool m_disableWifiReception;          //!< forces this Phy to fail to sync on any signal
   TracedCallback<bool, uint32_t, double, Time> m_signalCb; //!< Signal callback
 
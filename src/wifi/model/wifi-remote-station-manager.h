@@ -21,6 +21,7 @@
 #ifndef WIFI_REMOTE_STATION_MANAGER_H
 #define WIFI_REMOTE_STATION_MANAGER_H
 
+#include <unordered_map>
 #include "ns3/traced-callback.h"
 #include "ns3/object.h"
 #include "ns3/nstime.h"
@@ -1395,13 +1396,23 @@ private:
   uint32_t GetNFragments (const WifiMacHeader *header, Ptr<const Packet> packet);
 
   /**
-   * A vector of WifiRemoteStations
+   * Build the key under which a remote station is indexed.
+   *
+   * \param address the address of the remote station
+   * \param tid the TID of the remote station (0 for the station state)
+   *
+   * \return the 48 bits of the address followed by the TID
+   */
+  static uint64_t GetStationKey (Mac48Address address, uint8_t tid);
+
+  /**
+   * WifiRemoteStations indexed by address and TID
    */
-  typedef std::vector <WifiRemoteStation *> Stations;
+  typedef std::unordered_map <uint64_t, WifiRemoteStation *> Stations;
   /**
-   * A vector of WifiRemoteStationStates
+   * WifiRemoteStationStates indexed by address
    */
-  typedef std::vector <WifiRemoteStationState *> StationStates;
+  typedef std::unordered_map <uint64_t, WifiRemoteStationState *> StationStates;
 
   /**
    * This is a pointer to the WifiPhy associated with this
@@ -20,6 +20,8 @@
  */
 
 #include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "yans-error-rate-model.h"
 #include "dsss-error-rate-model.h"
 #include "wifi-utils.h"
@@ -38,14 +40,44 @@ YansErrorRateModel::GetTypeId (void)
     .SetParent<ErrorRateModel> ()
     .SetGroupName ("Wifi")
     .AddConstructor<YansErrorRateModel> ()
+    .AddAttribute ("Tabulated",
+                   "If true, the chunk success rates are interpolated in tables "
+                   "computed at first use for each mode and number of bits, "
+                   "instead of being computed for each chunk.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansErrorRateModel::m_tabulated),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TableMaxError",
+                   "The maximum error of the chunk success rates interpolated "
+                   "in the tables.",
+                   DoubleValue (1e-4),
+                   MakeDoubleAccessor (&YansErrorRateModel::SetTableMaxError,
+                                       &YansErrorRateModel::GetTableMaxError),
+                   MakeDoubleChecker<double> (0, 0.5))
   ;
   return tid;
 }
 
 YansErrorRateModel::YansErrorRateModel ()
+  : m_tabulated (false),
+    m_table (GetTypeId ().GetUid (),
+             MakeCallback (&YansErrorRateModel::DoGetChunkSuccessRate, this),
+             true)
 {
 }
 
+void
+YansErrorRateModel::SetTableMaxError (double maxError)
+{
+  m_table.SetMaxError (maxError);
+}
+
+double
+YansErrorRateModel::GetTableMaxError (void) const
+{
+  return m_table.GetMaxError ();
+}
+
 double
 YansErrorRateModel::GetBpskBer (double snr, uint32_t signalSpread, uint64_t phyRate) const
 {
@@ -181,6 +213,16 @@ YansErrorRateModel::GetFecQamBer (double snr, uint64_t nbits,
 
 double
 YansErrorRateModel::GetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
+{
+  if (m_tabulated)
+    {
+      return m_table.GetChunkSuccessRate (mode, txVector, snr, nbits);
+    }
+  return DoGetChunkSuccessRate (mode, txVector, snr, nbits);
+}
+
+double
+YansErrorRateModel::DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const
 {
   NS_LOG_FUNCTION (this << mode << txVector.GetMode () << snr << nbits);
   if (mode.GetModulationClass () == WIFI_MOD_CLASS_ERP_OFDM
@@ -22,6 +22,7 @@
 #define YANS_ERROR_RATE_MODEL_H
 
 #include "error-rate-model.h"
+#include "chunk-success-rate-table.h"
 
 namespace ns3 {
 
@@ -65,6 +66,26 @@ public:
 
 
 private:
+  /**
+   * Compute the chunk success rate with the model.
+   *
+   * \param mode the Wi-Fi mode applicable to this chunk
+   * \param txVector TXVECTOR of the overall transmission
+   * \param snr the SNR of the chunk
+   * \param nbits the number of bits in this chunk
+   *
+   * \return probability of successfully receiving the chunk
+   */
+  double DoGetChunkSuccessRate (WifiMode mode, WifiTxVector txVector, double snr, uint64_t nbits) const;
+  /**
+   * \param maxError the maximum error of the tabulated chunk success rates
+   */
+  void SetTableMaxError (double maxError);
+  /**
+   * \return the maximum error of the tabulated chunk success rates
+   */
+  double GetTableMaxError (void) const;
+
   /**
    * Return BER of BPSK with the given parameters.
    *
@@ -155,6 +176,9 @@ private:
                        uint64_t phyRate,
                        uint32_t m, uint32_t dfree,
                        uint32_t adFree, uint32_t adFreePlusOne) const;
+
+  bool m_tabulated;               //!< whether the chunk success rates are read in tables
+  ChunkSuccessRateTable m_table;  //!< the tables of chunk success rates
 };
 
 } //namespace ns3
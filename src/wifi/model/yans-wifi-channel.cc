@@ -18,10 +18,13 @@
  * Author: Mathieu Lacage, <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
+#include <cmath>
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/double.h"
 #include "ns3/net-device.h"
 #include "ns3/node.h"
 #include "ns3/propagation-loss-model.h"
@@ -52,11 +55,36 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("MaxLossDb",
+                   "The maximum loss in dB for which transmissions will be "
+                   "passed to the receiving PHY. Signals for which the "
+                   "PropagationLossModel returns a loss bigger than this value "
+                   "will not be propagated to the receiver. This parameter is "
+                   "to be used to reduce the computational load by not "
+                   "propagating signals that are far beyond the interference "
+                   "range. Note that the default value corresponds to "
+                   "considering all signals for reception.",
+                   DoubleValue (1.0e9),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxLossDb),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "The maximum distance in meters between a sender and a "
+                   "receiver for which transmissions will be passed to the "
+                   "receiving PHY. When strictly positive, receivers are "
+                   "indexed in a grid of cells of this size, and receivers "
+                   "outside of the cells neighbouring the sender are not even "
+                   "visited. The default value of zero disables the grid, "
+                   "and all receivers are considered for reception.",
+                   DoubleValue (0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_gridCellSize (0),
+    m_gridMaxSpeed (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -67,6 +95,25 @@ YansWifiChannel::~YansWifiChannel ()
   m_phyList.clear ();
 }
 
+void
+YansWifiChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<GridEntry>::const_iterator i = m_gridEntries.begin (); i != m_gridEntries.end (); i++)
+    {
+      if (i->mobility != 0)
+        {
+          i->mobility->TraceDisconnectWithoutContext ("CourseChange", MakeCallback (&YansWifiChannel::CourseChanged, static_cast<const YansWifiChannel *> (this)));
+        }
+    }
+  m_gridEntries.clear ();
+  m_grid.clear ();
+  m_unindexedPhys.clear ();
+  m_gridMobilities.clear ();
+  m_phyList.clear ();
+  Channel::DoDispose ();
+}
+
 void
 YansWifiChannel::SetPropagationLossModel (const Ptr<PropagationLossModel> loss)
 {
@@ -87,37 +134,196 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
   NS_LOG_FUNCTION (this << sender << packet << txPowerDbm << duration.GetSeconds ());
   Ptr<MobilityModel> senderMobility = sender->GetMobility ();
   NS_ASSERT (senderMobility != 0);
-  for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+  if (m_maxRange > 0)
     {
-      if (sender != (*i))
+      std::vector<uint32_t> candidates;
+      GetCandidates (senderMobility, candidates);
+      for (std::vector<uint32_t>::const_iterator i = candidates.begin (); i != candidates.end (); i++)
         {
-          //For now don't account for inter channel interference nor channel bonding
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
-            {
-              continue;
-            }
+          SendTo (sender, senderMobility, m_phyList[*i], packet, txPowerDbm, duration);
+        }
+    }
+  else
+    {
+      for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++)
+        {
+          SendTo (sender, senderMobility, *i, packet, txPowerDbm, duration);
+        }
+    }
+}
+
+void
+YansWifiChannel::SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+                         Ptr<const Packet> packet, double txPowerDbm, Time duration) const
+{
+  if (sender == receiver)
+    {
+      return;
+    }
+  //For now don't account for inter channel interference nor channel bonding
+  if (receiver->GetChannelNumber () != sender->GetChannelNumber ())
+    {
+      return;
+    }
+
+  Ptr<MobilityModel> receiverMobility = receiver->GetMobility ()->GetObject<MobilityModel> ();
+  if (m_maxRange > 0 && senderMobility->GetDistanceFrom (receiverMobility) > m_maxRange)
+    {
+      NS_LOG_DEBUG ("receiver " << receiver << " beyond range, distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m");
+      return;
+    }
+  Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+  double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
+  NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
+                "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+  if (txPowerDbm - rxPowerDbm > m_maxLossDb)
+    {
+      // beyond range
+      return;
+    }
+  Ptr<Packet> copy = packet->Copy ();
+  Ptr<NetDevice> dstNetDevice = receiver->GetDevice ();
+  uint32_t dstNode;
+  if (dstNetDevice == 0)
+    {
+      dstNode = 0xffffffff;
+    }
+  else
+    {
+      dstNode = dstNetDevice->GetNode ()->GetId ();
+    }
+
+  Simulator::ScheduleWithContext (dstNode,
+                                  delay, &YansWifiChannel::Receive,
+                                  receiver, copy, rxPowerDbm, duration);
+}
 
-          Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
-          Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
-          double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
-          NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
-                        "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
-          Ptr<Packet> copy = packet->Copy ();
-          Ptr<NetDevice> dstNetDevice = (*i)->GetDevice ();
-          uint32_t dstNode;
-          if (dstNetDevice == 0)
+void
+YansWifiChannel::GetCandidates (Ptr<MobilityModel> senderMobility, std::vector<uint32_t> &candidates) const
+{
+  NS_LOG_FUNCTION (this << senderMobility);
+  UpdateGrid ();
+  //Moving PHYs may have left their cell since the grid was refreshed:
+  //widen the search area by the distance they may have travelled since.
+  double slack = m_gridMaxSpeed * (Simulator::Now () - m_gridRefreshTime).GetSeconds ();
+  if (slack > m_gridCellSize)
+    {
+      RefreshGrid ();
+      slack = 0;
+    }
+  double reach = m_maxRange + slack;
+  Vector position = senderMobility->GetPosition ();
+  int64_t xMax = GetGridIndex (position.x + reach);
+  int64_t yMax = GetGridIndex (position.y + reach);
+  candidates = m_unindexedPhys;
+  for (int64_t x = GetGridIndex (position.x - reach); x <= xMax; x++)
+    {
+      for (int64_t y = GetGridIndex (position.y - reach); y <= yMax; y++)
+        {
+          std::map<GridCell, std::vector<uint32_t> >::const_iterator cell = m_grid.find (GridCell (x, y));
+          if (cell != m_grid.end ())
             {
-              dstNode = 0xffffffff;
+              candidates.insert (candidates.end (), cell->second.begin (), cell->second.end ());
             }
-          else
+        }
+    }
+  //Schedule the receptions in the same order as without the grid
+  std::sort (candidates.begin (), candidates.end ());
+}
+
+void
+YansWifiChannel::UpdateGrid (void) const
+{
+  if (m_gridCellSize != m_maxRange)
+    {
+      m_gridCellSize = m_maxRange;
+      RefreshGrid ();
+    }
+  for (uint32_t i = m_gridEntries.size (); i < m_phyList.size (); i++)
+    {
+      GridEntry entry;
+      entry.mobility = m_phyList[i]->GetMobility ();
+      entry.indexed = false;
+      m_gridEntries.push_back (entry);
+      if (entry.mobility != 0)
+        {
+          if (m_gridMobilities.find (PeekPointer (entry.mobility)) == m_gridMobilities.end ())
             {
-              dstNode = dstNetDevice->GetNode ()->GetId ();
+              entry.mobility->TraceConnectWithoutContext ("CourseChange", MakeCallback (&YansWifiChannel::CourseChanged, this));
             }
-
-          Simulator::ScheduleWithContext (dstNode,
-                                          delay, &YansWifiChannel::Receive,
-                                          (*i), copy, rxPowerDbm, duration);
+          m_gridMobilities.insert (std::make_pair (PeekPointer (entry.mobility), i));
         }
+      GridInsert (i);
+    }
+}
+
+void
+YansWifiChannel::RefreshGrid (void) const
+{
+  NS_LOG_FUNCTION (this);
+  m_grid.clear ();
+  m_unindexedPhys.clear ();
+  m_gridMaxSpeed = 0;
+  m_gridRefreshTime = Simulator::Now ();
+  for (uint32_t i = 0; i < m_gridEntries.size (); i++)
+    {
+      GridInsert (i);
+    }
+}
+
+void
+YansWifiChannel::GridInsert (uint32_t index) const
+{
+  GridEntry &entry = m_gridEntries[index];
+  if (entry.mobility == 0)
+    {
+      entry.indexed = false;
+      m_unindexedPhys.push_back (index);
+      return;
+    }
+  Vector position = entry.mobility->GetPosition ();
+  entry.indexed = true;
+  entry.cell = GridCell (GetGridIndex (position.x), GetGridIndex (position.y));
+  m_grid[entry.cell].push_back (index);
+  m_gridMaxSpeed = std::max (m_gridMaxSpeed, entry.mobility->GetVelocity ().GetLength ());
+}
+
+void
+YansWifiChannel::GridRemove (uint32_t index) const
+{
+  GridEntry &entry = m_gridEntries[index];
+  std::vector<uint32_t> *phys = &m_unindexedPhys;
+  if (entry.indexed)
+    {
+      phys = &m_grid[entry.cell];
+    }
+  phys->erase (std::find (phys->begin (), phys->end (), index));
+  if (entry.indexed && phys->empty ())
+    {
+      m_grid.erase (entry.cell);
+    }
+}
+
+int64_t
+YansWifiChannel::GetGridIndex (double x) const
+{
+  return static_cast<int64_t> (std::floor (x / m_gridCellSize));
+}
+
+void
+YansWifiChannel::CourseChanged (Ptr<const MobilityModel> mobility) const
+{
+  NS_LOG_FUNCTION (this << mobility);
+  if (m_gridCellSize <= 0)
+    {
+      return;
+    }
+  typedef std::multimap<const MobilityModel *, uint32_t>::const_iterator Iterator;
+  std::pair<Iterator, Iterator> range = m_gridMobilities.equal_range (PeekPointer (mobility));
+  for (Iterator i = range.first; i != range.second; i++)
+    {
+      GridRemove (i->second);
+      GridInsert (i->second);
     }
 }
 
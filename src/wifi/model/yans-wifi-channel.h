@@ -21,16 +21,19 @@
 #ifndef YANS_WIFI_CHANNEL_H
 #define YANS_WIFI_CHANNEL_H
 
+#include <map>
 #include "ns3/channel.h"
+#include "ns3/vector.h"
+#include "ns3/nstime.h"
 
 namespace ns3 {
 
 class NetDevice;
+class MobilityModel;
 class PropagationLossModel;
 class PropagationDelayModel;
 class YansWifiPhy;
 class Packet;
-class Time;
 
 /**
  * \brief a channel to interconnect ns3::YansWifiPhy objects.
@@ -40,6 +43,20 @@ class Time;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * Two optional attributes allow to skip receivers which cannot possibly
+ * decode nor be interfered by a transmission.  "MaxLossDb" discards
+ * receivers for which the propagation loss exceeds a threshold, before
+ * any event is scheduled.  "MaxRange", when strictly positive, enables a
+ * uniform grid of cells, keyed on the (x,y) positions of the receivers'
+ * MobilityModel, so that only the receivers located in the cells
+ * neighbouring the sender are visited at all.  Receivers are moved between
+ * cells whenever their MobilityModel fires CourseChange.  Since moving
+ * receivers change position without notification, the search area is
+ * widened by the distance the fastest receiver may have travelled since
+ * the grid was last refreshed, and the grid is refreshed once that
+ * distance exceeds the cell size.  This assumes that the velocity of a
+ * MobilityModel only changes when it fires CourseChange.
  */
 class YansWifiChannel : public Channel
 {
@@ -99,11 +116,87 @@ public:
 
 
 private:
+  //inherited from Object.
+  virtual void DoDispose (void);
+
   /**
    * A vector of pointers to YansWifiPhy.
    */
   typedef std::vector<Ptr<YansWifiPhy> > PhyList;
 
+  /**
+   * A (x,y) cell of the receiver grid.
+   */
+  typedef std::pair<int64_t, int64_t> GridCell;
+
+  /**
+   * Per-PHY state of the receiver grid.
+   */
+  struct GridEntry
+  {
+    Ptr<MobilityModel> mobility; //!< The mobility model of the PHY
+    bool indexed;                //!< True if the PHY is stored in a cell
+    GridCell cell;               //!< The cell of the PHY, if indexed
+  };
+
+  /**
+   * Make sure every PHY of the PHY list is registered in the receiver grid.
+   * PHYs are indexed lazily because their mobility model is usually not
+   * known yet when they are added to the channel.
+   */
+  void UpdateGrid (void) const;
+  /**
+   * Move every PHY of the receiver grid to the cell matching its current
+   * position, and reset the displacement bound of the moving PHYs.
+   */
+  void RefreshGrid (void) const;
+  /**
+   * Store the PHY at the given index of the PHY list in the cell of the
+   * receiver grid matching its current position.
+   *
+   * \param index the index of the PHY in the PHY list
+   */
+  void GridInsert (uint32_t index) const;
+  /**
+   * Remove the PHY at the given index of the PHY list from the receiver grid.
+   *
+   * \param index the index of the PHY in the PHY list
+   */
+  void GridRemove (uint32_t index) const;
+  /**
+   * \param x the x coordinate of a position
+   * \return the index of the grid column containing the coordinate
+   */
+  int64_t GetGridIndex (double x) const;
+  /**
+   * Callback invoked when the mobility model of an indexed PHY fires
+   * CourseChange, to move the PHY to its new cell.
+   *
+   * \param mobility the mobility model whose course changed
+   */
+  void CourseChanged (Ptr<const MobilityModel> mobility) const;
+  /**
+   * Fill the given vector with the sorted indices of the PHYs which are
+   * possibly within MaxRange of the sender.
+   *
+   * \param senderMobility the mobility model of the sender
+   * \param candidates the vector to fill
+   */
+  void GetCandidates (Ptr<MobilityModel> senderMobility, std::vector<uint32_t> &candidates) const;
+  /**
+   * Propagate the packet sent by the sender to the given receiver and
+   * schedule its reception, unless the receiver is out of range.
+   *
+   * \param sender the phy object from which the packet is originating
+   * \param senderMobility the mobility model of the sender
+   * \param receiver the phy object to which the packet is propagated
+   * \param packet the packet to send
+   * \param txPowerDbm the tx power associated to the packet, in dBm
+   * \param duration the transmission duration associated with the packet
+   */
+  void SendTo (Ptr<YansWifiPhy> sender, Ptr<MobilityModel> senderMobility, Ptr<YansWifiPhy> receiver,
+               Ptr<const Packet> packet, double txPowerDbm, Time duration) const;
+
   /**
    * This method is scheduled by Send for each associated YansWifiPhy.
    * The method then calls the corresponding YansWifiPhy that the first
@@ -119,6 +212,16 @@ private:
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  double m_maxLossDb;                  //!< Maximum loss for which a transmission is propagated (dB)
+  double m_maxRange;                   //!< Maximum reception range, 0 to disable the receiver grid (m)
+
+  mutable double m_gridCellSize;                             //!< Cell size the grid was built with (m)
+  mutable double m_gridMaxSpeed;                             //!< Highest speed of the PHYs since the last refresh (m/s)
+  mutable Time m_gridRefreshTime;                            //!< Time of the last refresh of the grid
+  mutable std::vector<GridEntry> m_gridEntries;              //!< Grid state of each PHY, by index in the PHY list
+  mutable std::map<GridCell, std::vector<uint32_t> > m_grid; //!< Indices of the PHYs stored in each cell
+  mutable std::vector<uint32_t> m_unindexedPhys;             //!< Indices of the PHYs without mobility model
+  mutable std::multimap<const MobilityModel *, uint32_t> m_gridMobilities; //!< Indices of the PHYs using each mobility model
 };
 
 } //namespace ns3
@@ -21,8 +21,11 @@
 #include <cmath>
 #include "ns3/test.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/yans-error-rate-model.h"
 #include "ns3/dsss-error-rate-model.h"
 #include "ns3/wifi-tx-vector.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 
 using namespace ns3;
 
@@ -291,6 +294,88 @@ WifiErrorRateModelsTestCaseNist::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (ps, 0.999, 0.001, "Not equal within tolerance");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi Error Rate Models Test Case comparing the tabulated chunk
+ * success rates with the rates computed by the models
+ */
+class WifiErrorRateModelsTestCaseTabulated : public TestCase
+{
+public:
+  WifiErrorRateModelsTestCaseTabulated ();
+  virtual ~WifiErrorRateModelsTestCaseTabulated ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Compare the tabulated and computed rates of a model.
+   *
+   * \param model the model computing the rates
+   * \param tabulated the same model, reading the rates in tables
+   */
+  void Compare (Ptr<ErrorRateModel> model, Ptr<ErrorRateModel> tabulated);
+};
+
+WifiErrorRateModelsTestCaseTabulated::WifiErrorRateModelsTestCaseTabulated ()
+  : TestCase ("WifiErrorRateModel test case tabulated")
+{
+}
+
+WifiErrorRateModelsTestCaseTabulated::~WifiErrorRateModelsTestCaseTabulated ()
+{
+}
+
+void
+WifiErrorRateModelsTestCaseTabulated::Compare (Ptr<ErrorRateModel> model, Ptr<ErrorRateModel> tabulated)
+{
+  DoubleValue maxError;
+  tabulated->GetAttribute ("TableMaxError", maxError);
+  const char *modes[] = { "OfdmRate6Mbps", "OfdmRate54Mbps", "HtMcs0", "HtMcs7",
+                          "VhtMcs8", "VhtMcs9", "HeMcs10", "HeMcs11",
+                          "DsssRate1Mbps", "DsssRate2Mbps", "DsssRate5_5Mbps", "DsssRate11Mbps" };
+  const uint64_t nbits[] = { 1, 24, 1000, 12345, 65553 };
+  for (uint32_t m = 0; m < sizeof (modes) / sizeof (modes[0]); m++)
+    {
+      WifiMode mode (modes[m]);
+      WifiModulationClass modulation = mode.GetModulationClass ();
+      bool dsss = (modulation == WIFI_MOD_CLASS_DSSS || modulation == WIFI_MOD_CLASS_HR_DSSS);
+      uint16_t channelWidth = dsss ? 22 : (modulation == WIFI_MOD_CLASS_VHT || modulation == WIFI_MOD_CLASS_HE) ? 40 : 20;
+      WifiTxVector txVector (mode, 0, WIFI_PREAMBLE_LONG, 800, 1, 1, 0, channelWidth, false, false);
+      for (double snr = -10; snr < 50; snr += 0.173)
+        {
+          // Without GSL, the CCK models jump at 10 dB
+          if (modulation == WIFI_MOD_CLASS_HR_DSSS && std::abs (snr - 10) < 0.2)
+            {
+              continue;
+            }
+          for (uint32_t n = 0; n < sizeof (nbits) / sizeof (nbits[0]); n++)
+            {
+              double expected = model->GetChunkSuccessRate (mode, txVector, std::pow (10.0, snr / 10.0), nbits[n]);
+              double ps = tabulated->GetChunkSuccessRate (mode, txVector, std::pow (10.0, snr / 10.0), nbits[n]);
+              NS_TEST_ASSERT_MSG_EQ_TOL (ps, expected, maxError.Get (), "Wrong rate for " << mode << " at " << snr << " dB for " << nbits[n] << " bits");
+            }
+        }
+    }
+}
+
+void
+WifiErrorRateModelsTestCaseTabulated::DoRun (void)
+{
+  Ptr<NistErrorRateModel> nist = CreateObject<NistErrorRateModel> ();
+  Ptr<NistErrorRateModel> tabulatedNist = CreateObject<NistErrorRateModel> ();
+  tabulatedNist->SetAttribute ("Tabulated", BooleanValue (true));
+  Compare (nist, tabulatedNist);
+  tabulatedNist->SetAttribute ("TableMaxError", DoubleValue (1e-6));
+  Compare (nist, tabulatedNist);
+
+  Ptr<YansErrorRateModel> yans = CreateObject<YansErrorRateModel> ();
+  Ptr<YansErrorRateModel> tabulatedYans = CreateObject<YansErrorRateModel> ();
+  tabulatedYans->SetAttribute ("Tabulated", BooleanValue (true));
+  Compare (yans, tabulatedYans);
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -308,6 +393,7 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite ()
 {
   AddTestCase (new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
   AddTestCase (new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
+  AddTestCase (new WifiErrorRateModelsTestCaseTabulated, TestCase::QUICK);
 }
 
 static WifiErrorRateModelsTestSuite wifiErrorRateModelsTestSuite; ///< the test suite
@@ -30,6 +30,9 @@
 #include "ns3/propagation-loss-model.h"
 #include "ns3/yans-error-rate-model.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/double.h"
 #include "ns3/test.h"
 #include "ns3/pointer.h"
 #include "ns3/rng-seed-manager.h"
@@ -43,6 +46,9 @@
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mgt-headers.h"
+#include "ns3/interference-helper.h"
+#include "ns3/nist-error-rate-model.h"
+#include "ns3/constant-rate-wifi-manager.h"
 
 using namespace ns3;
 
@@ -1690,6 +1696,312 @@ StaWifiMacScanningTestCase::DoRun (void)
   }
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that the receiver grid of YansWifiChannel, enabled by
+ * its MaxRange attribute, only culls the receivers which are beyond range,
+ * including receivers that moved since the grid was built.
+ *
+ * Node 0 broadcasts a packet at 1s and at 3s.  Node 1 is always within
+ * range, node 2 is always beyond range, node 3 is moved within range at 2s
+ * and node 4 moves towards node 0 at a constant velocity, getting within
+ * range before the second packet is sent.
+ */
+class YansWifiChannelMaxRangeTest : public TestCase
+{
+public:
+  YansWifiChannelMaxRangeTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Send one packet function
+   * \param dev the device
+   */
+  void SendOnePacket (Ptr<WifiNetDevice> dev);
+  /**
+   * Callback invoked when a PHY starts receiving a packet
+   * \param context the index of the receiving node
+   * \param packet the packet being received
+   */
+  void PhyRxBegin (std::string context, Ptr<const Packet> packet);
+
+  std::vector<uint32_t> m_received; ///< number of packets received by each node
+};
+
+YansWifiChannelMaxRangeTest::YansWifiChannelMaxRangeTest ()
+  : TestCase ("Test case for the receiver grid of YansWifiChannel")
+{
+}
+
+void
+YansWifiChannelMaxRangeTest::SendOnePacket (Ptr<WifiNetDevice> dev)
+{
+  Ptr<Packet> p = Create<Packet> (1000);
+  dev->Send (p, dev->GetBroadcast (), 1);
+}
+
+void
+YansWifiChannelMaxRangeTest::PhyRxBegin (std::string context, Ptr<const Packet> packet)
+{
+  m_received[std::atoi (context.c_str ())]++;
+}
+
+void
+YansWifiChannelMaxRangeTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+  m_received.assign (nodes.GetN (), 0);
+
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  Ptr<FixedRssLossModel> propLoss = CreateObject<FixedRssLossModel> ();
+  propLoss->SetRss (-60);
+  channel->SetPropagationLossModel (propLoss);
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetAttribute ("MaxRange", DoubleValue (100));
+
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel);
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211a);
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager");
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));    // Sender
+  positionAlloc->Add (Vector (50.0, 0.0, 0.0));   // Within range
+  positionAlloc->Add (Vector (150.0, 0.0, 0.0));  // Beyond range
+  positionAlloc->Add (Vector (0.0, 1000.0, 0.0)); // Moved within range at 2s
+  positionAlloc->Add (Vector (300.0, 0.0, 0.0));  // Moving towards the sender
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (NodeContainer (nodes.Get (0), nodes.Get (1), nodes.Get (2), nodes.Get (3)));
+  mobility.SetMobilityModel ("ns3::ConstantVelocityMobilityModel");
+  mobility.Install (nodes.Get (4));
+  nodes.Get (4)->GetObject<ConstantVelocityMobilityModel> ()->SetVelocity (Vector (-100.0, 0.0, 0.0));
+
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      std::ostringstream oss;
+      oss << i;
+      DynamicCast<WifiNetDevice> (devices.Get (i))->GetPhy ()->TraceConnect ("PhyRxBegin", oss.str (),
+                                                                             MakeCallback (&YansWifiChannelMaxRangeTest::PhyRxBegin, this));
+    }
+
+  Ptr<WifiNetDevice> sender = DynamicCast<WifiNetDevice> (devices.Get (0));
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelMaxRangeTest::SendOnePacket, this, sender);
+  Simulator::Schedule (Seconds (2.0), &MobilityModel::SetPosition, nodes.Get (3)->GetObject<MobilityModel> (), Vector (0.0, 80.0, 0.0));
+  Simulator::Schedule (Seconds (3.0), &YansWifiChannelMaxRangeTest::SendOnePacket, this, sender);
+
+  Simulator::Stop (Seconds (4.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_received[0], 0, "The sender should not receive its own packets");
+  NS_TEST_ASSERT_MSG_EQ (m_received[1], 2, "Both packets should be received within range");
+  NS_TEST_ASSERT_MSG_EQ (m_received[2], 0, "No packet should be received beyond range");
+  NS_TEST_ASSERT_MSG_EQ (m_received[3], 1, "Only the packet sent after the move should be received");
+  NS_TEST_ASSERT_MSG_EQ (m_received[4], 1, "Only the packet sent after getting within range should be received");
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that InterferenceHelper computes the same SNR after
+ * the changes older than the end of a reception are erased.
+ *
+ * Signal A is received from 100us to 1100us.  Signal B starts at 1100us,
+ * before the end of the reception of A is notified, and is captured: its
+ * SNR must not include the power of A.  B is then received while C and D
+ * start, and E starts at the end of B, so that the changes of C and D
+ * overlap the end of the reception.  Finally F starts at 2600us, when not
+ * receiving, after the end of C.
+ */
+class InterferenceHelperPruneTest : public TestCase
+{
+public:
+  InterferenceHelperPruneTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Add a signal to the interference helper
+   * \param index the index of the signal
+   * \param duration the duration of the signal
+   */
+  void AddSignal (uint32_t index, Time duration);
+  /**
+   * Check the SNR of a signal
+   * \param index the index of the signal
+   * \param interferenceW the expected interference power (W)
+   */
+  void CheckSnr (uint32_t index, double interferenceW);
+
+  InterferenceHelper m_interference; ///< the interference helper
+  std::vector<Ptr<Event> > m_events; ///< the signals
+  std::vector<double> m_powers; ///< the power of the signals (W)
+  double m_noiseFloorW; ///< the noise floor (W)
+};
+
+InterferenceHelperPruneTest::InterferenceHelperPruneTest ()
+  : TestCase ("Test the SNR computed by InterferenceHelper after the end of a reception")
+{
+}
+
+void
+InterferenceHelperPruneTest::AddSignal (uint32_t index, Time duration)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetOfdmRate6Mbps ());
+  txVector.SetPreambleType (WIFI_PREAMBLE_LONG);
+  txVector.SetChannelWidth (20);
+  m_events[index] = m_interference.Add (Create<Packet> (100), txVector, duration, m_powers[index]);
+}
+
+void
+InterferenceHelperPruneTest::CheckSnr (uint32_t index, double interferenceW)
+{
+  double expected = m_powers[index] / (m_noiseFloorW + interferenceW);
+  double snr = m_interference.CalculatePlcpHeaderSnrPer (m_events[index]).snr;
+  NS_TEST_EXPECT_MSG_EQ_TOL (snr, expected, expected * 1e-9, "Unexpected SNR for signal " << index);
+  snr = m_interference.CalculatePlcpPayloadSnrPer (m_events[index]).snr;
+  NS_TEST_EXPECT_MSG_EQ_TOL (snr, expected, expected * 1e-9, "Unexpected SNR for signal " << index);
+}
+
+void
+InterferenceHelperPruneTest::DoRun (void)
+{
+  enum { A, B, C, D, E, F };
+  double powers[] = { 1e-9, 2e-9, 1e-11, 2e-11, 4e-11, 8e-11 };
+  m_powers.assign (powers, powers + 6);
+  m_events.resize (6);
+  m_interference.SetNoiseFigure (1);
+  m_interference.SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  // Thermal noise at 290K over 20 MHz
+  m_noiseFloorW = 1.3803e-23 * 290 * 20e6;
+
+  // Capture of B, starting with the end of A
+  Simulator::Schedule (MicroSeconds (100), &InterferenceHelperPruneTest::AddSignal, this, A, MicroSeconds (1000));
+  Simulator::Schedule (MicroSeconds (100), &InterferenceHelper::NotifyRxStart, &m_interference);
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelperPruneTest::AddSignal, this, B, MicroSeconds (1000));
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelper::NotifyRxEnd, &m_interference);
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelperPruneTest::CheckSnr, this, B, 0);
+  Simulator::Schedule (MicroSeconds (1100), &InterferenceHelper::NotifyRxStart, &m_interference);
+
+  // C, D and E overlap the end of the reception of B
+  Simulator::Schedule (MicroSeconds (1500), &InterferenceHelperPruneTest::AddSignal, this, C, MicroSeconds (1000));
+  Simulator::Schedule (MicroSeconds (1800), &InterferenceHelperPruneTest::AddSignal, this, D, MicroSeconds (1000));
+  Simulator::Schedule (MicroSeconds (2100), &InterferenceHelperPruneTest::AddSignal, this, E, MicroSeconds (1000));
+  Simulator::Schedule (MicroSeconds (2100), &InterferenceHelperPruneTest::CheckSnr, this, B, 0);
+  Simulator::Schedule (MicroSeconds (2100), &InterferenceHelper::NotifyRxEnd, &m_interference);
+  Simulator::Schedule (MicroSeconds (2100), &InterferenceHelperPruneTest::CheckSnr, this, E, powers[C] + powers[D]);
+
+  // F starts when not receiving
+  Simulator::Schedule (MicroSeconds (2600), &InterferenceHelperPruneTest::AddSignal, this, F, MicroSeconds (1000));
+  Simulator::Schedule (MicroSeconds (2600), &InterferenceHelperPruneTest::CheckSnr, this, F, powers[D] + powers[E]);
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Make sure that WifiRemoteStationManager keeps a separate remote
+ * station for each address and TID, with many known stations.
+ *
+ * The addresses differ in their last two bytes, so that the address and
+ * the TID of two stations can share bits.  Each station is reported a
+ * number of failures that depends on its address and TID, and must need
+ * a retransmission if, and only if, its own count is below the limit.
+ */
+class WifiRemoteStationLookupTest : public TestCase
+{
+public:
+  WifiRemoteStationLookupTest ();
+
+  virtual void DoRun (void);
+};
+
+WifiRemoteStationLookupTest::WifiRemoteStationLookupTest ()
+  : TestCase ("Test the lookup of remote stations by address and TID")
+{
+}
+
+void
+WifiRemoteStationLookupTest::DoRun (void)
+{
+  const uint32_t nAddresses = 300;
+  const uint8_t nTids = 8;
+  const uint32_t maxSsrc = 4;
+
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  Ptr<WifiRemoteStationManager> manager = CreateObject<ConstantRateWifiManager> ();
+  manager->SetupPhy (phy);
+  manager->SetMaxSsrc (maxSsrc);
+
+  std::vector<Mac48Address> addresses;
+  for (uint32_t i = 0; i < nAddresses; i++)
+    {
+      uint8_t buffer[6] = { 0, 0, 0, 0, static_cast<uint8_t> (i >> 8), static_cast<uint8_t> (i) };
+      Mac48Address address;
+      address.CopyFrom (buffer);
+      addresses.push_back (address);
+    }
+  Ptr<Packet> packet = Create<Packet> (100);
+  WifiMacHeader header;
+  header.SetType (WIFI_MAC_QOSDATA);
+
+  // Interleave the stations, so that they are all known before the last
+  // failures are reported
+  for (uint32_t n = 0; n < maxSsrc; n++)
+    {
+      for (uint32_t i = 0; i < nAddresses; i++)
+        {
+          for (uint8_t tid = 0; tid < nTids; tid++)
+            {
+              if (n < maxSsrc - 1 || (i + tid) % 2 == 0)
+                {
+                  header.SetQosTid (tid);
+                  manager->ReportDataFailed (addresses[i], &header, packet->GetSize ());
+                }
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < nAddresses; i++)
+    {
+      for (uint8_t tid = 0; tid < nTids; tid++)
+        {
+          header.SetQosTid (tid);
+          NS_TEST_EXPECT_MSG_EQ (manager->NeedRetransmission (addresses[i], &header, packet), ((i + tid) % 2 == 1),
+                                 "Wrong retry count for station " << addresses[i] << " TID " << +tid);
+        }
+    }
+  // The stations of an address share its state
+  for (uint32_t i = 0; i < nAddresses; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (manager->IsBrandNew (addresses[i]), true, "Wrong state for " << addresses[i]);
+    }
+  manager->RecordGotAssocTxOk (addresses[1]);
+  NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (addresses[1]), true, "Station not associated");
+  NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (addresses[0]), false, "Wrong station associated");
+  NS_TEST_EXPECT_MSG_EQ (manager->IsAssociated (addresses[257]), false, "Wrong station associated");
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1715,6 +2027,9 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new YansWifiChannelMaxRangeTest, TestCase::QUICK);
+  AddTestCase (new InterferenceHelperPruneTest, TestCase::QUICK);
+  AddTestCase (new WifiRemoteStationLookupTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
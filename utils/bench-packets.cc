@@ -328,6 +328,42 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchPacketTags (uint32_t n)
+{
+  // Tag sizes of the FlowIdTag, LteRadioBearerTag, SnrTag, AmpduTag
+  // and WifiPhyTag attached to packets by the Wi-Fi and LTE models
+  BenchTag<4> flowId;
+  BenchTag<5> bearer;
+  BenchTag<8> snr;
+  BenchTag<10> ampdu;
+  BenchTag<27> phy;
+  BenchTag<1> absent;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (2000);
+      p->AddPacketTag (flowId);
+      for (uint32_t hop = 0; hop < 3; hop++)
+        {
+          // The sender attaches its tags to a copy of the packet, and the
+          // receiver looks them up and strips them before forwarding
+          Ptr<Packet> o = p->Copy ();
+          o->AddPacketTag (bearer);
+          o->AddPacketTag (ampdu);
+          o->AddPacketTag (phy);
+          o->PeekPacketTag (absent);
+          o->RemovePacketTag (phy);
+          o->AddPacketTag (snr);
+          o->PeekPacketTag (flowId);
+          o->RemovePacketTag (ampdu);
+          o->RemovePacketTag (snr);
+          o->RemovePacketTag (bearer);
+          p = o;
+        }
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -343,6 +379,7 @@ static void
 runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char const *name)
 {
   uint64_t minDelay = std::numeric_limits<uint64_t>::max();
+  uint64_t allocated = PacketMetadata::GetAllocatedBytes ();
   for (uint32_t i = 0; i < minIterations; i++)
     {
       uint64_t delay = runBenchOneIteration(bench, n);
@@ -351,8 +388,12 @@ runBench (void (*bench) (uint32_t), uint32_t n, uint32_t minIterations, char con
   double ps = n;
   ps *= 1000;
   ps /= minDelay;
+  double bytes = PacketMetadata::GetAllocatedBytes () - allocated;
+  bytes /= n;
+  bytes /= minIterations;
   std::cout << ps << " packets/s"
-            << " (" << minDelay << " ms elapsed)\t"
+            << " (" << minDelay << " ms elapsed, "
+            << bytes << " metadata bytes/packet)\t"
             << name
             << std::endl;
 }
@@ -376,6 +417,10 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  if (enablePrinting)
+    {
+      PacketMetadata::Enable ();
+    }
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -385,6 +430,7 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchPacketTags, n, minIterations, "Packet tags per hop");
 
   return 0;
 }
@@ -25,6 +25,10 @@
 #include <string.h>
 
 #include "ns3/core-module.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#endif
 
 using namespace ns3;
 
@@ -82,8 +86,11 @@ public:
     m_total = total;
   }
 
-  /// Run function
-  void RunBench (void);
+  /**
+   * Run function
+   * \returns the simulation rate, in events per second
+   */
+  double RunBench (void);
 private:
   /// callback function
   void Cb (void);
@@ -94,7 +101,7 @@ private:
   uint32_t m_count; ///< count 
 };
 
-void
+double
 Bench::RunBench (void)
 {
   SystemWallClockMs time;
@@ -128,6 +135,7 @@ Bench::RunBench (void)
        std::setw (g_fwidth) << (m_count / simu) <<
        std::setw (g_fwidth) << (simu / m_count));
 
+  return m_count / simu;
 }
 
 void
@@ -145,18 +153,138 @@ Bench::Cb (void)
 }
 
 
+#ifdef HAVE_PTHREAD_H
+/// Benchmark of the injection of events from other threads
+class InjectBench
+{
+public:
+  /**
+   * constructor
+   * \param threads the number of injecting threads
+   * \param events the number of events injected by each thread
+   */
+  InjectBench (const uint32_t threads, const uint32_t events)
+    : m_threads (threads),
+      m_events (events),
+      m_count (0)
+  {
+  }
+
+  /// Run function
+  void RunBench (void);
+private:
+  /// Thread function, injecting m_events events with ScheduleWithContext
+  void Inject (void);
+  /// callback function of the injected events
+  void Cb (void);
+  /// keep the simulation running until all the injected events ran
+  void Poll (void);
+
+  uint32_t m_threads; ///< number of injecting threads
+  uint32_t m_events; ///< number of events injected by each thread
+  uint32_t m_count; ///< count of injected events which ran
+};
+
+void
+InjectBench::RunBench (void)
+{
+  SystemWallClockMs time;
+  double simu;
+
+  DEB ("injecting");
+  m_count = 0;
+  Simulator::ScheduleNow (&InjectBench::Poll, this);
+
+  time.Start ();
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < m_threads; ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&InjectBench::Inject, this)));
+      threads.back ()->Start ();
+    }
+  Simulator::Run ();
+  simu = time.End ();
+  simu /= 1000;
+  for (uint32_t i = 0; i < m_threads; ++i)
+    {
+      threads[i]->Join ();
+    }
+  DEB ("injection took " << simu << "s");
+
+  LOG (std::setw (g_fwidth) << m_threads <<
+       std::setw (g_fwidth) << m_count <<
+       std::setw (g_fwidth) << simu <<
+       std::setw (g_fwidth) << (m_count / simu) <<
+       std::setw (g_fwidth) << (simu / m_count));
+}
+
+void
+InjectBench::Inject (void)
+{
+  for (uint32_t i = 0; i < m_events; ++i)
+    {
+      Simulator::ScheduleWithContext (i, NanoSeconds (1), &InjectBench::Cb, this);
+    }
+}
+
+void
+InjectBench::Cb (void)
+{
+  ++m_count;
+}
+
+void
+InjectBench::Poll (void)
+{
+  if (m_count < m_threads * m_events)
+    {
+      Simulator::Schedule (NanoSeconds (1), &InjectBench::Poll, this);
+    }
+}
+#endif /* HAVE_PTHREAD_H */
+
+
 Ptr<RandomVariableStream>
-GetRandomStream (std::string filename)
+GetRandomStream (std::string filename, std::string dist)
 {
   Ptr<RandomVariableStream> stream = 0;
 
-  if (filename == "")
+  if (filename == "" && dist == "uniform")
+    {
+      LOGME ("using uniform distribution");
+      Ptr<UniformRandomVariable> urv = CreateObject<UniformRandomVariable> ();
+      urv->SetAttribute ("Min", DoubleValue (0));
+      urv->SetAttribute ("Max", DoubleValue (200));
+      stream = urv;
+    }
+  else if (filename == "" && dist == "bursty")
+    {
+      LOGME ("using bursty (pareto) distribution");
+      // Shape 1.5, with the scale chosen for a mean of 100 ns
+      Ptr<ParetoRandomVariable> prv = CreateObject<ParetoRandomVariable> ();
+      prv->SetAttribute ("Shape", DoubleValue (1.5));
+      prv->SetAttribute ("Scale", DoubleValue (100 / 3.0));
+      stream = prv;
+    }
+  else if (filename == "" && dist == "timer")
+    {
+      LOGME ("using timer (constant) distribution");
+      Ptr<ConstantRandomVariable> crv = CreateObject<ConstantRandomVariable> ();
+      crv->SetAttribute ("Constant", DoubleValue (100));
+      stream = crv;
+    }
+  else if (filename == "" && dist == "exp")
     {
       LOGME ("using default exponential distribution");
       Ptr<ExponentialRandomVariable> erv = CreateObject<ExponentialRandomVariable> ();
       erv->SetAttribute ("Mean", DoubleValue (100));
       stream = erv;
     }
+  else if (filename == "")
+    {
+      NS_FATAL_ERROR ("unknown distribution --dist=" << dist
+                      << ", expected exp, uniform, bursty or timer");
+    }
   else
     {
       std::istream *input;
@@ -204,7 +332,9 @@ int main (int argc, char *argv[])
 {
 
   bool schedCal  = false;
+  bool schedDary = false;
   bool schedHeap = false;
+  bool schedLadder = false;
   bool schedList = false;
   bool schedMap  = true;
 
@@ -212,18 +342,31 @@ int main (int argc, char *argv[])
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  std::string dist = "exp";
+  uint32_t threads = 4;
+  bool pool = true;
+  bool ab = false;
+  uint32_t inject =  0;
 
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
              "Event intervals are taken from one of:\n"
              "  an exponential distribution, with mean 100 ns,\n"
+             "  a distribution given by --dist=uniform (0-200 ns),\n"
+             "  --dist=bursty (pareto, mean 100 ns) or --dist=timer\n"
+             "  (every event rescheduled after exactly 100 ns),\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
-             "to be ascii, giving the relative event times in ns.");
+             "to be ascii, giving the relative event times in ns.\n"
+             "\n"
+             "With --inject=<n>, also measure the rate at which --threads\n"
+             "threads can each inject n events with ScheduleWithContext.");
   cmd.AddValue ("cal",   "use CalendarSheduler",          schedCal);
+  cmd.AddValue ("dary",  "use DaryHeapScheduler",         schedDary);
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
+  cmd.AddValue ("ladder", "use LadderQueueScheduler",     schedLadder);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
@@ -231,7 +374,12 @@ int main (int argc, char *argv[])
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("dist",  "event time distribution: exp (default), uniform, bursty or timer", dist);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
+  cmd.AddValue ("pool",  "reuse the memory of released events (default true)", pool);
+  cmd.AddValue ("ab",    "run each run without then with the event pool, and report the gain", ab);
+  cmd.AddValue ("threads", "number of threads injecting events (default 4)", threads);
+  cmd.AddValue ("inject", "events injected by each thread with ScheduleWithContext (default 0, disabled)", inject);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
   g_fwidth += 6;  // 5 extra chars in '2.000002e+07 ': . e+0 _
@@ -241,15 +389,24 @@ int main (int argc, char *argv[])
     {
       factory.SetTypeId ("ns3::CalendarScheduler");
     }
+  if (schedDary)
+    {
+      factory.SetTypeId ("ns3::DaryHeapScheduler");
+    }
   if (schedHeap)
     {
       factory.SetTypeId ("ns3::HeapScheduler");
     }
+  if (schedLadder)
+    {
+      factory.SetTypeId ("ns3::LadderQueueScheduler");
+    }
   if (schedList)
     {
       factory.SetTypeId ("ns3::ListScheduler");
     }
   Simulator::SetScheduler (factory);
+  EventImpl::SetPoolEnabled (pool);
 
   LOGME (std::setprecision (g_fwidth - 6));
   DEB ("debugging is ON");
@@ -258,9 +415,10 @@ int main (int argc, char *argv[])
   LOGME ("population: " << pop);
   LOGME ("total events: " << total);
   LOGME ("runs: " << runs);
+  LOGME ("event pool: " << (ab ? "A/B" : (pool ? "enabled" : "disabled")));
 
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetRandomStream (GetRandomStream (filename, dist));
 
   // table header
   LOG ("");
@@ -294,12 +452,60 @@ int main (int argc, char *argv[])
   bench->SetTotal (total);
   for (uint32_t i = 0; i < runs; i++)
     {
-      std::cout << std::setw (g_fwidth) << i;
+      if (ab)
+        {
+          EventImpl::SetPoolEnabled (false);
+          std::cout << std::setw (g_fwidth) << (std::to_string (i) + " (A)");
+          double rateA = bench->RunBench ();
+          EventImpl::SetPoolEnabled (true);
+          std::cout << std::setw (g_fwidth) << (std::to_string (i) + " (B)");
+          double rateB = bench->RunBench ();
+          LOGME ("run " << i << ": event pool gain " << (rateB / rateA - 1) * 100 << "%");
+        }
+      else
+        {
+          std::cout << std::setw (g_fwidth) << i;
 
-      bench->RunBench ();
+          bench->RunBench ();
+        }
     }
 
   LOG ("");
+  EventImpl::PoolStatistics stats = EventImpl::GetPoolStatistics ();
+  LOGME ("event pool: " << stats.allocations << " allocations, " <<
+         stats.reuses << " reuses, " << stats.releases << " releases, " <<
+         stats.cached << " cached");
+  LOG ("");
+
+#ifdef HAVE_PTHREAD_H
+  if (inject > 0)
+    {
+      InjectBench *injectBench = new InjectBench (threads, inject);
+
+      LOG (std::left << std::setw (g_fwidth) << "Run #" <<
+           std::left << std::setw (g_fwidth) << "Threads" <<
+           std::left << std::setw (4 * g_fwidth) << "Injection:");
+      LOG (std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "" <<
+           std::left << std::setw (g_fwidth) << "Events" <<
+           std::left << std::setw (g_fwidth) << "Time (s)" <<
+           std::left << std::setw (g_fwidth) << "Rate (ev/s)" <<
+           std::left << std::setw (g_fwidth) << "Per (s/ev)" );
+      for (uint32_t i = 0; i < runs; i++)
+        {
+          std::cout << std::left << std::setw (g_fwidth) << i;
+          injectBench->RunBench ();
+        }
+      LOG ("");
+      delete injectBench;
+    }
+#else
+  if (inject > 0)
+    {
+      LOGME ("injection benchmark not available without threading support");
+    }
+#endif /* HAVE_PTHREAD_H */
+
   Simulator::Destroy ();
   delete bench;
   return 0;